@@ -3,6 +3,7 @@
 
 #include "assets/shaders/helper.glsl"
 
+#pragma per_draw
 uniform vec3 surfaceColor;
 
 layout(location = 0) out vec4 fragColor;
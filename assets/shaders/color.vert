@@ -11,6 +11,7 @@
 
 layout (location = 0) in vec3 vertexPosition;
 
+#pragma per_draw
 uniform mat4 modelTransform;
 uniform mat4 cameraTransform;
 
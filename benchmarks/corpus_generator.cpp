@@ -0,0 +1,168 @@
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Generates a synthetic shader project for scaling measurements (see preprocess_scaling_benchmark.cpp).
+// The corpus consists of top-level shader components (alternating .vert / .frag) in the output directory, and a library
+// of include files in <output>/include/level<D>/. Every shader includes --fan-out files from level 0, every include file
+// at level D includes --fan-out files from level D + 1, up to --depth levels. A --guard-ratio fraction of the include
+// files is protected by an include guard, the rest by #pragma once. Include files are spread evenly across levels.
+//
+// Usage: corpus-generator --output <directory> [--files N] [--shaders N] [--depth N] [--fan-out N] [--guard-ratio R] [--lines N] [--seed N]
+
+namespace {
+
+    struct CorpusSettings {
+        std::string _outputDirectory;
+        int _fileCount = 1000;       // Total number of files, shaders included.
+        int _shaderCount = 100;
+        int _includeDepth = 4;
+        int _fanOut = 4;
+        double _guardRatio = 0.5;    // Fraction of include files using include guards instead of #pragma once.
+        int _linesPerFile = 20;      // Lines of GLSL code per file, excluding directives.
+        unsigned _seed = 1;
+    };
+
+    void PrintUsage() {
+        std::cerr << "Usage: corpus-generator --output <directory> [--files N] [--shaders N] [--depth N] [--fan-out N] [--guard-ratio R] [--lines N] [--seed N]" << std::endl;
+    }
+
+    std::string GetIncludePath(int level, int index) {
+        return "level" + std::to_string(level) + "/include_" + std::to_string(index) + ".glsl";
+    }
+
+    // Writes lines of plausible GLSL code, declaring a uniquely named function.
+    void WriteBody(std::ofstream& outputStream, const std::string& functionName, int lineCount) {
+        outputStream << "vec4 " << functionName << "(vec4 value) {" << std::endl;
+        for (int i = 0; i < lineCount; ++i) {
+            outputStream << "    value = value * " << (i + 1) << ".0 + vec4(" << i << ".0); // Line " << i << "." << std::endl;
+        }
+        outputStream << "    return value;" << std::endl;
+        outputStream << "}" << std::endl;
+    }
+
+    // Includes fanOut random files of the given level, which holds levelFileCount files.
+    void WriteIncludes(std::ofstream& outputStream, std::mt19937& random, int level, int levelFileCount, int fanOut) {
+        std::uniform_int_distribution<int> distribution(0, levelFileCount - 1);
+        for (int i = 0; i < fanOut; ++i) {
+            outputStream << "#include <" << GetIncludePath(level, distribution(random)) << ">" << std::endl;
+        }
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    CorpusSettings settings;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+
+        if (i + 1 >= argc) {
+            PrintUsage();
+            return 1;
+        }
+
+        if (argument == "--output") {
+            settings._outputDirectory = argv[++i];
+        }
+        else if (argument == "--files") {
+            settings._fileCount = std::stoi(argv[++i]);
+        }
+        else if (argument == "--shaders") {
+            settings._shaderCount = std::stoi(argv[++i]);
+        }
+        else if (argument == "--depth") {
+            settings._includeDepth = std::stoi(argv[++i]);
+        }
+        else if (argument == "--fan-out") {
+            settings._fanOut = std::stoi(argv[++i]);
+        }
+        else if (argument == "--guard-ratio") {
+            settings._guardRatio = std::stod(argv[++i]);
+        }
+        else if (argument == "--lines") {
+            settings._linesPerFile = std::stoi(argv[++i]);
+        }
+        else if (argument == "--seed") {
+            settings._seed = static_cast<unsigned>(std::stoul(argv[++i]));
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (settings._outputDirectory.empty() || settings._shaderCount < 1 || settings._includeDepth < 1 || settings._fanOut < 0) {
+        PrintUsage();
+        return 1;
+    }
+
+    // Every level needs at least one include file. Levels differ by at most one file, the first ones get the remainder.
+    int includeFileCount = std::max(settings._fileCount - settings._shaderCount, settings._includeDepth);
+    std::vector<int> levelFileCounts(settings._includeDepth, includeFileCount / settings._includeDepth);
+    for (int level = 0; level < includeFileCount % settings._includeDepth; ++level) {
+        ++levelFileCounts[level];
+    }
+
+    std::filesystem::path outputDirectory(settings._outputDirectory);
+    std::mt19937 random(settings._seed);
+    std::bernoulli_distribution useIncludeGuard(settings._guardRatio);
+
+    try {
+        // Include library.
+        for (int level = 0; level < settings._includeDepth; ++level) {
+            std::filesystem::create_directories(outputDirectory / "include" / ("level" + std::to_string(level)));
+
+            for (int index = 0; index < levelFileCounts[level]; ++index) {
+                std::ofstream outputStream(outputDirectory / "include" / GetIncludePath(level, index));
+                std::string functionName = "level" + std::to_string(level) + "_function" + std::to_string(index);
+
+                bool includeGuard = useIncludeGuard(random);
+                if (includeGuard) {
+                    std::string guardName = "LEVEL" + std::to_string(level) + "_INCLUDE_" + std::to_string(index) + "_GLSL";
+                    outputStream << "#ifndef " << guardName << std::endl;
+                    outputStream << "#define " << guardName << std::endl;
+                }
+                else {
+                    outputStream << "#pragma once" << std::endl;
+                }
+
+                if (level + 1 < settings._includeDepth) {
+                    WriteIncludes(outputStream, random, level + 1, levelFileCounts[level + 1], settings._fanOut);
+                }
+                WriteBody(outputStream, functionName, settings._linesPerFile);
+
+                if (includeGuard) {
+                    outputStream << "#endif" << std::endl;
+                }
+            }
+        }
+
+        // Shader components.
+        for (int index = 0; index < settings._shaderCount; ++index) {
+            std::string extension = index % 2 == 0 ? ".vert" : ".frag";
+            std::ofstream outputStream(outputDirectory / ("shader_" + std::to_string(index) + extension));
+
+            outputStream << "#version 450 core" << std::endl;
+            WriteIncludes(outputStream, random, 0, levelFileCounts[0], settings._fanOut);
+            WriteBody(outputStream, "shader_function", settings._linesPerFile);
+            outputStream << "void main() {" << std::endl;
+            outputStream << "    " << (index % 2 == 0 ? "gl_Position" : "vec4 color") << " = shader_function(vec4(1.0));" << std::endl;
+            outputStream << "}" << std::endl;
+        }
+    }
+    catch (std::filesystem::filesystem_error& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Generated " << settings._shaderCount << " shaders and " << includeFileCount << " include files in "
+              << settings._includeDepth << " levels of " << levelFileCounts.back() << " to " << levelFileCounts.front() << " in '"
+              << settings._outputDirectory << "'." << std::endl;
+    return 0;
+}
@@ -0,0 +1,160 @@
+
+#include <lexer.h>
+#include <shader.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Lexes and pre-processes one generated shader of --size megabytes (large constant tables interleaved with line and
+// multi-line block comments) with 1, 2, 4, ... up to --threads lexer threads and reports how single-file throughput
+// scales. Every parallel result is checked against the single-threaded one, so comments that span chunk boundaries
+// are covered. Each measurement is the best of --repeat runs.
+//
+// Usage: lexer-scaling-benchmark [--size MB] [--threads N] [--repeat N]
+
+namespace {
+
+    std::string GenerateSource(std::size_t targetBytes) {
+        std::string source = "#version 450 core\n";
+        std::size_t tableIndex = 0;
+
+        while (source.size() < targetBytes) {
+            source += "// Table " + std::to_string(tableIndex) + ", generated.\n";
+            source += "#define TABLE_" + std::to_string(tableIndex) + "_SIZE 16\n";
+            source += "const float table" + std::to_string(tableIndex) + "[16] = float[](";
+            for (int i = 0; i < 16; ++i) {
+                source += std::to_string(static_cast<float>(tableIndex * 16 + i) * 0.125f) + (i < 15 ? ", " : ");");
+            }
+            source += " /* trailing */\n";
+
+            // Block comments of a few lines, containing what would be directives and line comments outside of them.
+            if (tableIndex % 7 == 0) {
+                source += "float value" + std::to_string(tableIndex) + " = 1.0; /* begin\n";
+                source += "#define COMMENTED_OUT " + std::to_string(tableIndex) + "\n";
+                source += "   // not a line comment\n";
+                source += "end */ float after" + std::to_string(tableIndex) + " = 2.0;\n";
+            }
+
+            ++tableIndex;
+        }
+
+        source += "void main() {\n}\n";
+        return source;
+    }
+
+    template <typename Function>
+    double MeasureBest(int repeat, Function function) {
+        double bestMilliseconds = 0.0;
+
+        for (int i = 0; i < repeat; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            function();
+            double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            if (i == 0 || milliseconds < bestMilliseconds) {
+                bestMilliseconds = milliseconds;
+            }
+        }
+
+        return bestMilliseconds;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t sizeMegabytes = 64;
+    unsigned maxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    int repeat = 3;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+
+        if (i + 1 >= argc) {
+            std::cerr << "Usage: lexer-scaling-benchmark [--size MB] [--threads N] [--repeat N]" << std::endl;
+            return 1;
+        }
+
+        if (argument == "--size") {
+            sizeMegabytes = static_cast<std::size_t>(std::max(1, std::stoi(argv[++i])));
+        }
+        else if (argument == "--threads") {
+            maxThreadCount = static_cast<unsigned>(std::max(1, std::stoi(argv[++i])));
+        }
+        else if (argument == "--repeat") {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        }
+        else {
+            std::cerr << "Usage: lexer-scaling-benchmark [--size MB] [--threads N] [--repeat N]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::string source = GenerateSource(sizeMegabytes * 1024 * 1024);
+    std::filesystem::path shaderPath = std::filesystem::temp_directory_path() / "lexer_scaling_benchmark.frag";
+    {
+        std::ofstream outputStream(shaderPath, std::ios::binary);
+        outputStream << source;
+    }
+
+    std::vector<std::string> dependencies;
+    GLSL::PreprocessStatistics statistics;
+    GLSL::LexedSource reference = GLSL::Lexer::Lex(source, 1);
+    std::string referenceOutput = GLSL::Shader::Preprocess(shaderPath.string(), dependencies, statistics, 1);
+
+    std::vector<unsigned> threadCounts;
+    for (unsigned threadCount = 1; threadCount < maxThreadCount; threadCount *= 2) {
+        threadCounts.emplace_back(threadCount);
+    }
+    threadCounts.emplace_back(maxThreadCount);
+
+    double megabytes = static_cast<double>(source.size()) / (1024.0 * 1024.0);
+    std::cout << "source: " << std::fixed << std::setprecision(2) << megabytes << " MB, " << reference._lines.size() << " lines, "
+              << reference._directiveLines.size() << " directives" << std::endl;
+    std::cout << std::left << std::setw(10) << "threads" << std::right << std::setw(12) << "lex ms" << std::setw(12) << "lex MB/s"
+              << std::setw(10) << "speedup" << std::setw(16) << "preprocess ms" << std::setw(16) << "preprocess MB/s"
+              << std::setw(10) << "speedup" << std::endl;
+
+    double singleThreadLexMilliseconds = 0.0;
+    double singleThreadPreprocessMilliseconds = 0.0;
+    int exitCode = 0;
+
+    for (unsigned threadCount : threadCounts) {
+        GLSL::LexedSource lexedSource;
+        double lexMilliseconds = MeasureBest(repeat, [&]() {
+            lexedSource = GLSL::Lexer::Lex(source, threadCount);
+        });
+
+        std::string output;
+        double preprocessMilliseconds = MeasureBest(repeat, [&]() {
+            output = GLSL::Shader::Preprocess(shaderPath.string(), dependencies, statistics, threadCount);
+        });
+
+        if (threadCount == 1) {
+            singleThreadLexMilliseconds = lexMilliseconds;
+            singleThreadPreprocessMilliseconds = preprocessMilliseconds;
+        }
+
+        std::cout << std::left << std::setw(10) << threadCount << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << lexMilliseconds
+                  << std::setw(12) << megabytes / (lexMilliseconds / 1000.0)
+                  << std::setw(10) << singleThreadLexMilliseconds / lexMilliseconds
+                  << std::setw(16) << preprocessMilliseconds
+                  << std::setw(16) << megabytes / (preprocessMilliseconds / 1000.0)
+                  << std::setw(10) << singleThreadPreprocessMilliseconds / preprocessMilliseconds << std::endl;
+
+        if (lexedSource._lines != reference._lines || lexedSource._directiveLines != reference._directiveLines || output != referenceOutput) {
+            std::cerr << "Output with " << threadCount << " threads differs from the single-threaded output." << std::endl;
+            exitCode = 1;
+        }
+    }
+
+    std::filesystem::remove(shaderPath);
+    return exitCode;
+}
@@ -0,0 +1,269 @@
+
+#include <shader.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs the pre-process-and-cache pipeline over a shader corpus (see corpus_generator.cpp) with 1, 2, 4, ... up to
+// --threads worker threads and reports how it scales. Every shader component is pre-processed, hashed and written to a
+// content-addressed cache directory (skipped when an identical output is already cached). The cache is cleared before
+// every run and removed at exit. --cache must not exist yet, the benchmark creates it so that clearing it can only
+// delete files the benchmark wrote; by default a fresh directory in the system temporary directory is used. The
+// library's debug output of pre-processed components is disabled, so only the parser and the cache are measured. Peak
+// memory and read / write syscall counts are taken from /proc and reported as n/a where unavailable.
+//
+// Usage: preprocess-scaling-benchmark --corpus <directory> [--threads N] [--cache <directory>]
+
+namespace {
+
+    struct RunResult {
+        unsigned _threadCount;
+        double _milliseconds;
+        std::size_t _shaderCount;
+        std::uint64_t _outputBytes;
+        std::size_t _cacheHits;
+        std::size_t _failures;
+        long long _peakMemoryKilobytes;  // -1 if unavailable.
+        long long _readSyscalls;         // -1 if unavailable.
+        long long _writeSyscalls;        // -1 if unavailable.
+    };
+
+    // Returns the value of the "<key>:" line of a /proc file, or -1.
+    long long ReadProcValue(const std::string& filepath, const std::string& key) {
+        std::ifstream inputStream(filepath);
+        std::string line;
+
+        while (std::getline(inputStream, line)) {
+            if (line.compare(0, key.size(), key) == 0 && line.size() > key.size() && line[key.size()] == ':') {
+                return std::stoll(line.substr(key.size() + 1));
+            }
+        }
+
+        return -1;
+    }
+
+    // Resets the peak resident set size reported as VmHWM (Linux 4.0+).
+    void ResetPeakMemory() {
+        std::ofstream clearRefs("/proc/self/clear_refs");
+        clearRefs << "5";
+    }
+
+    std::vector<std::string> FindShaders(const std::filesystem::path& corpusDirectory) {
+        std::vector<std::string> shaders;
+
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(corpusDirectory)) {
+            std::string extension = entry.path().extension().string();
+            if (entry.is_regular_file() && (extension == ".vert" || extension == ".frag" || extension == ".geom")) {
+                shaders.emplace_back(entry.path().string());
+            }
+        }
+
+        std::sort(shaders.begin(), shaders.end());
+        return shaders;
+    }
+
+    // Returns a directory name in the system temporary directory that does not exist yet.
+    std::filesystem::path GetTemporaryCacheDirectory() {
+        std::random_device random;
+        std::filesystem::path cacheDirectory;
+
+        do {
+            std::stringstream directoryName;
+            directoryName << "preprocess-scaling-benchmark-" << std::hex << random() << random();
+            cacheDirectory = std::filesystem::temp_directory_path() / directoryName.str();
+        } while (std::filesystem::exists(cacheDirectory));
+
+        return cacheDirectory;
+    }
+
+    // Removes the contents of the cache directory created by this benchmark, but not the directory itself.
+    void ClearCacheDirectory(const std::filesystem::path& cacheDirectory) {
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(cacheDirectory)) {
+            std::filesystem::remove_all(entry.path());
+        }
+    }
+
+    RunResult Run(const std::vector<std::string>& shaders, const std::filesystem::path& cacheDirectory, unsigned threadCount) {
+        ClearCacheDirectory(cacheDirectory);
+
+        std::atomic<std::size_t> nextShader { 0 };
+        std::atomic<std::uint64_t> outputBytes { 0 };
+        std::atomic<std::size_t> cacheHits { 0 };
+        std::atomic<std::size_t> failures { 0 };
+
+        ResetPeakMemory();
+        long long readSyscalls = ReadProcValue("/proc/self/io", "syscr");
+        long long writeSyscalls = ReadProcValue("/proc/self/io", "syscw");
+        auto start = std::chrono::steady_clock::now();
+
+        auto worker = [&]() {
+            for (std::size_t index = nextShader++; index < shaders.size(); index = nextShader++) {
+                try {
+                    // Shaders are pre-processed in parallel, every file is lexed on its worker thread.
+                    std::vector<std::string> dependencies;
+                    GLSL::PreprocessStatistics statistics;
+                    std::string source = GLSL::Shader::Preprocess(shaders[index], dependencies, statistics, 1);
+                    outputBytes += source.size();
+
+                    std::stringstream cacheName;
+                    cacheName << std::hex << std::setw(16) << std::setfill('0') << GLSL::HashShaderSource(source) << ".glsl";
+                    std::filesystem::path cachePath = cacheDirectory / cacheName.str();
+
+                    if (std::filesystem::exists(cachePath)) {
+                        ++cacheHits;
+                        continue;
+                    }
+
+                    std::ofstream outputStream(cachePath, std::ios::binary);
+                    outputStream << source;
+                }
+                catch (std::runtime_error& exception) {
+                    if (failures++ == 0) {
+                        std::cerr << exception.what() << std::endl;
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < threadCount; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        auto end = std::chrono::steady_clock::now();
+
+        RunResult result { };
+        result._threadCount = threadCount;
+        result._milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+        result._shaderCount = shaders.size();
+        result._outputBytes = outputBytes;
+        result._cacheHits = cacheHits;
+        result._failures = failures;
+        result._peakMemoryKilobytes = ReadProcValue("/proc/self/status", "VmHWM");
+
+        long long readSyscallsAfter = ReadProcValue("/proc/self/io", "syscr");
+        long long writeSyscallsAfter = ReadProcValue("/proc/self/io", "syscw");
+        result._readSyscalls = readSyscalls < 0 ? -1 : readSyscallsAfter - readSyscalls;
+        result._writeSyscalls = writeSyscalls < 0 ? -1 : writeSyscallsAfter - writeSyscalls;
+
+        return result;
+    }
+
+    std::string FormatOptional(long long value) {
+        return value < 0 ? "n/a" : std::to_string(value);
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string corpusDirectory;
+    std::string cacheDirectory;
+    unsigned maxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+
+        if (i + 1 >= argc) {
+            std::cerr << "Usage: preprocess-scaling-benchmark --corpus <directory> [--threads N] [--cache <directory>]" << std::endl;
+            return 1;
+        }
+
+        if (argument == "--corpus") {
+            corpusDirectory = argv[++i];
+        }
+        else if (argument == "--threads") {
+            maxThreadCount = static_cast<unsigned>(std::max(1, std::stoi(argv[++i])));
+        }
+        else if (argument == "--cache") {
+            cacheDirectory = argv[++i];
+        }
+        else {
+            std::cerr << "Usage: preprocess-scaling-benchmark --corpus <directory> [--threads N] [--cache <directory>]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (corpusDirectory.empty()) {
+        std::cerr << "Usage: preprocess-scaling-benchmark --corpus <directory> [--threads N] [--cache <directory>]" << std::endl;
+        return 1;
+    }
+
+    GLSL::Shader::AddIncludeDirectory((std::filesystem::path(corpusDirectory) / "include").string());
+    GLSL::Shader::SetOutputDirectory("");
+    std::vector<std::string> shaders = FindShaders(corpusDirectory);
+    if (shaders.empty()) {
+        std::cerr << "No shaders found in '" << corpusDirectory << "'." << std::endl;
+        return 1;
+    }
+
+    // Never reuse an existing directory, its contents are deleted between runs.
+    if (cacheDirectory.empty()) {
+        cacheDirectory = GetTemporaryCacheDirectory().string();
+    }
+    else if (std::filesystem::exists(cacheDirectory)) {
+        std::cerr << "Cache directory '" << cacheDirectory << "' already exists, pass a path the benchmark can create." << std::endl;
+        return 1;
+    }
+
+    std::filesystem::create_directories(cacheDirectory);
+
+    // Warm the file system cache, so the first run is not penalized.
+    Run(shaders, cacheDirectory, maxThreadCount);
+
+    std::vector<unsigned> threadCounts;
+    for (unsigned threadCount = 1; threadCount < maxThreadCount; threadCount *= 2) {
+        threadCounts.emplace_back(threadCount);
+    }
+    threadCounts.emplace_back(maxThreadCount);
+
+    std::cout << std::left << std::setw(10) << "threads" << std::right << std::setw(12) << "ms" << std::setw(14) << "shaders/s"
+              << std::setw(10) << "MB/s" << std::setw(10) << "speedup" << std::setw(12) << "efficiency" << std::setw(14) << "peak KB"
+              << std::setw(12) << "read sys" << std::setw(12) << "write sys" << std::setw(8) << "hits" << std::setw(10) << "failures" << std::endl;
+
+    double singleThreadMilliseconds = 0.0;
+    int exitCode = 0;
+
+    for (unsigned threadCount : threadCounts) {
+        RunResult result = Run(shaders, cacheDirectory, threadCount);
+        if (threadCount == 1) {
+            singleThreadMilliseconds = result._milliseconds;
+        }
+
+        double seconds = result._milliseconds / 1000.0;
+        double speedup = singleThreadMilliseconds / result._milliseconds;
+
+        std::cout << std::left << std::setw(10) << result._threadCount << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << result._milliseconds
+                  << std::setw(14) << static_cast<double>(result._shaderCount) / seconds
+                  << std::setw(10) << static_cast<double>(result._outputBytes) / (1024.0 * 1024.0) / seconds
+                  << std::setw(10) << speedup
+                  << std::setw(12) << speedup / static_cast<double>(result._threadCount)
+                  << std::setw(14) << FormatOptional(result._peakMemoryKilobytes)
+                  << std::setw(12) << FormatOptional(result._readSyscalls)
+                  << std::setw(12) << FormatOptional(result._writeSyscalls)
+                  << std::setw(8) << result._cacheHits
+                  << std::setw(10) << result._failures << std::endl;
+
+        if (result._failures > 0) {
+            exitCode = 1;
+        }
+    }
+
+    std::filesystem::remove_all(cacheDirectory);
+    return exitCode;
+}
@@ -0,0 +1,195 @@
+
+#include <recording_gl.h>
+#include <shader.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// Shader::SetUniform micro-benchmarks. Reports nanoseconds and heap allocations per call for every type supported by
+// SetUniformData, against the mock OpenGL implementation of RecordingGL with uniform capture disabled, so nearly only the
+// cost of Shader itself is measured. Cold misses also include the mock assigning a location to every new name.
+// The same uniforms are also set per draw through a parameter struct (Shader::SetParams), against one SetUniform call
+// per member.
+//
+// Usage: setuniform-benchmark [iterations]
+
+namespace {
+
+    std::atomic<std::uint64_t> allocationCount { 0 };
+
+}
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+struct BenchmarkParams {
+    glm::mat4 modelTransform;
+    glm::mat4 cameraTransform;
+    glm::vec3 surfaceColor;
+    glm::vec4 tint;
+    float roughness;
+    int materialIndex;
+};
+
+template <>
+struct GLSL::ParamBlock<BenchmarkParams> {
+    static constexpr auto Members = std::make_tuple(GLSL::Param("modelTransform", &BenchmarkParams::modelTransform),
+                                                    GLSL::Param("cameraTransform", &BenchmarkParams::cameraTransform),
+                                                    GLSL::Param("surfaceColor", &BenchmarkParams::surfaceColor),
+                                                    GLSL::Param("tint", &BenchmarkParams::tint),
+                                                    GLSL::Param("roughness", &BenchmarkParams::roughness),
+                                                    GLSL::Param("materialIndex", &BenchmarkParams::materialIndex));
+};
+
+namespace {
+
+    struct BenchmarkResult {
+        std::string _name;
+        double _nanosecondsPerCall;
+        double _allocationsPerCall;
+    };
+
+    std::vector<BenchmarkResult> results;
+
+    // Runs benchmark(i) for every iteration and records the average time and allocation count per call.
+    void Run(const std::string& name, std::size_t iterations, const std::function<void(std::size_t)>& benchmark) {
+        // Warm up (populates the uniform location cache for hot-path benchmarks).
+        benchmark(0);
+
+        std::uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < iterations; ++i) {
+            benchmark(i);
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        std::uint64_t allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+        double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+        results.push_back({ name, nanoseconds / iterations, static_cast<double>(allocations) / iterations });
+    }
+
+    // Benchmarks hot-path sets with a string literal name (as written at call sites), with changing and repeated values.
+    template <typename DataType>
+    void RunHotPath(GLSL::Shader& shader, const std::string& typeName, std::size_t iterations, const std::function<DataType(std::size_t)>& makeValue) {
+        Run(typeName + " / literal name / changing value", iterations, [&](std::size_t i) {
+            shader.SetUniform("surfaceColor", makeValue(i));
+        });
+
+        Run(typeName + " / long literal name / changing value", iterations, [&](std::size_t i) {
+            shader.SetUniform("materialSurfaceColorTint", makeValue(i));
+        });
+
+        DataType value = makeValue(1);
+        Run(typeName + " / literal name / same value", iterations, [&](std::size_t) {
+            shader.SetUniform("surfaceColor", value);
+        });
+    }
+
+    // Benchmarks location cache misses: every call, warm-up included, uses a name that was not set before, reaching
+    // glGetUniformLocation.
+    template <typename DataType>
+    void RunColdPath(const std::string& typeName, std::size_t iterations, DataType value) {
+        std::vector<std::string> uniformNames;
+        uniformNames.reserve(iterations + 1);
+        for (std::size_t i = 0; i <= iterations; ++i) {
+            uniformNames.emplace_back("uniform" + std::to_string(i));
+        }
+
+        GLSL::Shader shader("ColdPath", { "assets/shaders/color.vert", "assets/shaders/color.frag" });
+        std::size_t nextName = 0;
+        Run(typeName + " / cold miss", iterations, [&](std::size_t) {
+            shader.SetUniform(uniformNames[nextName++], value);
+        });
+    }
+
+    // Benchmarks setting all six members of BenchmarkParams per draw, where only the model transform changes.
+    void RunParams(std::size_t iterations) {
+        GLSL::Shader shader("Params", { "assets/shaders/color.vert", "assets/shaders/color.frag" });
+        BenchmarkParams params { glm::mat4(1.0f), glm::mat4(1.0f), glm::vec3(1.0f), glm::vec4(1.0f), 0.5f, 3 };
+
+        Run("6 members / SetUniform per member", iterations, [&](std::size_t i) {
+            shader.SetUniform("modelTransform", glm::mat4(static_cast<float>(i)));
+            shader.SetUniform("cameraTransform", params.cameraTransform);
+            shader.SetUniform("surfaceColor", params.surfaceColor);
+            shader.SetUniform("tint", params.tint);
+            shader.SetUniform("roughness", params.roughness);
+            shader.SetUniform("materialIndex", params.materialIndex);
+        });
+
+        Run("6 members / SetParams", iterations, [&](std::size_t i) {
+            params.modelTransform = glm::mat4(static_cast<float>(i));
+            shader.SetParams(params);
+        });
+
+        Run("6 members / SetParams changed only", iterations, [&](std::size_t i) {
+            params.modelTransform = glm::mat4(static_cast<float>(i));
+            shader.SetParams(params, true);
+        });
+    }
+
+    template <typename DataType>
+    void RunType(const std::string& typeName, std::size_t iterations, const std::function<DataType(std::size_t)>& makeValue) {
+        GLSL::Shader shader("HotPath", { "assets/shaders/color.vert", "assets/shaders/color.frag" });
+        RunHotPath<DataType>(shader, typeName, iterations, makeValue);
+        RunColdPath<DataType>(typeName, iterations, makeValue(0));
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t iterations = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    GLSL::RecordingGL recordingGL;
+    recordingGL.SetCaptureUniforms(false);
+    recordingGL.Install();
+    GLSL::Shader::AddIncludeDirectory(GLSL_INCLUDE_DIRECTORY);
+
+    try {
+        RunType<int>("int", iterations, [](std::size_t i) { return static_cast<int>(i); });
+        RunType<bool>("bool", iterations, [](std::size_t i) { return (i & 1u) != 0; });
+        RunType<float>("float", iterations, [](std::size_t i) { return static_cast<float>(i); });
+        RunType<glm::vec2>("vec2", iterations, [](std::size_t i) { return glm::vec2(static_cast<float>(i)); });
+        RunType<glm::vec3>("vec3", iterations, [](std::size_t i) { return glm::vec3(static_cast<float>(i)); });
+        RunType<glm::vec4>("vec4", iterations, [](std::size_t i) { return glm::vec4(static_cast<float>(i)); });
+        RunType<glm::mat3>("mat3", iterations, [](std::size_t i) { return glm::mat3(static_cast<float>(i)); });
+        RunType<glm::mat4>("mat4", iterations, [](std::size_t i) { return glm::mat4(static_cast<float>(i)); });
+        RunParams(iterations);
+    }
+    catch (std::runtime_error& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(48) << "benchmark" << std::right << std::setw(12) << "ns/call" << std::setw(16) << "allocs/call" << std::endl;
+    for (const BenchmarkResult& result : results) {
+        std::cout << std::left << std::setw(48) << result._name
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(2) << result._nanosecondsPerCall
+                  << std::setw(16) << std::setprecision(3) << result._allocationsPerCall << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+# Build-time shader embedding.
+#
+# glsl_embed_shaders(<target>
+#         NAMESPACE <name>
+#         SHADERS <shader>...
+#         [INCLUDE_DIRECTORIES <directory>...]
+#         [WORKING_DIRECTORY <directory>])
+#
+# Runs glsl-embed over the given shaders and adds the generated header to <target>. The header is included as
+# <embedded_shaders/<name>.h> and declares one constexpr GLSL::EmbeddedShaderComponent per shader inside namespace <name>,
+# named after the shader file (color.vert -> <name>::color_vert).
+#
+# Where the generator supports it, glsl-embed emits a depfile so that edits to included files also trigger regeneration.
+include(CMakeParseArguments)
+
+# Ninja supports DEPFILE on custom commands since CMake 3.7, Makefile generators since CMake 3.20.
+if (CMAKE_GENERATOR MATCHES "Ninja" OR NOT CMAKE_VERSION VERSION_LESS 3.20)
+    set(GLSL_DEPFILE_SUPPORTED TRUE)
+else()
+    set(GLSL_DEPFILE_SUPPORTED FALSE)
+endif()
+
+function(glsl_embed_shaders TARGET)
+    cmake_parse_arguments(EMBED "" "NAMESPACE;WORKING_DIRECTORY" "SHADERS;INCLUDE_DIRECTORIES" ${ARGN})
+
+    if (NOT EMBED_NAMESPACE OR NOT EMBED_SHADERS)
+        message(FATAL_ERROR "glsl_embed_shaders requires NAMESPACE and SHADERS.")
+    endif()
+
+    if (NOT EMBED_WORKING_DIRECTORY)
+        set(EMBED_WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}")
+    endif()
+
+    set(GENERATED_DIRECTORY "${CMAKE_BINARY_DIR}/generated")
+    set(GENERATED_HEADER "${GENERATED_DIRECTORY}/embedded_shaders/${EMBED_NAMESPACE}.h")
+
+    set(EMBED_ARGUMENTS --output "${GENERATED_HEADER}" --namespace ${EMBED_NAMESPACE})
+    foreach (INCLUDE_DIRECTORY ${EMBED_INCLUDE_DIRECTORIES})
+        list(APPEND EMBED_ARGUMENTS --include "${INCLUDE_DIRECTORY}")
+    endforeach()
+
+    # Shader dependencies are resolved relative to the working directory, same as at runtime.
+    set(SHADER_DEPENDENCIES "")
+    foreach (SHADER ${EMBED_SHADERS})
+        if (IS_ABSOLUTE "${SHADER}")
+            list(APPEND SHADER_DEPENDENCIES "${SHADER}")
+        else()
+            list(APPEND SHADER_DEPENDENCIES "${EMBED_WORKING_DIRECTORY}/${SHADER}")
+        endif()
+    endforeach()
+
+    file(MAKE_DIRECTORY "${GENERATED_DIRECTORY}/embedded_shaders")
+
+    if (GLSL_DEPFILE_SUPPORTED)
+        set(GENERATED_DEPFILE "${GENERATED_HEADER}.d")
+
+        add_custom_command(
+                OUTPUT "${GENERATED_HEADER}"
+                COMMAND glsl-embed ${EMBED_ARGUMENTS} --depfile "${GENERATED_DEPFILE}" ${EMBED_SHADERS}
+                DEPENDS glsl-embed ${SHADER_DEPENDENCIES}
+                DEPFILE "${GENERATED_DEPFILE}"
+                WORKING_DIRECTORY "${EMBED_WORKING_DIRECTORY}"
+                COMMENT "Embedding shaders: ${EMBED_NAMESPACE}"
+                VERBATIM
+            )
+    else()
+        add_custom_command(
+                OUTPUT "${GENERATED_HEADER}"
+                COMMAND glsl-embed ${EMBED_ARGUMENTS} ${EMBED_SHADERS}
+                DEPENDS glsl-embed ${SHADER_DEPENDENCIES}
+                WORKING_DIRECTORY "${EMBED_WORKING_DIRECTORY}"
+                COMMENT "Embedding shaders: ${EMBED_NAMESPACE}"
+                VERBATIM
+            )
+    endif()
+
+    target_sources(${TARGET} PRIVATE "${GENERATED_HEADER}")
+    target_include_directories(${TARGET} PRIVATE "${GENERATED_DIRECTORY}")
+endfunction()
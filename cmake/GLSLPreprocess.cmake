@@ -0,0 +1,70 @@
+# Build-time shader pre-processing.
+#
+# glsl_preprocess_shaders(<target>
+#         OUTPUT_DIRECTORY <directory>
+#         SHADERS <shader>...
+#         [INCLUDE_DIRECTORIES <directory>...]
+#         [WORKING_DIRECTORY <directory>])
+#
+# Runs glsl-preprocess over every shader, writing the expanded source to <directory>/<shader filename>, and makes <target>
+# depend on the outputs. Each output gets its own depfile listing its include closure, so only shaders whose includes
+# changed are processed again (see GLSL_DEPFILE_SUPPORTED in GLSLEmbed.cmake).
+include(CMakeParseArguments)
+include(GLSLEmbed)
+
+function(glsl_preprocess_shaders TARGET)
+    cmake_parse_arguments(PREPROCESS "" "OUTPUT_DIRECTORY;WORKING_DIRECTORY" "SHADERS;INCLUDE_DIRECTORIES" ${ARGN})
+
+    if (NOT PREPROCESS_OUTPUT_DIRECTORY OR NOT PREPROCESS_SHADERS)
+        message(FATAL_ERROR "glsl_preprocess_shaders requires OUTPUT_DIRECTORY and SHADERS.")
+    endif()
+
+    if (NOT PREPROCESS_WORKING_DIRECTORY)
+        set(PREPROCESS_WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}")
+    endif()
+
+    set(PREPROCESS_ARGUMENTS "")
+    foreach (INCLUDE_DIRECTORY ${PREPROCESS_INCLUDE_DIRECTORIES})
+        list(APPEND PREPROCESS_ARGUMENTS --include "${INCLUDE_DIRECTORY}")
+    endforeach()
+
+    file(MAKE_DIRECTORY "${PREPROCESS_OUTPUT_DIRECTORY}")
+
+    set(PREPROCESSED_SHADERS "")
+    foreach (SHADER ${PREPROCESS_SHADERS})
+        get_filename_component(SHADER_NAME "${SHADER}" NAME)
+        set(PREPROCESSED_SHADER "${PREPROCESS_OUTPUT_DIRECTORY}/${SHADER_NAME}")
+
+        if (IS_ABSOLUTE "${SHADER}")
+            set(SHADER_DEPENDENCY "${SHADER}")
+        else()
+            set(SHADER_DEPENDENCY "${PREPROCESS_WORKING_DIRECTORY}/${SHADER}")
+        endif()
+
+        if (GLSL_DEPFILE_SUPPORTED)
+            add_custom_command(
+                    OUTPUT "${PREPROCESSED_SHADER}"
+                    COMMAND glsl-preprocess --output "${PREPROCESSED_SHADER}" --depfile "${PREPROCESSED_SHADER}.d" ${PREPROCESS_ARGUMENTS} "${SHADER}"
+                    DEPENDS glsl-preprocess "${SHADER_DEPENDENCY}"
+                    DEPFILE "${PREPROCESSED_SHADER}.d"
+                    WORKING_DIRECTORY "${PREPROCESS_WORKING_DIRECTORY}"
+                    COMMENT "Preprocessing shader: ${SHADER}"
+                    VERBATIM
+                )
+        else()
+            add_custom_command(
+                    OUTPUT "${PREPROCESSED_SHADER}"
+                    COMMAND glsl-preprocess --output "${PREPROCESSED_SHADER}" ${PREPROCESS_ARGUMENTS} "${SHADER}"
+                    DEPENDS glsl-preprocess "${SHADER_DEPENDENCY}"
+                    WORKING_DIRECTORY "${PREPROCESS_WORKING_DIRECTORY}"
+                    COMMENT "Preprocessing shader: ${SHADER}"
+                    VERBATIM
+                )
+        endif()
+
+        list(APPEND PREPROCESSED_SHADERS "${PREPROCESSED_SHADER}")
+    endforeach()
+
+    add_custom_target(${TARGET}-shaders DEPENDS ${PREPROCESSED_SHADERS})
+    add_dependencies(${TARGET} ${TARGET}-shaders)
+endfunction()
@@ -0,0 +1,42 @@
+
+#ifndef GLSL_INCLUDE_BOUNDED_QUEUE_H
+#define GLSL_INCLUDE_BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace GLSL {
+
+    // Thread safe FIFO queue with a fixed capacity, connecting the stages of a pipeline. Producers block while the
+    // queue is full, which bounds the memory held between stages to the capacity of the queue.
+    template <typename ElementType>
+    class BoundedQueue {
+        public:
+            explicit BoundedQueue(std::size_t capacity);
+
+            // Blocks while the queue is full. Returns false if the queue was closed, the element is dropped.
+            bool Push(ElementType element);
+
+            // Blocks while the queue is empty. Returns false once the queue is closed and empty.
+            bool Pop(ElementType& element);
+
+            // Wakes all blocked producers and consumers. Remaining elements can still be popped.
+            void Close();
+
+        private:
+            std::mutex _mutex;
+            std::condition_variable _notFull;
+            std::condition_variable _notEmpty;
+
+            std::deque<ElementType> _elements;
+            std::size_t _capacity;
+            bool _isClosed;
+    };
+
+}
+
+#include <bounded_queue.tpp>
+
+#endif //GLSL_INCLUDE_BOUNDED_QUEUE_H
@@ -0,0 +1,64 @@
+#ifndef GLSL_INCLUDE_BOUNDED_QUEUE_TPP
+#define GLSL_INCLUDE_BOUNDED_QUEUE_TPP
+
+#include <algorithm>
+#include <utility>
+
+namespace GLSL {
+
+    template <typename ElementType>
+    BoundedQueue<ElementType>::BoundedQueue(std::size_t capacity) : _capacity(std::max<std::size_t>(capacity, 1)),
+                                                                    _isClosed(false) {
+    }
+
+    template <typename ElementType>
+    bool BoundedQueue<ElementType>::Push(ElementType element) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notFull.wait(lock, [this]() {
+            return _isClosed || _elements.size() < _capacity;
+        });
+
+        if (_isClosed) {
+            return false;
+        }
+
+        _elements.emplace_back(std::move(element));
+        lock.unlock();
+
+        _notEmpty.notify_one();
+        return true;
+    }
+
+    template <typename ElementType>
+    bool BoundedQueue<ElementType>::Pop(ElementType& element) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notEmpty.wait(lock, [this]() {
+            return _isClosed || !_elements.empty();
+        });
+
+        if (_elements.empty()) {
+            return false;
+        }
+
+        element = std::move(_elements.front());
+        _elements.pop_front();
+        lock.unlock();
+
+        _notFull.notify_one();
+        return true;
+    }
+
+    template <typename ElementType>
+    void BoundedQueue<ElementType>::Close() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _isClosed = true;
+        }
+
+        _notFull.notify_all();
+        _notEmpty.notify_all();
+    }
+
+}
+
+#endif //GLSL_INCLUDE_BOUNDED_QUEUE_TPP
@@ -0,0 +1,49 @@
+
+#ifndef GLSL_INCLUDE_BUILD_REPORT_H
+#define GLSL_INCLUDE_BUILD_REPORT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace GLSL {
+
+    // Counters gathered by the pre-processor for a single shader component.
+    struct PreprocessStatistics {
+        int _includesOpened = 0;      // #include directives that opened and processed a file.
+        int _includesSkipped = 0;     // Included files whose contents were dropped by #pragma once or an include guard.
+        int _deepestIncludeChain = 0; // Longest chain of nested includes below the shader component.
+    };
+
+    // Build cost of a single Shader.
+    struct ShaderBuildReport {
+        struct Component {
+            std::string _filepath;
+            std::size_t _preprocessedBytes = 0;
+            PreprocessStatistics _preprocessStatistics;
+            double _preprocessMilliseconds = 0.0;
+            double _compileMilliseconds = 0.0; // Driver compile time, including waiting for the compile status.
+        };
+
+        std::string _shaderName;
+        std::vector<Component> _components;
+        double _linkMilliseconds = 0.0;    // Driver link time, including waiting for the link status.
+    };
+
+    // Process-wide collection of the latest successful build of every Shader, written as one JSON report per build.
+    class BuildReport {
+        public:
+            // Records (or replaces) the report of the shader with the same name. Thread safe.
+            static void Record(const ShaderBuildReport& report);
+
+            [[nodiscard]] static std::vector<ShaderBuildReport> GetReports();
+            static void Clear();
+
+            // Throws std::runtime_error if the file cannot be written / read or is malformed.
+            static void Write(const std::string& filepath);
+            [[nodiscard]] static std::vector<ShaderBuildReport> Read(const std::string& filepath);
+    };
+
+}
+
+#endif //GLSL_INCLUDE_BUILD_REPORT_H
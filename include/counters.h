@@ -0,0 +1,71 @@
+
+#ifndef GLSL_INCLUDE_COUNTERS_H
+#define GLSL_INCLUDE_COUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace GLSL {
+
+    // Always-on process-wide counters of the OpenGL traffic generated by Shader, DrawBatcher and PrewarmTarget. Counting is a single relaxed atomic
+    // increment, so it is cheap enough to leave enabled in production builds.
+    class Counters {
+        public:
+            enum class Counter {
+                UseProgram,                                         // Bind() and Unbind().
+                UniformInt, UniformBool, UniformFloat, UniformVec2, UniformVec3, UniformVec4, UniformMat3, UniformMat4,
+                UniformLookups,                                     // glGetUniformLocation calls (uniform location cache misses).
+                UniformMisses,                                      // Lookups of uniforms that are not active in the program.
+                Builds,                                             // Successful builds, including recompiles.
+                Recompiles,                                         // Recompile() calls that rebuilt the shader.
+                RecompilesSkipped,                                  // Recompile() calls without changed dependencies.
+                FailedBuilds,
+                ProgramBinaryHits,                                  // Programs loaded from the program binary cache.
+                ProgramBinaryMisses,                                // Cache lookups without a usable entry.
+                ProgramBinaryStoreFailures,                         // Linked programs that could not be written to the cache.
+                SharedCacheHits,                                    // Entries fetched from the shared build cache (see SharedCacheClient).
+                SharedCacheMisses,                                  // Shared build cache lookups without an entry, including failed requests.
+                BatchedDraws,                                       // Draws queued on a DrawBatcher.
+                DrawSubmissions,                                    // Draw calls issued by DrawBatcher.
+                PrewarmDraws,                                       // Draws into a PrewarmTarget (see Shader::Prewarm).
+                DriverPerformanceMessages,                          // Performance messages from debug output (see DriverMessages).
+                Count
+            };
+
+            struct Snapshot {
+                std::array<std::uint64_t, static_cast<std::size_t>(Counter::Count)> _values { };
+
+                [[nodiscard]] std::uint64_t operator[](Counter counter) const;
+                // Difference between two snapshots, e.g. the counts of a single frame.
+                [[nodiscard]] Snapshot operator-(const Snapshot& other) const;
+            };
+
+            static void Increment(Counter counter);
+
+            // Returns the totals since process start.
+            [[nodiscard]] static Snapshot GetSnapshot();
+            // Returns the counts since the previous call to EndFrame() (or since process start).
+            static Snapshot EndFrame();
+
+            // Appends the totals as one JSON object per line to filepath every interval, from a background thread.
+            // Throws std::runtime_error if the file cannot be opened or a dump is already running. StopPeriodicDump() must be
+            // called before exit, it writes the final totals.
+            static void StartPeriodicDump(const std::string& filepath, std::chrono::milliseconds interval);
+            static void StopPeriodicDump();
+
+            [[nodiscard]] static const char* GetCounterName(Counter counter);
+
+        private:
+            static std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Counter::Count)> _counters;
+    };
+
+    inline void Counters::Increment(Counter counter) {
+        _counters[static_cast<std::size_t>(counter)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+}
+
+#endif //GLSL_INCLUDE_COUNTERS_H
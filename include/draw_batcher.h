@@ -0,0 +1,90 @@
+
+#ifndef GLSL_INCLUDE_DRAW_BATCHER_H
+#define GLSL_INCLUDE_DRAW_BATCHER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <per_draw_uniforms.h>
+#include <shader.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GLSL {
+
+    // Collects the draws of one shader between Begin() and End() and submits them with as few draw calls as possible.
+    // Per-draw uniforms (see Shader::SetDrawBatching) are written into a storage buffer instead of being uploaded
+    // between draws. Where GL_ARB_shader_draw_parameters is available, all draws are submitted with a single
+    // glMultiDrawElementsIndirect; otherwise consecutive draws of the same geometry become one instanced draw.
+    // Shaders built without per-draw uniforms are drawn immediately, one draw call per Draw().
+    //
+    // Draws index the element buffer of the bound vertex array with GL_UNSIGNED_INT indices. Vertex attributes must
+    // not be instanced, gl_InstanceID is used to select the per-draw values. All functions must be called from the
+    // thread that owns the OpenGL context.
+    class DrawBatcher {
+        public:
+            explicit DrawBatcher(Shader& shader);
+            ~DrawBatcher();
+
+            DrawBatcher(const DrawBatcher&) = delete;
+            DrawBatcher& operator=(const DrawBatcher&) = delete;
+
+            // Binds the shader. Draws use the given primitive mode.
+            void Begin(GLenum mode = GL_TRIANGLES);
+
+            // Per-draw uniforms apply to the following draws, until set again. Setting a regular uniform to a new value
+            // submits the draws queued so far, so that they keep the previous value; setting it to the value it already
+            // has in this batch does nothing.
+            template <typename DataType>
+            void SetUniform(const std::string& uniformName, DataType value);
+
+            // Draws count indices starting at firstIndex, with baseVertex added to every index.
+            void Draw(GLsizei count, GLuint firstIndex = 0, GLint baseVertex = 0);
+
+            // Submits the queued draws and unbinds the shader.
+            void End();
+
+            // Number of draws queued since the last submission.
+            [[nodiscard]] std::size_t GetQueuedDraws() const;
+
+        private:
+            struct DrawCommand {
+                GLsizei _count;
+                GLuint _firstIndex;
+                GLint _baseVertex;
+            };
+
+            // Submits the queued draws.
+            void Flush();
+
+            // Writes value into the per-draw values of the following draws. Throws std::runtime_error if the type
+            // does not match the declaration.
+            void WritePerDrawValue(const PerDrawLayout::Member& member, int value);
+            void WritePerDrawValue(const PerDrawLayout::Member& member, bool value);
+            void WritePerDrawValue(const PerDrawLayout::Member& member, float value);
+            void WritePerDrawValue(const PerDrawLayout::Member& member, const glm::vec2& value);
+            void WritePerDrawValue(const PerDrawLayout::Member& member, const glm::vec3& value);
+            void WritePerDrawValue(const PerDrawLayout::Member& member, const glm::vec4& value);
+            void WritePerDrawValue(const PerDrawLayout::Member& member, const glm::mat3& value);
+            void WritePerDrawValue(const PerDrawLayout::Member& member, const glm::mat4& value);
+            void Write(const PerDrawLayout::Member& member, const std::string& type, std::size_t offset, const void* data, std::size_t size);
+
+            Shader& _shader;
+            PerDrawLayout _layout; // Layout of the shader when the batch began.
+            GLenum _mode;
+            bool _multiDraw;
+
+            std::vector<unsigned char> _currentValues; // Per-draw values of the next draw.
+            std::vector<unsigned char> _perDrawValues; // Per-draw values of every queued draw.
+            std::vector<DrawCommand> _draws;
+            std::unordered_map<std::string, std::vector<unsigned char>> _regularValues; // Regular uniforms set since Begin().
+
+            GLuint _perDrawBuffer;
+            GLuint _indirectBuffer;
+    };
+
+}
+
+#include <draw_batcher.tpp>
+
+#endif //GLSL_INCLUDE_DRAW_BATCHER_H
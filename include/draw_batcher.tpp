@@ -0,0 +1,32 @@
+
+#ifndef GLSL_INCLUDE_DRAW_BATCHER_TPP
+#define GLSL_INCLUDE_DRAW_BATCHER_TPP
+
+#include <cstring>
+
+namespace GLSL {
+
+    template <typename DataType>
+    void DrawBatcher::SetUniform(const std::string& uniformName, DataType value) {
+        const PerDrawLayout::Member* member = _layout.Find(uniformName);
+
+        if (member) {
+            WritePerDrawValue(*member, value);
+        }
+        else {
+            // Regular uniforms apply to the whole submission.
+            const unsigned char* data = reinterpret_cast<const unsigned char*>(&value);
+            std::vector<unsigned char>& previousValue = _regularValues[uniformName];
+            if (previousValue.size() == sizeof(DataType) && std::memcmp(previousValue.data(), data, sizeof(DataType)) == 0) {
+                return;
+            }
+
+            Flush();
+            _shader.SetUniform(uniformName, value);
+            previousValue.assign(data, data + sizeof(DataType));
+        }
+    }
+
+}
+
+#endif //GLSL_INCLUDE_DRAW_BATCHER_TPP
@@ -0,0 +1,74 @@
+
+#ifndef GLSL_INCLUDE_DRIVER_MESSAGES_H
+#define GLSL_INCLUDE_DRIVER_MESSAGES_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace GLSL {
+
+    // Optional capture of the messages drivers report through debug output (KHR_debug, core in OpenGL 4.3), e.g. shaders
+    // recompiled because of a state change or rejected program binaries. While enabled, debug output is synchronous, so
+    // every message is delivered during the call that caused it and is attributed to the shader being built at that
+    // time, or else to the shader bound with Shader::Bind(). Performance messages of every severity are reported (low
+    // severity messages are off by default in OpenGL) and counted in Counters::Counter::DriverPerformanceMessages.
+    // Results are aggregated per shader name and message. Some drivers only report messages in debug contexts.
+    // All functions must be called from the thread that owns the OpenGL context.
+    class DriverMessages {
+        public:
+            struct MessageStatistics {
+                std::string _shaderName; // Empty for messages issued while no shader was bound or built.
+                GLenum _source = 0;
+                GLenum _type = 0;
+                GLuint _id = 0;          // Driver-specific message identifier.
+                GLenum _severity = 0;    // Of the first occurrence.
+                std::uint64_t _count = 0;
+                std::string _message;    // Text of the first occurrence.
+            };
+
+            // Attributes a build to a shader for as long as the scope lives, taking precedence over the bound shader.
+            class BuildScope {
+                public:
+                    explicit BuildScope(const std::string& shaderName);
+                    ~BuildScope();
+
+                    BuildScope(const BuildScope&) = delete;
+                    BuildScope& operator=(const BuildScope&) = delete;
+
+                private:
+                    bool _active;
+                    bool _previousIsBuilding;
+                    std::string _previousShaderName;
+            };
+
+            // Installs the debug message callback. Only performance messages are enabled, unless allTypes is set (e.g.
+            // to also capture errors and deprecated behavior). Requires OpenGL 4.3 or KHR_debug.
+            static void Enable(bool allTypes = false);
+            // Removes the callback and disables debug output. Aggregated statistics are kept until Reset().
+            static void Disable();
+            [[nodiscard]] static bool IsEnabled();
+
+            // Called by Shader::Bind() and Shader::Unbind().
+            static void Bind(const std::string& shaderName);
+            static void Unbind();
+
+            // Sorted by shader name, then by source, type and message identifier.
+            [[nodiscard]] static std::vector<MessageStatistics> GetStatistics();
+            static void Reset();
+
+            [[nodiscard]] static const char* GetSourceName(GLenum source);
+            [[nodiscard]] static const char* GetTypeName(GLenum type);
+
+        private:
+            static bool _enabled;
+    };
+
+    inline bool DriverMessages::IsEnabled() {
+        return _enabled;
+    }
+
+}
+
+#endif //GLSL_INCLUDE_DRIVER_MESSAGES_H
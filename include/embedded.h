@@ -0,0 +1,120 @@
+
+#ifndef GLSL_INCLUDE_EMBEDDED_H
+#define GLSL_INCLUDE_EMBEDDED_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace GLSL {
+
+    // 64-bit FNV-1a hash of a shader source.
+    constexpr std::uint64_t HashShaderSource(std::string_view source) {
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+
+        for (char character : source) {
+            hash ^= static_cast<unsigned char>(character);
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    // Returns the type of shader component for a given file extension, or GL_INVALID_VALUE if the extension is not supported.
+    constexpr GLenum ShaderTypeFromExtension(std::string_view shaderExtension) {
+        if (shaderExtension == "vert") {
+            return GL_VERTEX_SHADER;
+        }
+        if (shaderExtension == "frag") {
+            return GL_FRAGMENT_SHADER;
+        }
+        if (shaderExtension == "geom") {
+            return GL_GEOMETRY_SHADER;
+        }
+        if (shaderExtension == "comp") {
+            return GL_COMPUTE_SHADER;
+        }
+
+        return GL_INVALID_VALUE;
+    }
+
+    // Marker line that starts a stage of a multi-stage shader file (#pragma stage vertex). Pre-processing keeps the
+    // markers of the component file, written exactly as StageMarker followed by the stage name and a newline.
+    inline constexpr std::string_view StageMarker = "#pragma stage ";
+
+    // Returns the type of shader component for a #pragma stage name, or GL_INVALID_VALUE if the stage is not supported.
+    constexpr GLenum ShaderTypeFromStageName(std::string_view stageName) {
+        if (stageName == "vertex") {
+            return GL_VERTEX_SHADER;
+        }
+        if (stageName == "fragment") {
+            return GL_FRAGMENT_SHADER;
+        }
+        if (stageName == "geometry") {
+            return GL_GEOMETRY_SHADER;
+        }
+        if (stageName == "compute") {
+            return GL_COMPUTE_SHADER;
+        }
+
+        return GL_INVALID_VALUE;
+    }
+
+    // Splits pre-processed source at its stage markers, calling visitor(stageName, prefix, section) for every stage in
+    // order of appearance. The prefix (everything before the first marker, including #version) is shared by all stages,
+    // the section runs from the end of the marker line to the next marker. Returns the number of stages, 0 if the
+    // source has no markers.
+    template <typename Visitor>
+    constexpr std::size_t ForEachShaderStage(std::string_view source, Visitor&& visitor) {
+        std::string_view prefix;
+        std::string_view stageName;
+        std::size_t sectionStart = 0;
+        std::size_t stageCount = 0;
+        std::size_t lineStart = 0;
+
+        while (true) {
+            std::size_t lineEnd = source.find('\n', lineStart);
+            if (lineEnd == std::string_view::npos) {
+                lineEnd = source.size();
+            }
+
+            std::string_view line = source.substr(lineStart, lineEnd - lineStart);
+            if (line.substr(0, StageMarker.size()) == StageMarker) {
+                // Close the previous stage, or the shared prefix.
+                if (stageCount > 0) {
+                    visitor(stageName, prefix, source.substr(sectionStart, lineStart - sectionStart));
+                }
+                else {
+                    prefix = source.substr(0, lineStart);
+                }
+
+                stageName = line.substr(StageMarker.size());
+                sectionStart = lineEnd == source.size() ? lineEnd : lineEnd + 1;
+                ++stageCount;
+            }
+
+            if (lineEnd == source.size()) {
+                break;
+            }
+            lineStart = lineEnd + 1;
+        }
+
+        if (stageCount > 0) {
+            visitor(stageName, prefix, source.substr(sectionStart));
+        }
+
+        return stageCount;
+    }
+
+    // Shader component that was preprocessed at build time (see glsl_embed_shaders in cmake/GLSLEmbed.cmake).
+    // Constructing a Shader from embedded components performs no file I/O and no preprocessing.
+    struct EmbeddedShaderComponent {
+        std::string_view _filepath; // Path of the original shader file, used for error reporting.
+        GLenum _shaderType;
+        std::string_view _source;   // Fully expanded shader source.
+    };
+
+}
+
+#endif //GLSL_INCLUDE_EMBEDDED_H
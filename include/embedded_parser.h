@@ -0,0 +1,623 @@
+
+#ifndef GLSL_INCLUDE_EMBEDDED_PARSER_H
+#define GLSL_INCLUDE_EMBEDDED_PARSER_H
+
+#include <embedded.h>
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+
+namespace GLSL {
+
+    // Shader file embedded as a string literal, before any preprocessing.
+    struct EmbeddedFile {
+        std::string_view _filepath;
+        std::string_view _source;
+    };
+
+    inline constexpr std::array<std::string_view, 0> NoIncludeDirectories { };
+
+    // Constant-evaluable counterpart of Shader::Parser that operates on a table of embedded files instead of the file system.
+    // Applies the same #include / #ifndef / #define / #endif / #pragma once / #pragma stage / #version rules and produces
+    // the same output.
+    // When evaluated in a constant expression, any pre-processing error (missing include, unterminated include guard, ...)
+    // is reported by the compiler at the throw site.
+    template <std::size_t MaxIncludeGuards = 128, std::size_t MaxPragmas = 128>
+    class EmbeddedParser {
+        public:
+            // If output is null, only the size of the processed source is computed.
+            constexpr EmbeddedParser(const EmbeddedFile* files, std::size_t fileCount, const std::string_view* includeDirectories, std::size_t includeDirectoryCount, char* output)
+                : _files(files),
+                  _fileCount(fileCount),
+                  _includeDirectories(includeDirectories),
+                  _includeDirectoryCount(includeDirectoryCount),
+                  _output(output) {
+            }
+
+            constexpr void ProcessFile(std::string_view filepath) {
+                const EmbeddedFile* file = FindFile(filepath);
+                if (!file) {
+                    throw std::runtime_error("Could not open embedded shader file.");
+                }
+
+                // Use the path stored in the table so that pragma tracking compares equal views.
+                filepath = file->_filepath;
+                std::string_view source = file->_source;
+                int lineNumber = 1;
+                bool isInBlockComment = false; // Block comments may span lines, but not files.
+                ++_includeDepth;
+
+                while (!source.empty()) {
+                    std::size_t newlinePosition = source.find('\n');
+                    std::string_view rawLine = source.substr(0, newlinePosition);
+                    source = newlinePosition == std::string_view::npos ? std::string_view() : source.substr(newlinePosition + 1);
+
+                    ProcessLine(filepath, rawLine, lineNumber, isInBlockComment);
+                    ++lineNumber;
+                }
+                --_includeDepth;
+
+                // #pragma once pre-processor directive of an already included file pushes filename.
+                // This file has been included the maximum one time in this shader unit, resume processing after it.
+                if (_pragmaStackSize > 0 && _pragmaStack[_pragmaStackSize - 1] == filepath) {
+                    _processingExistingInclude = false;
+                    --_pragmaStackSize;
+                }
+            }
+
+            // Throws if any include guards are not properly closed.
+            constexpr void ValidateIncludeGuardScope() const {
+                for (std::size_t i = 0; i < _includeGuardCount; ++i) {
+                    if (_includeGuards[i]._endifLineNumber == -1) {
+                        throw std::runtime_error("Unterminated #ifndef directive.");
+                    }
+                }
+            }
+
+            [[nodiscard]] constexpr std::size_t GetSize() const {
+                return _size;
+            }
+
+        private:
+            static constexpr std::size_t MaxLineLength = 1024;
+            static constexpr std::size_t MaxIncludeGuardNameLength = 128;
+
+            // Include guard names are copied, as the line they appear on may not outlive the directive.
+            struct IncludeGuard {
+                char _includeGuardName[MaxIncludeGuardNameLength] { };
+                std::size_t _includeGuardNameLength = 0;
+                int _defineLineNumber = -1;
+                int _endifLineNumber = -1;
+
+                [[nodiscard]] constexpr std::string_view GetName() const {
+                    return { _includeGuardName, _includeGuardNameLength };
+                }
+            };
+
+            static constexpr bool IsWhitespace(char character) {
+                return character == ' ' || character == '\t' || character == '\r' || character == '\v' || character == '\f';
+            }
+
+            // Returns the next whitespace-delimited token starting at position, advancing position past it.
+            static constexpr std::string_view NextToken(std::string_view line, std::size_t& position) {
+                while (position < line.size() && IsWhitespace(line[position])) {
+                    ++position;
+                }
+
+                std::size_t start = position;
+                while (position < line.size() && !IsWhitespace(line[position])) {
+                    ++position;
+                }
+
+                return line.substr(start, position - start);
+            }
+
+            constexpr const EmbeddedFile* FindFile(std::string_view filepath) const {
+                for (std::size_t i = 0; i < _fileCount; ++i) {
+                    if (_files[i]._filepath == filepath) {
+                        return &_files[i];
+                    }
+                }
+
+                return nullptr;
+            }
+
+            // Emits a line followed by a newline, collapsing consecutive newlines the same way EraseNewlines does.
+            constexpr void Emit(std::string_view text) {
+                for (char character : text) {
+                    Emit(character);
+                }
+                Emit('\n');
+            }
+
+            constexpr void Emit(char character) {
+                if (character == '\n' && (_size == 0 || _lastCharacter == '\n')) {
+                    return;
+                }
+
+                if (_output) {
+                    _output[_size] = character;
+                }
+
+                _lastCharacter = character;
+                ++_size;
+            }
+
+            constexpr void ProcessLine(std::string_view filepath, std::string_view rawLine, int lineNumber, bool& isInBlockComment) {
+                // Strip comments into a fixed buffer, matching Lexer::LexLine.
+                std::string_view line = rawLine;
+
+                // Code resumes after the closing */ of a block comment opened on a previous line.
+                if (isInBlockComment) {
+                    std::size_t commentEnd = line.find("*/");
+                    if (commentEnd == std::string_view::npos) {
+                        ProcessDirective(filepath, std::string_view(), lineNumber);
+                        return;
+                    }
+
+                    line = line.substr(commentEnd + 2);
+                    isInBlockComment = false;
+                }
+
+                std::size_t commentPosition = FindComment(line);
+
+                if (commentPosition == std::string_view::npos) {
+                    ProcessDirective(filepath, line, lineNumber);
+                    return;
+                }
+
+                // Block comments may leave code on both sides; process the line in pieces without allocating.
+                char buffer[MaxLineLength] { };
+                std::size_t length = 0;
+
+                while (!line.empty()) {
+                    commentPosition = FindComment(line);
+                    std::string_view code = line.substr(0, commentPosition);
+
+                    if (length + code.size() > MaxLineLength) {
+                        throw std::runtime_error("Embedded shader line exceeds maximum supported line length.");
+                    }
+                    for (char character : code) {
+                        buffer[length++] = character;
+                    }
+
+                    if (commentPosition == std::string_view::npos) {
+                        break;
+                    }
+
+                    // Line comment, discard the remainder of the line.
+                    if (line[commentPosition + 1] == '/') {
+                        break;
+                    }
+
+                    // Block comment, resume after the closing */ (or continue the comment on the next line if unterminated).
+                    std::size_t commentEnd = line.find("*/", commentPosition + 1);
+                    isInBlockComment = commentEnd == std::string_view::npos;
+                    line = isInBlockComment ? std::string_view() : line.substr(commentEnd + 2);
+                }
+
+                ProcessDirective(filepath, std::string_view(buffer, length), lineNumber);
+            }
+
+            static constexpr std::size_t FindComment(std::string_view line) {
+                for (std::size_t i = 0; i + 1 < line.size(); ++i) {
+                    if (line[i] == '/' && (line[i + 1] == '/' || line[i + 1] == '*')) {
+                        return i;
+                    }
+                }
+
+                return std::string_view::npos;
+            }
+
+            constexpr void ProcessDirective(std::string_view filepath, std::string_view line, int lineNumber) {
+                std::size_t position = 0;
+                std::string_view token = NextToken(line, position);
+                std::string_view argument = NextToken(line, position);
+
+                // Pragma.
+                if (token == "#pragma") {
+                    // Per-draw markers are kept for PerDrawUniforms.
+                    if (argument == "per_draw") {
+                        if (!_processingExistingInclude && _hasVersionInformation) {
+                            Emit(line);
+                        }
+                    }
+                    // Stage markers are written in the form ForEachShaderStage expects.
+                    else if (argument == "stage") {
+                        std::string_view stageName = NextToken(line, position);
+                        StageDirective(stageName);
+
+                        for (char character : StageMarker) {
+                            Emit(character);
+                        }
+                        Emit(stageName);
+                    }
+                    else {
+                        PragmaDirective(filepath, argument);
+                    }
+                }
+
+                // Open include guard.
+                else if (token == "#ifndef") {
+                    OpenIncludeGuard(argument);
+                }
+
+                // Define (macro or include guard).
+                else if (token == "#define") {
+                    if (DefineDirective(argument, lineNumber)) {
+                        Emit(line);
+                    }
+                }
+
+                // Close include guard.
+                else if (token == "#endif") {
+                    CloseIncludeGuard(lineNumber);
+                }
+
+                // GLSL shader version. First version is the version of the shader.
+                else if (token == "#version") {
+                    if (!_hasVersionInformation) {
+                        Emit(line);
+                        _hasVersionInformation = true;
+                    }
+                }
+
+                // Include external file.
+                else if (token == "#include") {
+                    IncludeFile(argument);
+                }
+
+                // Normal shader line.
+                else {
+                    if (!_processingExistingInclude && _hasVersionInformation) {
+                        Emit(line);
+                    }
+                }
+            }
+
+            constexpr void StageDirective(std::string_view stageName) {
+                if (_includeDepth != 1) {
+                    throw std::runtime_error("#pragma stage is only supported in shader component files, not in included files.");
+                }
+                if (!_hasVersionInformation) {
+                    throw std::runtime_error("Version directive must precede the first #pragma stage.");
+                }
+
+                GLenum shaderType = ShaderTypeFromStageName(stageName);
+                if (shaderType == GL_INVALID_VALUE) {
+                    throw std::runtime_error("Unknown shader stage. Expected vertex, fragment, geometry or compute.");
+                }
+                for (std::size_t i = 0; i < _stageCount; ++i) {
+                    if (_stageTypes[i] == shaderType) {
+                        throw std::runtime_error("Shader stage is repeated.");
+                    }
+                }
+
+                // Files included in the shared prefix stay included, every stage may include any other file once.
+                // Include guards opened in a stage must be closed in it, the include state is reset at every marker.
+                if (_stageCount == 0) {
+                    _sharedIncludeGuardCount = _includeGuardCount;
+                    _sharedPragmaInstanceCount = _pragmaInstanceCount;
+                }
+                else {
+                    for (std::size_t i = _sharedIncludeGuardCount; i < _includeGuardCount; ++i) {
+                        if (_includeGuards[i]._endifLineNumber == -1) {
+                            throw std::runtime_error("Unterminated #ifndef directive.");
+                        }
+                        _includeGuards[i] = IncludeGuard { };
+                    }
+                    _includeGuardCount = _sharedIncludeGuardCount;
+                    _pragmaInstanceCount = _sharedPragmaInstanceCount;
+                }
+
+                _stageTypes[_stageCount++] = shaderType;
+            }
+
+            constexpr void PragmaDirective(std::string_view filepath, std::string_view argument) {
+                if (argument != "once") {
+                    throw std::runtime_error("#pragma pre-processing directive must be followed by 'once'.");
+                }
+
+                // Track this file for it to be only be included once.
+                for (std::size_t i = 0; i < _pragmaInstanceCount; ++i) {
+                    if (_pragmaInstances[i] == filepath) {
+                        // File has already been included, skip it until its end.
+                        if (_pragmaStackSize == MaxPragmas) {
+                            throw std::runtime_error("Too many nested #pragma once files for EmbeddedParser, increase MaxPragmas.");
+                        }
+
+                        _processingExistingInclude = true;
+                        _pragmaStack[_pragmaStackSize++] = filepath;
+                        return;
+                    }
+                }
+
+                if (_pragmaInstanceCount == MaxPragmas) {
+                    throw std::runtime_error("Too many #pragma once files for EmbeddedParser, increase MaxPragmas.");
+                }
+
+                _pragmaInstances[_pragmaInstanceCount++] = filepath;
+            }
+
+            constexpr void OpenIncludeGuard(std::string_view includeGuardName) {
+                if (includeGuardName.empty() || includeGuardName.front() == '#') {
+                    throw std::runtime_error("Empty #ifndef pre-processor directive. Expected macro name.");
+                }
+
+                bool found = false;
+                for (std::size_t i = 0; i < _includeGuardCount; ++i) {
+                    if (_includeGuards[i].GetName() == includeGuardName) {
+                        found = true;
+
+                        // Include guard has associated #define, this has already been included.
+                        if (_includeGuards[i]._defineLineNumber != -1) {
+                            _processingExistingInclude = true;
+                        }
+                    }
+                }
+
+                if (!found) {
+                    if (_includeGuardCount == MaxIncludeGuards) {
+                        throw std::runtime_error("Too many include guards for EmbeddedParser, increase MaxIncludeGuards.");
+                    }
+
+                    if (includeGuardName.size() > MaxIncludeGuardNameLength) {
+                        throw std::runtime_error("Include guard name exceeds maximum supported length.");
+                    }
+
+                    IncludeGuard& includeGuard = _includeGuards[_includeGuardCount++];
+                    for (char character : includeGuardName) {
+                        includeGuard._includeGuardName[includeGuard._includeGuardNameLength++] = character;
+                    }
+                }
+            }
+
+            constexpr bool DefineDirective(std::string_view defineName, int lineNumber) {
+                if (_processingExistingInclude) {
+                    return false;
+                }
+
+                if (defineName.empty() || defineName.front() == '#') {
+                    throw std::runtime_error("Empty #define pre-processor directive. Expected identifier.");
+                }
+
+                for (std::size_t i = 0; i < _includeGuardCount; ++i) {
+                    if (_includeGuards[i].GetName() == defineName) {
+                        _includeGuards[i]._defineLineNumber = lineNumber;
+                        return false;
+                    }
+                }
+
+                // Shader version information must be the first compiled line of shader code.
+                if (!_hasVersionInformation) {
+                    throw std::runtime_error("Version directive must be first statement and may not be repeated.");
+                }
+
+                // Regular define.
+                return true;
+            }
+
+            constexpr void CloseIncludeGuard(int lineNumber) {
+                // Reached the end of this include guard, safe to include file lines once again.
+                if (_processingExistingInclude) {
+                    _processingExistingInclude = false;
+                    return;
+                }
+
+                // Close the last unterminated include guard.
+                for (std::size_t i = _includeGuardCount; i > 0; --i) {
+                    if (_includeGuards[i - 1]._endifLineNumber == -1) {
+                        _includeGuards[i - 1]._endifLineNumber = lineNumber;
+                        return;
+                    }
+                }
+
+                throw std::runtime_error("#endif pre-processor directive without preexisting #if / #ifndef directive.");
+            }
+
+            constexpr void IncludeFile(std::string_view fileToInclude) {
+                if (_processingExistingInclude) {
+                    return;
+                }
+
+                if (fileToInclude.size() < 2 || fileToInclude.front() == '#') {
+                    throw std::runtime_error("Empty #include pre-processor directive. Expected <filename> or \"filename\".");
+                }
+
+                char beginning = fileToInclude.front();
+                char end = fileToInclude.back();
+                std::string_view filename = fileToInclude.substr(1, fileToInclude.size() - 2);
+
+                // Using include directories.
+                if (beginning == '<' && end == '>') {
+                    for (std::size_t i = 0; i < _includeDirectoryCount; ++i) {
+                        std::string_view directory = _includeDirectories[i];
+
+                        for (std::size_t j = 0; j < _fileCount; ++j) {
+                            std::string_view filepath = _files[j]._filepath;
+
+                            // filepath == directory + filename.
+                            if (filepath.size() == directory.size() + filename.size() && filepath.substr(0, directory.size()) == directory && filepath.substr(directory.size()) == filename) {
+                                ProcessFile(filepath);
+                                return;
+                            }
+                        }
+                    }
+
+                    throw std::runtime_error("Included file was not found in the provided include directories.");
+                }
+                // Using the path as given.
+                else if (beginning == '"' && end == '"') {
+                    ProcessFile(filename);
+                }
+                else {
+                    throw std::runtime_error("Formatting mismatch. Expected <filename> or \"filename\".");
+                }
+            }
+
+            const EmbeddedFile* _files;
+            std::size_t _fileCount;
+            const std::string_view* _includeDirectories;
+            std::size_t _includeDirectoryCount;
+
+            char* _output;
+            std::size_t _size = 0;
+            char _lastCharacter = '\0';
+
+            // Include guards.
+            IncludeGuard _includeGuards[MaxIncludeGuards] { };
+            std::size_t _includeGuardCount = 0;
+
+            // Pragmas.
+            std::string_view _pragmaInstances[MaxPragmas] { };
+            std::size_t _pragmaInstanceCount = 0;
+            std::string_view _pragmaStack[MaxPragmas] { };
+            std::size_t _pragmaStackSize = 0;
+
+            // Stages. Include state at the first #pragma stage, restored at every following one.
+            GLenum _stageTypes[4] { };
+            std::size_t _stageCount = 0;
+            std::size_t _sharedIncludeGuardCount = 0;
+            std::size_t _sharedPragmaInstanceCount = 0;
+
+            int _includeDepth = 0; // Number of files currently being processed.
+            bool _hasVersionInformation = false;
+            bool _processingExistingInclude = false;
+    };
+
+    namespace Detail {
+
+        template <const auto& Files, const auto& IncludeDirectories>
+        constexpr std::size_t ExpandEmbeddedFile(std::size_t index, char* output) {
+            EmbeddedParser<> parser(std::data(Files), std::size(Files), std::data(IncludeDirectories), std::size(IncludeDirectories), output);
+            parser.ProcessFile(Files[index]._filepath);
+            parser.ValidateIncludeGuardScope();
+            return parser.GetSize();
+        }
+
+        template <const auto& Files, const auto& IncludeDirectories, std::size_t Index>
+        constexpr auto ExpandEmbeddedFileToArray() {
+            std::array<char, ExpandEmbeddedFile<Files, IncludeDirectories>(Index, nullptr) + 1> buffer { };
+            ExpandEmbeddedFile<Files, IncludeDirectories>(Index, buffer.data());
+            return buffer;
+        }
+
+        constexpr std::string_view GetExtension(std::string_view filepath) {
+            std::size_t dotPosition = filepath.find_last_of('.');
+            return dotPosition == std::string_view::npos ? std::string_view() : filepath.substr(dotPosition + 1);
+        }
+
+        constexpr std::string_view GetStageName(GLenum shaderType) {
+            switch (shaderType) {
+                case GL_VERTEX_SHADER:
+                    return "vertex";
+                case GL_FRAGMENT_SHADER:
+                    return "fragment";
+                case GL_GEOMETRY_SHADER:
+                    return "geometry";
+                case GL_COMPUTE_SHADER:
+                    return "compute";
+                default:
+                    throw std::runtime_error("Unknown or unsupported shader stage.");
+            }
+        }
+
+        // Copies the prefix and section of one stage of expanded source, see ForEachShaderStage.
+        constexpr std::size_t ExtractStage(std::string_view source, GLenum shaderType, char* output) {
+            std::size_t size = 0;
+            bool found = false;
+
+            ForEachShaderStage(source, [&](std::string_view stageName, std::string_view prefix, std::string_view section) {
+                if (ShaderTypeFromStageName(stageName) != shaderType) {
+                    return;
+                }
+
+                found = true;
+                for (std::string_view part : { prefix, section }) {
+                    for (char character : part) {
+                        if (output) {
+                            output[size] = character;
+                        }
+                        ++size;
+                    }
+                }
+            });
+
+            if (!found) {
+                throw std::runtime_error("Embedded shader file has no section for the requested #pragma stage.");
+            }
+
+            return size;
+        }
+
+        template <const std::string_view& Source, GLenum ShaderType>
+        constexpr auto ExtractStageToArray() {
+            std::array<char, ExtractStage(Source, ShaderType, nullptr) + 1> buffer { };
+            ExtractStage(Source, ShaderType, buffer.data());
+            return buffer;
+        }
+
+        // Filepath of a stage, as Shader::PreprocessShader keys it (color.glsl.vertex).
+        template <const std::string_view& Filepath, GLenum ShaderType>
+        constexpr auto GetStageFilepathArray() {
+            constexpr std::string_view stageName = GetStageName(ShaderType);
+            std::array<char, Filepath.size() + 1 + stageName.size() + 1> buffer { };
+            std::size_t size = 0;
+
+            for (char character : Filepath) {
+                buffer[size++] = character;
+            }
+            buffer[size++] = '.';
+            for (char character : stageName) {
+                buffer[size++] = character;
+            }
+
+            return buffer;
+        }
+
+    }
+
+    // Fully expands entry Index of a table of embedded files. Expansion and validation happen during compilation:
+    //
+    //     inline constexpr GLSL::EmbeddedFile files[] = { { "color.vert", "..." }, { "shaders/helper.glsl", "..." } };
+    //     inline constexpr std::string_view includeDirectories[] = { "shaders/" };
+    //     GLSL::Shader shader("Color", { GLSL::ExpandedEmbeddedFile<files, includeDirectories, 0>::_component });
+    template <const auto& Files, const auto& IncludeDirectories, std::size_t Index>
+    struct ExpandedEmbeddedFile {
+        static constexpr auto _buffer = Detail::ExpandEmbeddedFileToArray<Files, IncludeDirectories, Index>();
+        static constexpr std::string_view _source { _buffer.data(), _buffer.size() - 1 };
+
+        // Expanded file as a shader component that can be passed directly to GLSL::Shader.
+        static constexpr EmbeddedShaderComponent _component {
+            Files[Index]._filepath,
+            ShaderTypeFromExtension(Detail::GetExtension(Files[Index]._filepath)),
+            _source
+        };
+    };
+
+    // Stage ShaderType of a multi-stage embedded file (see Shader::SplitStages), expanded during compilation:
+    //
+    //     GLSL::Shader shader("Color", { GLSL::ExpandedEmbeddedStage<files, includeDirectories, 0, GL_VERTEX_SHADER>::_component,
+    //                                    GLSL::ExpandedEmbeddedStage<files, includeDirectories, 0, GL_FRAGMENT_SHADER>::_component });
+    template <const auto& Files, const auto& IncludeDirectories, std::size_t Index, GLenum ShaderType>
+    struct ExpandedEmbeddedStage {
+        static constexpr std::string_view _filepath = Files[Index]._filepath;
+        static constexpr auto _filepathBuffer = Detail::GetStageFilepathArray<_filepath, ShaderType>();
+        static constexpr auto _buffer = Detail::ExtractStageToArray<ExpandedEmbeddedFile<Files, IncludeDirectories, Index>::_source, ShaderType>();
+        static constexpr std::string_view _source { _buffer.data(), _buffer.size() - 1 };
+
+        // Expanded stage as a shader component that can be passed directly to GLSL::Shader.
+        static constexpr EmbeddedShaderComponent _component {
+            { _filepathBuffer.data(), _filepathBuffer.size() - 1 },
+            ShaderType,
+            _source
+        };
+    };
+
+}
+
+#endif //GLSL_INCLUDE_EMBEDDED_PARSER_H
@@ -0,0 +1,107 @@
+
+#ifndef GLSL_INCLUDE_GL_DISPATCH_H
+#define GLSL_INCLUDE_GL_DISPATCH_H
+
+#include <glad/glad.h>
+
+namespace GLSL {
+
+    // Table of the OpenGL entry points used by Shader, DrawBatcher, PrewarmTarget and DriverMessages. All of their code paths call OpenGL through this table, which by
+    // default forwards to glad. Swapping it (see RecordingGL) allows shaders to be built and used without a context.
+    struct GLDispatch {
+        // Shader components.
+        GLuint (*CreateShader)(GLenum type);
+        void (*DeleteShader)(GLuint shader);
+        void (*ShaderSource)(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+        void (*CompileShader)(GLuint shader);
+        void (*GetShaderiv)(GLuint shader, GLenum pname, GLint* params);
+        void (*GetShaderInfoLog)(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+
+        // Shader programs.
+        GLuint (*CreateProgram)();
+        void (*DeleteProgram)(GLuint program);
+        void (*AttachShader)(GLuint program, GLuint shader);
+        void (*DetachShader)(GLuint program, GLuint shader);
+        void (*LinkProgram)(GLuint program);
+        void (*GetProgramiv)(GLuint program, GLenum pname, GLint* params);
+        void (*GetProgramInfoLog)(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+        void (*UseProgram)(GLuint program);
+        void (*ProgramParameteri)(GLuint program, GLenum pname, GLint value);
+        void (*GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+        void (*ProgramBinary)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+        void (*GetActiveAttrib)(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name);
+        GLint (*GetAttribLocation)(GLuint program, const GLchar* name);
+
+        // Uniforms.
+        GLint (*GetUniformLocation)(GLuint program, const GLchar* name);
+        void (*Uniform1i)(GLint location, GLint v0);
+        void (*Uniform1f)(GLint location, GLfloat v0);
+        void (*Uniform2fv)(GLint location, GLsizei count, const GLfloat* value);
+        void (*Uniform3fv)(GLint location, GLsizei count, const GLfloat* value);
+        void (*Uniform4fv)(GLint location, GLsizei count, const GLfloat* value);
+        void (*UniformMatrix3fv)(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+        void (*UniformMatrix4fv)(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+        // Queries and context state.
+        const GLubyte* (*GetString)(GLenum name);
+        void (*GetIntegerv)(GLenum pname, GLint* data);
+        const GLubyte* (*GetStringi)(GLenum name, GLuint index);
+        void (*GenQueries)(GLsizei n, GLuint* ids);
+        void (*DeleteQueries)(GLsizei n, const GLuint* ids);
+        void (*BeginQuery)(GLenum target, GLuint id);
+        void (*EndQuery)(GLenum target);
+        void (*GetQueryObjectiv)(GLuint id, GLenum pname, GLint* params);
+        void (*GetQueryObjectui64v)(GLuint id, GLenum pname, GLuint64* params);
+
+        // Buffers and draws.
+        void (*GenBuffers)(GLsizei n, GLuint* buffers);
+        void (*DeleteBuffers)(GLsizei n, const GLuint* buffers);
+        void (*BindBuffer)(GLenum target, GLuint buffer);
+        void (*BufferData)(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+        void (*BindBufferBase)(GLenum target, GLuint index, GLuint buffer);
+        void (*DrawElementsInstancedBaseVertex)(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex);
+        void (*MultiDrawElementsIndirect)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+        void (*DrawArrays)(GLenum mode, GLint first, GLsizei count);
+
+        // Framebuffers and vertex arrays.
+        void (*GenFramebuffers)(GLsizei n, GLuint* framebuffers);
+        void (*DeleteFramebuffers)(GLsizei n, const GLuint* framebuffers);
+        void (*BindFramebuffer)(GLenum target, GLuint framebuffer);
+        void (*GenRenderbuffers)(GLsizei n, GLuint* renderbuffers);
+        void (*DeleteRenderbuffers)(GLsizei n, const GLuint* renderbuffers);
+        void (*BindRenderbuffer)(GLenum target, GLuint renderbuffer);
+        void (*RenderbufferStorage)(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+        void (*FramebufferRenderbuffer)(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+        void (*GenVertexArrays)(GLsizei n, GLuint* arrays);
+        void (*DeleteVertexArrays)(GLsizei n, const GLuint* arrays);
+        void (*BindVertexArray)(GLuint array);
+        void (*EnableVertexAttribArray)(GLuint index);
+        void (*VertexAttribPointer)(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+        void (*VertexAttribIPointer)(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer);
+        void (*Viewport)(GLint x, GLint y, GLsizei width, GLsizei height);
+
+        // Debug output.
+        void (*Enable)(GLenum cap);
+        void (*Disable)(GLenum cap);
+        void (*DebugMessageCallback)(GLDEBUGPROC callback, const void* userParam);
+        void (*DebugMessageControl)(GLenum source, GLenum type, GLenum severity, GLsizei count, const GLuint* ids, GLboolean enabled);
+    };
+
+    // Returns the dispatch table that forwards every entry point to glad.
+    const GLDispatch& GetGladDispatch();
+
+    // Replaces the active dispatch table. Must not be called while another thread is issuing OpenGL calls through it.
+    void SetGLDispatch(const GLDispatch& dispatch);
+
+    namespace Detail {
+        extern GLDispatch _glDispatch;
+    }
+
+    // Active dispatch table.
+    inline const GLDispatch& GL() {
+        return Detail::_glDispatch;
+    }
+
+}
+
+#endif //GLSL_INCLUDE_GL_DISPATCH_H
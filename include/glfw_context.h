@@ -0,0 +1,16 @@
+#ifndef GLSL_INCLUDE_GLFW_CONTEXT_H
+#define GLSL_INCLUDE_GLFW_CONTEXT_H
+
+namespace GLSL {
+
+    // Initializes GLFW for the demo and the tools that create an OpenGL context. With headless set,
+    // GLFW runs on its null platform, so no display server is needed, and contexts are created through surfaceless EGL
+    // (e.g. Mesa llvmpipe on a build machine). Such a context has no usable default framebuffer, render into framebuffer
+    // objects instead.
+    // Returns false if GLFW could not be initialized, or if headless is set and GLFW was built without the null platform
+    // (requires GLFW 3.4). Window hints must be set after this call, since initializing GLFW resets them.
+    [[nodiscard]] bool InitializeGLFW(bool headless);
+
+}
+
+#endif //GLSL_INCLUDE_GLFW_CONTEXT_H
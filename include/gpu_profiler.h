@@ -0,0 +1,67 @@
+
+#ifndef GLSL_INCLUDE_GPU_PROFILER_H
+#define GLSL_INCLUDE_GPU_PROFILER_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace GLSL {
+
+    // Optional GPU-side profiling of shaders. While enabled, the work between Shader::Bind() and Shader::Unbind() (or the
+    // next Bind()) is measured with a GL_TIME_ELAPSED query and, where ARB_pipeline_statistics_query (core in OpenGL 4.6) is
+    // available, pipeline statistics queries. Queries are kept in a ring buffer and only read back once their results are
+    // available, so collecting never stalls the pipeline; scopes are dropped instead when the ring buffer is full.
+    // Results are aggregated per shader name. All functions must be called from the thread that owns the OpenGL context.
+    class GPUProfiler {
+        public:
+            enum class PipelineStatistic {
+                VerticesSubmitted, PrimitivesSubmitted, VertexShaderInvocations, GeometryShaderInvocations,
+                FragmentShaderInvocations, ClippingInputPrimitives, ClippingOutputPrimitives,
+                Count
+            };
+
+            struct ShaderStatistics {
+                std::string _shaderName;
+                std::uint64_t _samples = 0;
+                std::uint64_t _totalNanoseconds = 0;
+                std::uint64_t _minNanoseconds = std::numeric_limits<std::uint64_t>::max();
+                std::uint64_t _maxNanoseconds = 0;
+                std::array<std::uint64_t, static_cast<std::size_t>(PipelineStatistic::Count)> _pipelineStatistics { }; // Totals.
+            };
+
+            // Creates the query objects. ringSize is the number of measured scopes that may be in flight at once, it should
+            // cover a few frames worth of binds.
+            static void Enable(std::size_t ringSize = 4096);
+            // Deletes the query objects. Aggregated statistics are kept until Reset().
+            static void Disable();
+            [[nodiscard]] static bool IsEnabled();
+            [[nodiscard]] static bool HasPipelineStatistics();
+
+            // Called by Shader::Bind() and Shader::Unbind().
+            static void Begin(const std::string& shaderName);
+            static void End();
+
+            // Reads back every query whose result is available. Call once per frame.
+            static void Collect();
+
+            [[nodiscard]] static const std::vector<ShaderStatistics>& GetStatistics();
+            // Number of scopes that were not measured because the ring buffer was full.
+            [[nodiscard]] static std::uint64_t GetDroppedScopes();
+            static void Reset();
+
+            [[nodiscard]] static const char* GetPipelineStatisticName(PipelineStatistic statistic);
+
+        private:
+            static bool _enabled;
+    };
+
+    inline bool GPUProfiler::IsEnabled() {
+        return _enabled;
+    }
+
+}
+
+#endif //GLSL_INCLUDE_GPU_PROFILER_H
@@ -0,0 +1,56 @@
+
+#ifndef GLSL_INCLUDE_LEXER_H
+#define GLSL_INCLUDE_LEXER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GLSL {
+
+    // Shader source split into lines as seen by the pre-processor.
+    struct LexedSource {
+        std::vector<std::string> _lines;          // Without newline and comments, index is the line number - 1.
+        std::vector<std::size_t> _directiveLines; // Indices of the lines that start with '#', ascending.
+    };
+
+    // Strips comments from shader sources. Block comments may span lines, the lines they cover are kept (empty) so that
+    // line numbers are preserved. GLSL has no string literals, the comment state is all that carries from one line to
+    // the next.
+    //
+    // Large sources are split into chunks at line boundaries and lexed in parallel, every chunk speculatively starting
+    // outside of a comment. Chunks are then stitched together in order: a chunk that actually starts inside a block
+    // comment is re-lexed line by line until its comment state agrees with the speculative one, which happens on the line
+    // that closes the comment, after which the speculative lines are kept.
+    class Lexer {
+        public:
+            enum class State {
+                Code,
+                BlockComment
+            };
+
+            // Sources of at least two chunks are lexed in parallel.
+            static constexpr std::size_t ChunkSize = 256 * 1024;
+
+            // Strips comments from a single line (without its newline), starting in state. Returns the state at the end of the line.
+            static State LexLine(std::string_view line, State state, std::string& lexedLine);
+
+            // Returns true if a lexed line is a pre-processor directive.
+            [[nodiscard]] static bool IsDirective(std::string_view lexedLine);
+
+            // Lexes a complete source. Like std::getline in a loop until end-of-file, text after the last newline is
+            // always a line, even if empty. Uses at most threadCount threads, including the calling thread: 0 uses the
+            // hardware concurrency, 1 disables parallel lexing (e.g. when sources are already pre-processed in parallel).
+            static LexedSource Lex(std::string_view source, std::size_t threadCount = 0);
+
+            // Returns a form of source that only changes with its token stream: comments are removed, whitespace is
+            // collapsed to a single space where it separates tokens that would otherwise join and dropped everywhere
+            // else, and line breaks are kept only where they end a directive (or everywhere if source uses __LINE__).
+            // Meant for hashing, the result is not necessarily valid GLSL.
+            [[nodiscard]] static std::string Canonicalize(std::string_view source);
+    };
+
+}
+
+#endif //GLSL_INCLUDE_LEXER_H
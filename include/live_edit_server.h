@@ -0,0 +1,69 @@
+
+#ifndef GLSL_INCLUDE_LIVE_EDIT_SERVER_H
+#define GLSL_INCLUDE_LIVE_EDIT_SERVER_H
+
+#include <sockets.h>
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace GLSL {
+
+    class Shader;
+
+    // Local socket through which a shader editor streams its unsaved buffers into SourceOverlay. Shaders whose include
+    // closure contains an edited file are recompiled from memory, without writing the file or re-reading the others.
+    // Listens on 127.0.0.1 only, and never blocks: all socket work happens in Poll().
+    //
+    // Protocol: every message is a header line terminated by '\n', followed by exactly <length> bytes of payload.
+    // Paths are the remainder of the header line and may contain spaces. Lines and columns are zero-based, columns
+    // count bytes. Files opened by a connection are closed when it disconnects.
+    //  OPEN <length> <path>                                                  Overlays path with the payload.
+    //  EDIT <startLine> <startColumn> <endLine> <endColumn> <length> <path>  Replaces the range with the payload.
+    //  CLOSE <path>                                                          Reverts path to its contents on disk.
+    // Every request is answered with "OK" or "ERROR <length>" followed by the error message. After a poll that changed
+    // files, every connection receives one "BUILD OK <shader name>" or "BUILD FAILED <length> <shader name>" (followed by
+    // the error message) per recompiled shader. A shader that fails to recompile keeps its last good program.
+    class LiveEditServer {
+        public:
+            // Port 0 picks a free port (see GetPort). Throws std::runtime_error if the socket cannot be set up.
+            explicit LiveEditServer(unsigned short port);
+            ~LiveEditServer();
+
+            LiveEditServer(const LiveEditServer&) = delete;
+            LiveEditServer& operator=(const LiveEditServer&) = delete;
+
+            [[nodiscard]] unsigned short GetPort() const;
+
+            // Registered shaders are recompiled when their files are edited. Shaders must be unregistered before destruction.
+            void Register(Shader& shader);
+            void Unregister(Shader& shader);
+
+            // Accepts connections, applies received edits and recompiles affected shaders. Call regularly (e.g. once per
+            // frame) from the thread the OpenGL context is current on. Returns the number of recompiled shaders.
+            std::size_t Poll();
+
+        private:
+            struct Connection : Sockets::Connection {
+                std::set<std::string> _openFiles; // Overlay keys.
+            };
+
+            void AcceptConnections();
+            // Applies every complete message received on connection, adding the keys of changed files to changedFiles.
+            void ProcessMessages(Connection& connection, std::set<std::string>& changedFiles) const;
+
+            // Recompiles every registered shader that depends on one of changedFiles. Returns the number of recompiled shaders.
+            std::size_t RecompileAffectedShaders(const std::set<std::string>& changedFiles);
+
+            std::intptr_t _listenSocket;
+            unsigned short _port;
+
+            std::vector<Connection> _connections;
+            std::vector<Shader*> _shaders;
+    };
+
+}
+
+#endif //GLSL_INCLUDE_LIVE_EDIT_SERVER_H
@@ -0,0 +1,69 @@
+
+#ifndef GLSL_INCLUDE_PARAM_BLOCK_H
+#define GLSL_INCLUDE_PARAM_BLOCK_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace GLSL {
+
+    // Uniform that a member of a parameter struct is uploaded to.
+    template <typename Params, typename Member>
+    struct ParamMember {
+        const char* _name;          // Uniform name in the shader.
+        Member Params::* _pointer;
+    };
+
+    template <typename DataType>
+    constexpr bool IsParamType = std::is_same_v<DataType, int> || std::is_same_v<DataType, bool> || std::is_same_v<DataType, float> ||
+                                 std::is_same_v<DataType, glm::vec2> || std::is_same_v<DataType, glm::vec3> || std::is_same_v<DataType, glm::vec4> ||
+                                 std::is_same_v<DataType, glm::mat3> || std::is_same_v<DataType, glm::mat4>;
+
+    // Describes one member of a parameter struct, see ParamBlock.
+    template <typename Params, typename Member>
+    constexpr ParamMember<Params, Member> Param(const char* name, Member Params::* pointer) {
+        static_assert(IsParamType<Member>, "Parameter members must be of a type supported by Shader::SetUniform.");
+        return { name, pointer };
+    }
+
+    // Compile-time description of a parameter struct, specialized for every struct passed to Shader::SetParams:
+    //
+    //     struct MaterialParams {
+    //         glm::vec3 surfaceColor;
+    //         glm::mat4 modelTransform;
+    //     };
+    //
+    //     template <>
+    //     struct GLSL::ParamBlock<MaterialParams> {
+    //         static constexpr auto Members = std::make_tuple(GLSL::Param("surfaceColor", &MaterialParams::surfaceColor),
+    //                                                         GLSL::Param("modelTransform", &MaterialParams::modelTransform));
+    //     };
+    //
+    // The upload function of every member is selected at compile time from its type.
+    template <typename Params>
+    struct ParamBlock;
+
+    template <typename Params>
+    constexpr std::size_t ParamMemberCount = std::tuple_size_v<std::decay_t<decltype(ParamBlock<Params>::Members)>>;
+
+    // Type-erased base of the upload plans a shader keeps per parameter struct.
+    struct ParamUploadPlanBase {
+        virtual ~ParamUploadPlanBase() = default;
+    };
+
+    // Uniform locations of the members of Params in one linked program (in member order, -1 for members that are not
+    // active), and the values uploaded last for changed-only uploads. Built on the first SetParams after linking.
+    template <typename Params>
+    struct ParamUploadPlan : ParamUploadPlanBase {
+        std::array<GLint, ParamMemberCount<Params>> _locations { };
+        Params _lastValues { };
+        bool _hasLastValues = false;
+    };
+
+}
+
+#endif //GLSL_INCLUDE_PARAM_BLOCK_H
@@ -0,0 +1,55 @@
+
+#ifndef GLSL_INCLUDE_PER_DRAW_UNIFORMS_H
+#define GLSL_INCLUDE_PER_DRAW_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace GLSL {
+
+    // std430 layout of one element of the per-draw storage buffer that uniforms marked with #pragma per_draw are
+    // rewritten into. Identical for every shader component of a program.
+    struct PerDrawLayout {
+        struct Member {
+            std::string _name;
+            std::string _type;
+            std::size_t _offset = 0;
+        };
+
+        std::vector<Member> _members;
+        std::size_t _stride = 0; // Size of one element, including padding.
+
+        [[nodiscard]] bool IsEmpty() const;
+        // Returns nullptr if name is not a per-draw uniform.
+        [[nodiscard]] const Member* Find(const std::string& name) const;
+    };
+
+    // Rewrites uniforms marked as per-draw into an indexed storage buffer:
+    //   #pragma per_draw
+    //   uniform mat4 modelTransform;
+    // becomes a member of a buffer block array, and every use of modelTransform reads the element of the current draw.
+    // The vertex stage computes the draw index from glslDrawOffset + gl_DrawID (0 without shader draw parameters)
+    // + gl_InstanceID and forwards it to the fragment stage as a flat varying. Supported types are int, bool, float,
+    // vec2, vec3, vec4, mat3 and mat4. Programs with per-draw uniforms can only consist of vertex and fragment stages.
+    class PerDrawUniforms {
+        public:
+            // Shader storage buffer binding of the per-draw buffer.
+            static constexpr GLuint BufferBinding = 7;
+
+            // Rewrites the per-draw uniforms of every pre-processed component (filepath -> shader type and source) and
+            // returns their layout. If disabled, markers are removed and the uniforms stay regular uniforms.
+            // Throws std::runtime_error on malformed markers, unsupported types or unsupported stages.
+            static PerDrawLayout Apply(std::unordered_map<std::string, std::pair<GLenum, std::string>>& shaderComponents, bool enabled);
+
+            // Returns the std430 size and alignment of a supported type, 0 for unsupported types.
+            static std::size_t GetTypeSize(const std::string& type);
+            static std::size_t GetTypeAlignment(const std::string& type);
+    };
+
+}
+
+#endif //GLSL_INCLUDE_PER_DRAW_UNIFORMS_H
@@ -0,0 +1,52 @@
+
+#ifndef GLSL_INCLUDE_PREWARM_TARGET_H
+#define GLSL_INCLUDE_PREWARM_TARGET_H
+
+#include <glad/glad.h>
+
+namespace GLSL {
+
+    class Shader;
+
+    // Offscreen 1x1 framebuffer (RGBA8 color, 24-bit depth and 8-bit stencil) that shaders are drawn into once while
+    // loading, see Shader::Prewarm. Many drivers defer the final, state-dependent compile of a program to its first
+    // draw; drawing here moves that stall out of the first frame that uses the program.
+    //
+    // Draws use the current render state of the context (blending, depth test, ...), so pre-warm with the state the
+    // shaders are drawn with. Every reflected vertex attribute is read from a zero-filled buffer in the format it is
+    // declared with (floats for float attributes, integers for integer ones); double attributes are left disabled.
+    // The framebuffer, renderbuffer, vertex array, array buffer, program and viewport bound on construction are
+    // restored on destruction. All functions must be called from the thread that owns the OpenGL context.
+    class PrewarmTarget {
+        public:
+            PrewarmTarget();
+            ~PrewarmTarget();
+
+            PrewarmTarget(const PrewarmTarget&) = delete;
+            PrewarmTarget& operator=(const PrewarmTarget&) = delete;
+
+            // Draws a single primitive of mode with shader. Per-draw uniforms (see Shader::SetDrawBatching) read zeros.
+            void Draw(const Shader& shader, GLenum mode);
+
+        private:
+            // Grows the zero-filled buffer to at least size bytes. Leaves it bound to GL_ARRAY_BUFFER.
+            void ReserveZeroBuffer(GLsizeiptr size);
+
+            GLuint _framebuffer;
+            GLuint _colorRenderbuffer;
+            GLuint _depthStencilRenderbuffer;
+            GLuint _zeroBuffer;
+            GLsizeiptr _zeroBufferSize;
+
+            // Bindings on construction.
+            GLint _previousFramebuffer;
+            GLint _previousRenderbuffer;
+            GLint _previousVertexArray;
+            GLint _previousArrayBuffer;
+            GLint _previousProgram;
+            GLint _previousViewport[4];
+    };
+
+}
+
+#endif //GLSL_INCLUDE_PREWARM_TARGET_H
@@ -0,0 +1,65 @@
+
+#ifndef GLSL_INCLUDE_PROGRAM_BINARY_CACHE_H
+#define GLSL_INCLUDE_PROGRAM_BINARY_CACHE_H
+
+#include <glad/glad.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace GLSL {
+
+    class SharedCacheClient;
+
+    // On-disk cache of linked program binaries (glGetProgramBinary), stored as one <key>.bin file per program.
+    // Keys are derived from the fully pre-processed sources of every shader component and the identity of the driver
+    // (vendor, renderer and version), so a binary is only ever loaded by the driver that produced it. Sources are hashed
+    // in canonical form (see Lexer::Canonicalize), so edits to comments or formatting keep hitting existing entries.
+    // Entries are written through a temporary file and renamed, so several processes may fill the same cache concurrently.
+    // Optionally backed by a shared cache (see SharedCacheClient): local misses are looked up remotely and copied to the
+    // directory, stored entries are also uploaded, so build machines reuse each other's binaries.
+    class ProgramBinaryCache {
+        public:
+            struct ProgramBinary {
+                GLenum _format = 0;
+                std::vector<char> _data;
+            };
+
+            // An empty directory disables the cache. The shared cache at remoteAddress ("<host>:<port>", empty for none)
+            // is only used as the second tier of an enabled cache.
+            explicit ProgramBinaryCache(std::string directory = "", const std::string& remoteAddress = "");
+
+            [[nodiscard]] bool IsEnabled() const;
+            [[nodiscard]] const std::string& GetDirectory() const;
+            // Empty if there is no shared cache.
+            [[nodiscard]] std::string GetRemoteAddress() const;
+
+            // Requires a current OpenGL context. Components map filepath to shader type and pre-processed source.
+            [[nodiscard]] static std::string GetKey(const std::unordered_map<std::string, std::pair<GLenum, std::string>>& shaderComponents);
+            // Vendor, renderer and version strings of the current context, queried once.
+            [[nodiscard]] static const std::string& GetDriverIdentity();
+
+            // Returns true if the directory holds an entry for key, without reading or validating it. The shared cache is not consulted.
+            [[nodiscard]] bool Contains(const std::string& key) const;
+            // Returns false if there is no (valid) entry for key.
+            bool Load(const std::string& key, ProgramBinary& programBinary) const;
+            // Throws std::runtime_error or std::filesystem::filesystem_error if the entry cannot be written locally. Uploading to
+            // the shared cache is best effort.
+            void Store(const std::string& key, const ProgramBinary& programBinary) const;
+
+            // Moves every entry of source into this cache. Entries already present are kept. Returns the number of moved entries.
+            std::size_t Merge(const ProgramBinaryCache& source) const;
+
+        private:
+            [[nodiscard]] std::string GetEntryPath(const std::string& key) const;
+            void WriteEntry(const std::string& key, const std::vector<char>& entry) const;
+
+            std::string _directory;
+            std::shared_ptr<SharedCacheClient> _remote; // Shared between copies, connections are kept across builds.
+    };
+
+}
+
+#endif //GLSL_INCLUDE_PROGRAM_BINARY_CACHE_H
@@ -0,0 +1,110 @@
+
+#ifndef GLSL_INCLUDE_RECORDING_GL_H
+#define GLSL_INCLUDE_RECORDING_GL_H
+
+#include <gl_dispatch.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GLSL {
+
+    // OpenGL dispatch table that counts every call made through it and captures uniform traffic.
+    // Without a forwarding table, it acts as a mock OpenGL implementation: compilation and linking always succeed (unless
+    // failures are requested) after a configurable simulated latency, so Shader code paths can run without a context.
+    // Mock queries complete immediately with a result of 0, and the mock context reports no extensions. Mock program
+    // binaries only record the program they were retrieved from, loading one always succeeds (unless link failures are
+    // requested). Mock programs have no active attributes. Mock buffers, framebuffers, vertex arrays and draws only hand
+    // out names and are otherwise ignored. The mock debug message callback only receives messages from InjectDebugMessage.
+    // With a forwarding table (e.g. GetGladDispatch()), calls are counted and then passed through to real OpenGL.
+    // Only one RecordingGL may be installed at a time.
+    class RecordingGL {
+        public:
+            enum class Function {
+                CreateShader, DeleteShader, ShaderSource, CompileShader, GetShaderiv, GetShaderInfoLog,
+                CreateProgram, DeleteProgram, AttachShader, DetachShader, LinkProgram, GetProgramiv, GetProgramInfoLog, UseProgram,
+                ProgramParameteri, GetProgramBinary, ProgramBinary, GetActiveAttrib, GetAttribLocation,
+                GetUniformLocation, Uniform1i, Uniform1f, Uniform2fv, Uniform3fv, Uniform4fv, UniformMatrix3fv, UniformMatrix4fv,
+                GetString, GetIntegerv, GetStringi, GenQueries, DeleteQueries, BeginQuery, EndQuery, GetQueryObjectiv, GetQueryObjectui64v,
+                GenBuffers, DeleteBuffers, BindBuffer, BufferData, BindBufferBase, DrawElementsInstancedBaseVertex, MultiDrawElementsIndirect,
+                DrawArrays,
+                GenFramebuffers, DeleteFramebuffers, BindFramebuffer, GenRenderbuffers, DeleteRenderbuffers, BindRenderbuffer,
+                RenderbufferStorage, FramebufferRenderbuffer, GenVertexArrays, DeleteVertexArrays, BindVertexArray,
+                EnableVertexAttribArray, VertexAttribPointer, VertexAttribIPointer, Viewport,
+                Enable, Disable, DebugMessageCallback, DebugMessageControl,
+                Count
+            };
+
+            struct UniformUpload {
+                GLuint _program;        // Program bound when the upload was issued.
+                GLint _location;
+                Function _function;
+                std::vector<float> _data; // Integer uploads are stored converted to float.
+            };
+
+            RecordingGL();
+            explicit RecordingGL(const GLDispatch& forwardDispatch);
+            ~RecordingGL();
+
+            // Makes this the active dispatch table. The previously active table is restored on Uninstall() / destruction.
+            void Install();
+            void Uninstall();
+
+            // Simulated driver behavior (mock mode only).
+            void SetCompileLatency(std::chrono::microseconds compileLatency);
+            void SetLinkLatency(std::chrono::microseconds linkLatency);
+            void SetCompileFailure(bool fail);
+            void SetLinkFailure(bool fail);
+            // Delivers a message to the installed debug message callback, as a driver would during the current call.
+            void InjectDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, const std::string& message);
+
+            // Capturing uniform values allocates, disable for allocation-sensitive measurements.
+            void SetCaptureUniforms(bool capture);
+
+            [[nodiscard]] std::uint64_t GetCallCount(Function function) const;
+            [[nodiscard]] std::uint64_t GetTotalCallCount() const;
+            [[nodiscard]] const std::vector<UniformUpload>& GetUniformUploads() const;
+
+            // Clears call counts and captured uniforms.
+            void Reset();
+
+            [[nodiscard]] static const char* GetFunctionName(Function function);
+
+        private:
+            static RecordingGL& Current();
+            void Record(Function function);
+            void RecordUniform(GLint location, Function function, const float* data, std::size_t count);
+
+            static GLDispatch CreateDispatch();
+            static RecordingGL* _current;
+
+            bool _forwarding;
+            GLDispatch _forwardDispatch;
+            GLDispatch _previousDispatch;
+            bool _installed;
+
+            std::array<std::uint64_t, static_cast<std::size_t>(Function::Count)> _callCounts;
+            bool _captureUniforms;
+            std::vector<UniformUpload> _uniformUploads;
+
+            // Mock state.
+            std::chrono::microseconds _compileLatency;
+            std::chrono::microseconds _linkLatency;
+            bool _compileFailure;
+            bool _linkFailure;
+            GLuint _nextObjectID;
+            GLuint _boundProgram;
+            GLDEBUGPROC _debugCallback;
+            const void* _debugCallbackUserParam;
+            std::unordered_map<GLuint, GLint> _compileStatus;
+            std::unordered_map<GLuint, GLint> _linkStatus;
+            std::unordered_map<GLuint, std::unordered_map<std::string, GLint>> _uniformLocations;
+    };
+
+}
+
+#endif //GLSL_INCLUDE_RECORDING_GL_H
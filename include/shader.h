@@ -3,8 +3,18 @@
 #define GLSL_INCLUDE_SHADER_H
 
 #include <glad/glad.h>
+#include <build_report.h>
+#include <counters.h>
+#include <embedded.h>
+#include <gl_dispatch.h>
+#include <param_block.h>
+#include <per_draw_uniforms.h>
+#include <program_binary_cache.h>
+#include <util.h>
 #include <string>
 #include <initializer_list>
+#include <memory>
+#include <typeindex>
 #include <unordered_map>
 #include <vector>
 #include <set>
@@ -15,35 +25,153 @@
 
 namespace GLSL {
 
+    // Shader components pre-processed ahead of compilation, e.g. on worker threads (see ShaderLibraryLoader).
+    struct PreprocessedShader {
+        std::string _shaderName;
+        std::vector<std::string> _shaderComponentPaths;
+        // Mapping of shader filepath to a pairing between the shader type and processed shader source. Stages of a
+        // multi-stage file are keyed by the filepath followed by the stage name (color.glsl.vertex).
+        std::unordered_map<std::string, std::pair<GLenum, std::string>> _shaderComponents;
+        std::vector<std::string> _dependencies;
+        std::vector<FileStamp> _dependencyStamps; // Stamps of the dependencies, each taken before the file was read.
+        ShaderBuildReport _buildReport;
+        PerDrawLayout _perDrawLayout;
+    };
+
+    // Active vertex input of a linked program.
+    struct VertexAttribute {
+        std::string _name;
+        GLenum _type = GL_FLOAT; // e.g. GL_FLOAT_VEC3.
+        GLint _size = 1;         // Array length.
+        GLint _location = -1;
+    };
+
+    // Stage of a multi-stage shader file, see Shader::SplitStages.
+    struct ShaderStage {
+        std::string _name;      // Name given to #pragma stage (vertex, fragment, geometry or compute).
+        GLenum _shaderType = GL_INVALID_VALUE;
+        std::string _source;    // Shared prefix followed by the section of the stage.
+    };
+
     class Shader {
         public:
             Shader(std::string shaderName, const std::initializer_list<std::string>& shaderComponentPaths);
+            Shader(std::string shaderName, const std::vector<std::string>& shaderComponentPaths);
+            // Builds shader from components that were preprocessed at build time. Performs no file I/O or parsing.
+            Shader(std::string shaderName, const std::initializer_list<EmbeddedShaderComponent>& embeddedComponents);
+            // Compiles and links components pre-processed by PreprocessShader. Recompile pre-processes them again.
+            explicit Shader(PreprocessedShader preprocessedShader);
             ~Shader();
 
             void Bind() const;
             void Unbind() const;
 
-            void Recompile();
+            // Pre-processes, compiles and links the shader again, unless none of its dependencies changed on disk or
+            // in the source overlay since the last successful build (see NeedsRecompile). Force rebuilds regardless,
+            // e.g. after changing the include directories or draw batching.
+            void Recompile(bool force = false);
+
+            // Returns true if a dependency of the last successful build was modified, resized, removed or (re)overlaid
+            // since. Only stats the files. Files that would now shadow an include (e.g. a new file in an include
+            // directory searched earlier) are not detected. Shaders built from embedded components never need it.
+            [[nodiscard]] bool NeedsRecompile() const;
+
+            // Draws the shader once into an offscreen 1x1 framebuffer (see PrewarmTarget), so that drivers which defer
+            // compilation to the first draw do it now rather than in the first frame using the shader. Call while
+            // loading, with the render state the shader is drawn with. Compute-only programs are skipped.
+            void Prewarm() const;
+            // Pre-warms every shader into one shared target. Null shaders are skipped.
+            static void Prewarm(const std::vector<const Shader*>& shaders);
 
             // Add directory that will be checked when parsing #include statements in GLSL shader code.
             static void AddIncludeDirectory(std::string includeDirectory);
 
+            // Loads linked programs from, and stores them to, a program binary cache in the given directory (e.g. filled
+            // ahead of time by glsl-precompile-farm). Sources are still pre-processed to look up the cache entry.
+            // An empty directory disables the cache. With a remoteAddress ("<host>:<port>"), a shared cache server (see
+            // SharedCacheClient) backs the directory, so build machines reuse each other's binaries.
+            static void SetProgramBinaryCache(const std::string& directory, const std::string& remoteAddress = "");
+
+            // Rewrites uniforms marked with #pragma per_draw into a per-draw storage buffer (see PerDrawUniforms), so
+            // that DrawBatcher can submit many draws of the shader at once. Applies to shaders built afterwards.
+            // Disabled by default, marked uniforms then stay regular uniforms.
+            static void SetDrawBatching(bool enabled);
+
+            // Pre-processed shader components are written to this directory for inspection. Defaults to the directory
+            // the library was configured with, an empty directory disables the output. Applies to shaders built afterwards.
+            static void SetOutputDirectory(const std::string& directory);
+
+            // Runs the include pre-processor over a shader file without requiring an OpenGL context.
+            // Returns processed shader source. Throws std::runtime_error on error.
+            static std::string Preprocess(const std::string& filepath);
+            // Also returns every file opened while processing (the shader file and its include closure), for build-system dependency tracking.
+            static std::string Preprocess(const std::string& filepath, std::vector<std::string>& dependencies);
+            // Also returns include counters gathered while processing. Large files are lexed on up to lexerThreadCount
+            // threads (see Lexer::Lex), pass 1 when shaders are already pre-processed in parallel.
+            static std::string Preprocess(const std::string& filepath, std::vector<std::string>& dependencies, PreprocessStatistics& statistics, std::size_t lexerThreadCount = 0);
+
+            // Pre-processes every shader component of a shader without requiring an OpenGL context. Sources, if given,
+            // hold the already read contents of the shader component files (in order), only includes are read from disk;
+            // stamps then hold the stamps of those files, taken before they were read (see GetFileStamp). Large files are
+            // lexed on up to lexerThreadCount threads (see Lexer::Lex). Throws std::runtime_error on error.
+            static PreprocessedShader PreprocessShader(const std::string& shaderName, const std::vector<std::string>& shaderComponentPaths, const std::vector<std::string>& shaderComponentSources = { },
+                                                       const std::vector<FileStamp>& shaderComponentStamps = { }, std::size_t lexerThreadCount = 0);
+
+            // Splits the pre-processed source of a multi-stage file (sections started by #pragma stage vertex|fragment|
+            // geometry|compute) into one source per stage, in order of appearance. Returns no stages if the source has
+            // no stage markers. Throws std::runtime_error on unknown or repeated stages.
+            static std::vector<ShaderStage> SplitStages(const std::string& source);
+
+            // Returns the type of shader component based on the extension of the given file.
+            // Throws std::runtime_error on unknown or missing extension.
+            static GLenum GetShaderType(const std::string& filepath);
+
             [[nodiscard]] const std::string& GetName() const;
 
+            // Returns the build cost of the last successful compilation. Also recorded in BuildReport.
+            [[nodiscard]] const ShaderBuildReport& GetBuildReport() const;
+
+            // Returns every file the shader components were pre-processed from (components and their include closures).
+            [[nodiscard]] const std::vector<std::string>& GetDependencies() const;
+
+            // Returns the layout of the per-draw uniforms, empty if the shader was built without draw batching.
+            [[nodiscard]] const PerDrawLayout& GetPerDrawLayout() const;
+
+            // Returns the active vertex attributes of the program, reflected when it was linked (or loaded). Built-in
+            // inputs (gl_VertexID, ...) are not included.
+            [[nodiscard]] const std::vector<VertexAttribute>& GetVertexAttributes() const;
+
             template <typename DataType>
             void SetUniform(const std::string& uniformName, DataType value);
 
+            // Uploads every member of params described by ParamBlock<Params>, without looking up uniform names: the
+            // locations are resolved once per linked program. With changedOnly, members equal to the values of the
+            // previous SetParams call are skipped; the members must then not be set through SetUniform in between.
+            // Members that are per-draw uniforms (see SetDrawBatching) are not uploaded, set them on a DrawBatcher.
+            template <typename Params>
+            void SetParams(const Params& params, bool changedOnly = false);
+
         private:
             class Parser {
                 public:
-                    Parser();
+                    // Shader name is only used to annotate trace spans. Files are lexed on up to lexerThreadCount threads (see Lexer::Lex).
+                    explicit Parser(std::string shaderName = "", std::size_t lexerThreadCount = 0);
                     ~Parser();
 
-                    std::string ProcessFile(const std::string& filepath);
+                    // File contents, if given, are used instead of reading filepath from disk. File stamp, if given, is the
+                    // stamp of filepath taken before its contents were read.
+                    std::string ProcessFile(const std::string& filepath, const std::string* fileContents = nullptr, const FileStamp* fileStamp = nullptr);
 
                     // Returns true if all include guards are properly closed.
                     void ValidateIncludeGuardScope() const;
 
+                    // Returns every file opened by this parser, in the order they were first opened.
+                    [[nodiscard]] const std::vector<std::string>& GetDependencies() const;
+                    // Returns the stamps of the dependencies, in the same order.
+                    [[nodiscard]] const std::vector<FileStamp>& GetDependencyStamps() const;
+
+                    [[nodiscard]] const PreprocessStatistics& GetStatistics() const;
+
                 private:
                     // Shader parsing.
                     struct IncludeGuard {
@@ -55,7 +183,8 @@ namespace GLSL {
                         int _endifLineNumber = -1;
                     };
 
-                    std::string GetLine(std::ifstream& stream) const;
+                    // Parsing #pragma stage pre-processor directive.
+                    void StageDirective(const std::string &currentFile, const std::string& line, int lineNumber, const std::string& stageName);
 
                     // Parsing #pragma pre-processor directive.
                     void PragmaDirective(const std::string &currentFile, const std::string& line, int lineNumber, const std::string& pragmaArgument);
@@ -88,6 +217,24 @@ namespace GLSL {
                     std::set<std::string> _pragmaInstances;
                     std::stack<std::pair<std::string, int>> _pragmaStack; // Contains pragma filename and line number it appears on.
 
+                    // Stages. Files included before the first #pragma stage are shared by all stages, every stage
+                    // starts over from the include state at that marker.
+                    std::set<std::string> _stageNames;
+                    std::vector<IncludeGuard> _sharedIncludeGuards;
+                    std::set<std::string> _sharedIncludeGuardInstances;
+                    std::set<std::string> _sharedPragmaInstances;
+
+                    std::string _shaderName;
+                    std::size_t _lexerThreadCount;
+
+                    // Files opened while processing, without duplicates, and their stamps, each taken before the file
+                    // was read. A later edit then shows up as a change, even if it lands while the file is being read.
+                    std::vector<std::string> _dependencies;
+                    std::vector<FileStamp> _dependencyStamps;
+
+                    PreprocessStatistics _statistics;
+                    int _includeDepth; // Number of files currently being processed.
+
                     bool _hasVersionInformation;
                     bool _processingExistingInclude;
             };
@@ -95,9 +242,24 @@ namespace GLSL {
             template <typename DataType>
             void SetUniformData(GLuint uniformLocation, DataType value);
 
+            // Returns the upload plan of Params for the current program, building it on first use.
+            template <typename Params>
+            ParamUploadPlan<Params>& GetParamUploadPlan();
+
+            template <typename Params, std::size_t... Indices>
+            void UploadParams(const ParamUploadPlan<Params>& plan, const Params& params, bool changedOnly, std::index_sequence<Indices...>);
+
+            template <typename Params, typename Member>
+            void UploadParam(GLint location, const ParamMember<Params, Member>& member, const Params& params, const Params* lastValues);
+
+            // Preprocesses, compiles and links the shader. Failures are counted and rethrown.
+            void Build();
+
             // Handles shader include guards and pragmas.
-            std::string ProcessFile(const std::string& filepath);
-            void WriteToOutputDirectory(const std::string& outputDirectory, const std::string& filepath, const std::string& shaderFile) const;
+            static std::string ProcessFile(const std::string& shaderName, const std::string& filepath, std::vector<std::string>& dependencies, std::vector<FileStamp>& dependencyStamps,
+                                           PreprocessStatistics& statistics, const std::string* fileContents = nullptr, const FileStamp* fileStamp = nullptr,
+                                           std::size_t lexerThreadCount = 0);
+            static void WriteToOutputDirectory(const std::string& shaderName, const std::string& outputDirectory, const std::string& filepath, const std::string& shaderFile);
 
             // Processes input files to shader. Returns mapping of shader filepath to a pairing between the shader type and processed shader source.
             std::unordered_map<std::string, std::pair<GLenum, std::string>> GetShaderSources();
@@ -105,20 +267,43 @@ namespace GLSL {
             // Compiles and links shader components into shader program. Throws std::runtime_error on error.
             void CompileShader(const std::unordered_map<std::string, std::pair<GLenum, std::string>>& shaderComponents);
 
+            // Returns the program loaded from the program binary cache, or 0 if there is no valid entry.
+            GLuint LoadProgramBinary(const std::string& cacheKey);
+            // Best effort, failures are counted (Counters::Counter::ProgramBinaryStoreFailures) and do not fail the build.
+            void StoreProgramBinary(const std::string& cacheKey, GLuint shaderProgram) const;
+
+            // Makes shaderProgram the program of this shader, deleting the previous one.
+            void ReplaceProgram(GLuint shaderProgram);
+
+            // Queries the active vertex attributes of the program.
+            void ReflectVertexAttributes();
+
             // Compiles shader component (vertex, fragment, etc.). Throws std::runtime_error on error.
             // Returns ID of compiled shader.
             GLuint CompileShaderComponent(const std::pair<std::string, std::pair<GLenum, std::string>>& shaderComponent);
 
             std::string ShaderTypeToString(GLenum shaderType) const;
-            GLenum ShaderTypeFromString(const std::string& shaderExtension);
+            static GLenum ShaderTypeFromString(const std::string& shaderExtension);
 
             static std::vector<std::string> _includeDirectories;
+            static ProgramBinaryCache _programBinaryCache;
+            static bool _drawBatching;
+            static std::string _outputDirectory;
 
             std::unordered_map<std::string, GLint> _uniformLocations;
+            std::unordered_map<std::type_index, std::unique_ptr<ParamUploadPlanBase>> _paramUploadPlans;
             GLuint _shaderID;
 
             std::string _shaderName;
             std::vector<std::string> _shaderComponentPaths;
+            std::vector<EmbeddedShaderComponent> _embeddedComponents;
+
+            ShaderBuildReport _buildReport;
+            std::vector<std::string> _dependencies;
+            std::vector<FileStamp> _dependencyStamps; // Empty if the last build failed.
+            PerDrawLayout _perDrawLayout;
+            std::vector<VertexAttribute> _vertexAttributes;
+            GLenum _primitiveMode; // Primitive of a pre-warm draw, GL_PATCHES with tessellation, 0 for compute-only programs.
     };
 
 }
@@ -4,6 +4,9 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
 
 namespace GLSL {
 
@@ -14,9 +17,14 @@ namespace GLSL {
         // Location not found.
         if (uniformLocation == _uniformLocations.end()) {
             // Find location first.
-            GLint location = glGetUniformLocation(_shaderID, uniformName.c_str());
+            GLint location = GL().GetUniformLocation(_shaderID, uniformName.c_str());
             _uniformLocations.emplace(uniformName, location);
 
+            Counters::Increment(Counters::Counter::UniformLookups);
+            if (location == -1) {
+                Counters::Increment(Counters::Counter::UniformMisses);
+            }
+
             SetUniformData(location, value);
         }
         else {
@@ -24,35 +32,97 @@ namespace GLSL {
         }
     }
 
+    template <typename Params>
+    void Shader::SetParams(const Params& params, bool changedOnly) {
+        ParamUploadPlan<Params>& plan = GetParamUploadPlan<Params>();
+
+        UploadParams(plan, params, changedOnly && plan._hasLastValues, std::make_index_sequence<ParamMemberCount<Params>>());
+        plan._lastValues = params;
+        plan._hasLastValues = true;
+    }
+
+    template <typename Params>
+    ParamUploadPlan<Params>& Shader::GetParamUploadPlan() {
+        std::unique_ptr<ParamUploadPlanBase>& plan = _paramUploadPlans[std::type_index(typeid(Params))];
+
+        if (!plan) {
+            auto uploadPlan = std::make_unique<ParamUploadPlan<Params>>();
+            std::size_t memberIndex = 0;
+
+            std::apply([&](const auto&... members) {
+                ((uploadPlan->_locations[memberIndex++] = GL().GetUniformLocation(_shaderID, members._name)), ...);
+            }, ParamBlock<Params>::Members);
+
+            for (GLint location : uploadPlan->_locations) {
+                Counters::Increment(Counters::Counter::UniformLookups);
+                if (location == -1) {
+                    Counters::Increment(Counters::Counter::UniformMisses);
+                }
+            }
+
+            plan = std::move(uploadPlan);
+        }
+
+        return static_cast<ParamUploadPlan<Params>&>(*plan);
+    }
+
+    template <typename Params, std::size_t... Indices>
+    void Shader::UploadParams(const ParamUploadPlan<Params>& plan, const Params& params, bool changedOnly, std::index_sequence<Indices...>) {
+        const Params* lastValues = changedOnly ? &plan._lastValues : nullptr;
+        (UploadParam(plan._locations[Indices], std::get<Indices>(ParamBlock<Params>::Members), params, lastValues), ...);
+    }
+
+    template <typename Params, typename Member>
+    void Shader::UploadParam(GLint location, const ParamMember<Params, Member>& member, const Params& params, const Params* lastValues) {
+        // Not active in the program.
+        if (location == -1) {
+            return;
+        }
+
+        const Member& value = params.*(member._pointer);
+        if (lastValues && lastValues->*(member._pointer) == value) {
+            return;
+        }
+
+        SetUniformData(location, value);
+    }
+
     template<typename DataType>
     void Shader::SetUniformData(GLuint uniformLocation, DataType value) {
         // BOOL, INT
         if constexpr (std::is_same_v<DataType, int> || std::is_same_v<DataType, bool>) {
-            glUniform1i(uniformLocation, value);
+            Counters::Increment(std::is_same_v<DataType, bool> ? Counters::Counter::UniformBool : Counters::Counter::UniformInt);
+            GL().Uniform1i(uniformLocation, value);
         }
         // FLOAT
         else if constexpr (std::is_same_v<DataType, float>) {
-            glUniform1f(uniformLocation, value);
+            Counters::Increment(Counters::Counter::UniformFloat);
+            GL().Uniform1f(uniformLocation, value);
         }
         // VEC2
         else if constexpr (std::is_same_v<DataType, glm::vec2>) {
-            glUniform2fv(uniformLocation, 1, glm::value_ptr(value));
+            Counters::Increment(Counters::Counter::UniformVec2);
+            GL().Uniform2fv(uniformLocation, 1, glm::value_ptr(value));
         }
         // VEC3
         else if constexpr (std::is_same_v<DataType, glm::vec3>) {
-            glUniform3fv(uniformLocation, 1, glm::value_ptr(value));
+            Counters::Increment(Counters::Counter::UniformVec3);
+            GL().Uniform3fv(uniformLocation, 1, glm::value_ptr(value));
         }
         // VEC4
         else if constexpr (std::is_same_v<DataType, glm::vec4>) {
-            glUniform4fv(uniformLocation, 1, glm::value_ptr(value));
+            Counters::Increment(Counters::Counter::UniformVec4);
+            GL().Uniform4fv(uniformLocation, 1, glm::value_ptr(value));
         }
         // MAT3
         else if constexpr (std::is_same_v<DataType, glm::mat3>) {
-            glUniformMatrix3fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(value));
+            Counters::Increment(Counters::Counter::UniformMat3);
+            GL().UniformMatrix3fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(value));
         }
         // MAT4
         else if constexpr (std::is_same_v<DataType, glm::mat4>) {
-            glUniformMatrix4fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(value));
+            Counters::Increment(Counters::Counter::UniformMat4);
+            GL().UniformMatrix4fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(value));
         }
     }
 
@@ -0,0 +1,48 @@
+
+#ifndef GLSL_INCLUDE_SHADER_LIBRARY_LOADER_H
+#define GLSL_INCLUDE_SHADER_LIBRARY_LOADER_H
+
+#include <program_binary_cache.h>
+#include <shader.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace GLSL {
+
+    struct ShaderLibraryEntry {
+        std::string _name;
+        std::vector<std::string> _shaderComponentPaths;
+    };
+
+    // Builds many shaders at once as a pipeline of three stages connected by bounded queues: read threads load the
+    // shader component files, pre-processing threads resolve their includes, and the calling thread compiles and links
+    // them. File I/O, pre-processing and driver work overlap across shaders, instead of running one after the other in
+    // every Shader constructor. Full queues block the stage feeding them, so memory stays bounded for large libraries.
+    class ShaderLibraryLoader {
+        public:
+            // Thread counts of 0 are derived from the hardware concurrency. Queue capacity is in shaders. With prewarm,
+            // every shader built is also pre-warmed (see Shader::Prewarm) once the library finished loading.
+            explicit ShaderLibraryLoader(unsigned readThreadCount = 2, unsigned preprocessThreadCount = 0, std::size_t queueCapacity = 16, bool prewarm = false);
+
+            // Must be called from the thread the OpenGL context is current on. Returns a shader for every entry, in order.
+            // Shaders that failed to build are null, their error messages are appended to errors (in completion order).
+            std::vector<std::unique_ptr<Shader>> Load(const std::vector<ShaderLibraryEntry>& entries, std::vector<std::string>& errors) const;
+
+            // Entries whose program is already in cache are pre-processed, to find their key, but not compiled; their
+            // shaders are null, without an error. Used to fill a cache incrementally (see glsl-precompile-farm).
+            void SetSkippedPrograms(ProgramBinaryCache cache);
+
+        private:
+            unsigned _readThreadCount;
+            unsigned _preprocessThreadCount;
+            std::size_t _queueCapacity;
+            bool _prewarm;
+            ProgramBinaryCache _skippedPrograms; // Disabled unless set.
+    };
+
+}
+
+#endif //GLSL_INCLUDE_SHADER_LIBRARY_LOADER_H
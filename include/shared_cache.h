@@ -0,0 +1,110 @@
+
+#ifndef GLSL_INCLUDE_SHARED_CACHE_H
+#define GLSL_INCLUDE_SHARED_CACHE_H
+
+#include <sockets.h>
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace GLSL {
+
+    // Build cache shared between machines (e.g. the nodes of a build farm), used as the second tier behind a local disk
+    // cache (see ProgramBinaryCache). Entries are addressed by a hash of everything that went into producing them,
+    // prefixed by the kind of entry ("program-<hash>"), so an entry never changes: the first one stored under a key is kept.
+    //
+    // Protocol: TCP, requests are answered in order. Every message is a header line terminated by '\n', followed by
+    // exactly <length> bytes of payload. Keys consist of at most 128 letters, digits, '-' and '_'.
+    //  GET <key>           Answered with "FOUND <length>" followed by the entry, or "MISSING".
+    //  PUT <key> <length>  Stores the payload under key. Answered with "OK".
+    // Requests that cannot be served are answered with "ERROR <length>" followed by the error message; after a malformed
+    // request the connection is closed.
+    [[nodiscard]] bool IsValidSharedCacheKey(const std::string& key);
+
+    // Blocking client of a shared cache. The shared cache is only an optimization: an unreachable server, timeouts and
+    // malformed responses make Get miss and Put fail, and after a failure the server is not contacted again until
+    // retryInterval passed, so an outage costs a build at most one timeout per interval. Thread safe.
+    class SharedCacheClient {
+        public:
+            // Address is "<host>:<port>". Connects on first use.
+            explicit SharedCacheClient(const std::string& address, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000),
+                                       std::chrono::milliseconds retryInterval = std::chrono::milliseconds(10000));
+            ~SharedCacheClient();
+
+            SharedCacheClient(const SharedCacheClient&) = delete;
+            SharedCacheClient& operator=(const SharedCacheClient&) = delete;
+
+            [[nodiscard]] const std::string& GetAddress() const;
+
+            // Returns false if there is no entry for key (or the server cannot be reached).
+            bool Get(const std::string& key, std::vector<char>& data);
+            // Returns false if the entry could not be stored.
+            bool Put(const std::string& key, const std::vector<char>& data);
+
+        private:
+            bool Connect();
+            // Failures start the retry interval.
+            void Disconnect(bool failed);
+
+            bool SendAll(const std::string& data);
+            bool ReceiveLine(std::string& line);
+            bool ReceiveExactly(std::vector<char>& data, std::size_t size);
+            bool ReceiveMore();
+
+            std::string _address;
+            std::string _host;
+            std::string _port;
+            std::chrono::milliseconds _timeout;
+            std::chrono::milliseconds _retryInterval;
+            std::chrono::steady_clock::time_point _retryAfter;
+
+            std::intptr_t _socket;
+            std::string _received; // Received bytes not consumed yet.
+            std::mutex _mutex;
+    };
+
+    // Stand-in shared cache server that stores every entry as a file named after its key, to test the shared tier on a
+    // single machine (see tools/glsl-cache-server.cpp). Listens on 127.0.0.1 only. All socket work happens in Poll().
+    class SharedCacheServer {
+        public:
+            struct Statistics {
+                std::uint64_t _hits = 0;
+                std::uint64_t _misses = 0;
+                std::uint64_t _stores = 0;    // New entries.
+                std::uint64_t _duplicates = 0; // Stores of keys that already had an entry.
+            };
+
+            // Port 0 picks a free port (see GetPort). Throws std::runtime_error if the socket cannot be set up.
+            SharedCacheServer(std::string directory, unsigned short port);
+            ~SharedCacheServer();
+
+            SharedCacheServer(const SharedCacheServer&) = delete;
+            SharedCacheServer& operator=(const SharedCacheServer&) = delete;
+
+            [[nodiscard]] unsigned short GetPort() const;
+
+            // Waits up to timeout for activity, then accepts connections and answers every complete request.
+            void Poll(std::chrono::milliseconds timeout);
+
+            [[nodiscard]] const Statistics& GetStatistics() const;
+
+        private:
+            void AcceptConnections();
+            void ProcessRequests(Sockets::Connection& connection);
+
+            [[nodiscard]] std::string GetEntryPath(const std::string& key) const;
+
+            std::string _directory;
+            std::intptr_t _listenSocket;
+            unsigned short _port;
+
+            std::vector<Sockets::Connection> _connections;
+            Statistics _statistics;
+    };
+
+}
+
+#endif //GLSL_INCLUDE_SHARED_CACHE_H
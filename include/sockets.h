@@ -0,0 +1,70 @@
+
+#ifndef GLSL_INCLUDE_SOCKETS_H
+#define GLSL_INCLUDE_SOCKETS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace GLSL {
+
+    // TCP plumbing shared by the socket servers (LiveEditServer, SharedCacheServer) and SharedCacheClient, which
+    // implement their protocols on top. Sockets are passed as std::intptr_t, so headers do not depend on the platform's
+    // socket headers.
+    class Sockets {
+        public:
+            // Connection of a server. Input and output are buffered, so servers never block on a slow peer.
+            struct Connection {
+                std::intptr_t _socket;
+                std::string _incoming;
+                std::string _outgoing;
+                bool _isClosed = false;
+            };
+
+            static constexpr std::intptr_t InvalidSocket = -1;
+
+            // Headers are short, a longer line means the peer does not speak the protocol.
+            static constexpr std::size_t MaximumHeaderLength = 4096;
+
+            // Initializes the socket library of the platform (Winsock) once. Returns false if it is unavailable.
+            static bool Initialize();
+
+            // True if the last call failed only because it would have blocked.
+            [[nodiscard]] static bool WouldBlock();
+            static void Close(std::intptr_t socket);
+            static bool SetNonBlocking(std::intptr_t socket, bool nonBlocking);
+
+            // Returns a blocking socket connected to host:port, or InvalidSocket. Connecting, and every send and receive
+            // on the socket, give up after timeout.
+            static std::intptr_t Connect(const std::string& host, const std::string& port, std::chrono::milliseconds timeout);
+            // Sends all of data on a blocking socket. Returns false if the connection broke or timed out.
+            static bool SendAll(std::intptr_t socket, const std::string& data);
+            // Receives up to size bytes on a blocking socket. Returns the number received, 0 or less if the connection
+            // was shut down, broke or timed out.
+            static long long ReceiveSome(std::intptr_t socket, char* buffer, std::size_t size);
+
+            // Returns a non-blocking socket listening on 127.0.0.1. Port 0 picks a free port, port is set to the port
+            // listened on. Throws std::runtime_error, with messages prefixed by name, if the socket cannot be set up.
+            static std::intptr_t Listen(const std::string& name, unsigned short& port);
+            // Returns the next pending connection as a non-blocking socket, or InvalidSocket if there is none.
+            static std::intptr_t Accept(std::intptr_t listenSocket);
+            // Waits up to timeout for a pending connection, input on one of connections or room for their output.
+            static void Wait(std::intptr_t listenSocket, const std::vector<Connection>& connections, std::chrono::milliseconds timeout);
+
+            // Appends all available input to _incoming. Connections shut down by the peer or broken are marked closed.
+            static void Receive(Connection& connection);
+            // Sends as much of _outgoing as possible without blocking, the rest is sent by the next call.
+            static void Send(Connection& connection);
+
+            // Answers with "ERROR <length>" followed by message, the response the protocols share for failed requests.
+            static std::string FormatError(const std::string& message);
+            // Answers a malformed message with the error and closes the connection: payload boundaries are unknown, so
+            // the stream cannot be recovered.
+            static void Reject(Connection& connection, const std::string& message);
+    };
+
+}
+
+#endif //GLSL_INCLUDE_SOCKETS_H
@@ -0,0 +1,45 @@
+
+#ifndef GLSL_INCLUDE_SOURCE_OVERLAY_H
+#define GLSL_INCLUDE_SOURCE_OVERLAY_H
+
+#include <lexer.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace GLSL {
+
+    // Process-wide in-memory file contents that take precedence over the files on disk when pre-processing, e.g. the
+    // unsaved buffers of a shader editor (see LiveEditServer). Every overlaid file keeps its lines already lexed
+    // (comments stripped), and edits only re-lex the lines they touch (plus those whose block comment state they
+    // change), so pre-processing an overlaid file performs neither file I/O nor lexing. Files are identified by their absolute, normalized path. Thread safe.
+    class SourceOverlay {
+        public:
+            // Overlays filepath with contents, replacing any previous overlay of it.
+            static void Open(const std::string& filepath, const std::string& contents);
+
+            // Replaces the text from (startLine, startColumn) up to (endLine, endColumn) of an overlaid file with text.
+            // Lines and columns are zero-based, columns count bytes. Throws std::runtime_error if the file is not
+            // overlaid or the range is out of bounds.
+            static void Edit(const std::string& filepath, int startLine, int startColumn, int endLine, int endColumn, const std::string& text);
+
+            // Removes the overlay, pre-processing reads the file from disk again.
+            static void Close(const std::string& filepath);
+            static void CloseAll();
+
+            [[nodiscard]] static bool Contains(const std::string& filepath);
+
+            // Copies the lexed lines of an overlaid file. Returns false if the file is not overlaid.
+            static bool GetLexedSource(const std::string& filepath, LexedSource& lexedSource);
+
+            // Returns a value that changes whenever the overlay of filepath is opened, edited or closed, 0 if it was never overlaid.
+            [[nodiscard]] static std::uint64_t GetGeneration(const std::string& filepath);
+
+            // Returns the absolute, normalized path overlays are identified by.
+            [[nodiscard]] static std::string GetKey(const std::string& filepath);
+    };
+
+}
+
+#endif //GLSL_INCLUDE_SOURCE_OVERLAY_H
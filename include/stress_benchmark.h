@@ -0,0 +1,27 @@
+
+#ifndef GLSL_INCLUDE_STRESS_BENCHMARK_H
+#define GLSL_INCLUDE_STRESS_BENCHMARK_H
+
+#include <chrono>
+
+namespace GLSL {
+
+    struct StressBenchmarkSettings {
+        int _shaderCount = 16;
+        int _drawsPerFrame = 1000;
+        int _uniformsPerDraw = 3;
+        int _frameCount = 500;
+        int _width = 1920;
+        int _height = 1080;
+        bool _gpuProfiling = false; // Measure GPU time per shader (see GPUProfiler).
+        bool _batchDraws = false;   // Submit the draws of each shader through a DrawBatcher.
+    };
+
+    // Renders a fixed number of frames into an offscreen framebuffer and prints time-to-first-frame, frame-time
+    // percentiles and OpenGL calls per frame by category, plus GPU time per shader if requested. Requires a current OpenGL context with glad loaded.
+    // startTime is the time the process started, used for time-to-first-frame. Returns the process exit code.
+    int RunStressBenchmark(const StressBenchmarkSettings& settings, std::chrono::steady_clock::time_point startTime);
+
+}
+
+#endif //GLSL_INCLUDE_STRESS_BENCHMARK_H
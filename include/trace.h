@@ -0,0 +1,58 @@
+
+#ifndef GLSL_INCLUDE_TRACE_H
+#define GLSL_INCLUDE_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace GLSL {
+
+    // Records timed spans of shader building and exports them in the Chrome trace event format, which can be opened in
+    // chrome://tracing or ui.perfetto.dev. Spans are only compiled in when GLSL_INCLUDE_TRACING is defined (CMake option
+    // GLSL_INCLUDE_ENABLE_TRACING) and only recorded while tracing is enabled at runtime.
+    class Trace {
+        public:
+            // Scoped span, recorded when it goes out of scope.
+            class Span {
+                public:
+                    Span(const char* name, const char* category, const std::string& shaderName = "", const std::string& filepath = "");
+                    ~Span();
+
+                    Span(const Span&) = delete;
+                    Span& operator=(const Span&) = delete;
+
+                private:
+                    bool _active;
+                    const char* _name;
+                    const char* _category;
+                    std::string _shaderName;
+                    std::string _filepath;
+                    std::chrono::steady_clock::time_point _start;
+            };
+
+            static void Enable();
+            static void Disable();
+            [[nodiscard]] static bool IsEnabled();
+
+            // Writes all recorded spans as Chrome trace JSON. Throws std::runtime_error if the file cannot be written.
+            static void WriteChromeTrace(const std::string& filepath);
+
+            // Discards all recorded spans.
+            static void Clear();
+
+        private:
+            static std::atomic<bool> _enabled;
+    };
+
+}
+
+#ifdef GLSL_INCLUDE_TRACING
+    #define GLSL_TRACE_CONCATENATE_IMPL(a, b) a##b
+    #define GLSL_TRACE_CONCATENATE(a, b) GLSL_TRACE_CONCATENATE_IMPL(a, b)
+    #define GLSL_TRACE_SPAN(...) GLSL::Trace::Span GLSL_TRACE_CONCATENATE(traceSpan, __LINE__)(__VA_ARGS__)
+#else
+    #define GLSL_TRACE_SPAN(...)
+#endif
+
+#endif //GLSL_INCLUDE_TRACE_H
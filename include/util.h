@@ -2,7 +2,10 @@
 #ifndef GLSL_INCLUDE_UTIL_H
 #define GLSL_INCLUDE_UTIL_H
 
+#include <cstdint>
+#include <filesystem>
 #include <string>
+#include <vector>
 
 namespace GLSL {
 
@@ -15,6 +18,29 @@ namespace GLSL {
     void EraseNewlines(std::string& line, bool eraseLast);
     void EraseComments(std::string& line);
 
+    // Escapes a string for use inside a JSON string literal.
+    std::string EscapeJSON(const std::string& string);
+
+    // Writes a Makefile-style dependency file (as understood by Make and Ninja) listing the dependencies of target.
+    // Paths are written as absolute paths. Throws std::runtime_error if the file cannot be written.
+    void WriteDepfile(const std::string& depfilePath, const std::string& target, const std::vector<std::string>& dependencies);
+
+    // State of a file as far as it can be observed without reading it: modification time and size on disk, and the
+    // generation of its overlay (see SourceOverlay).
+    struct FileStamp {
+        std::string _filepath;
+        std::filesystem::file_time_type _modifiedTime = std::filesystem::file_time_type::min(); // min() if the file does not exist.
+        std::uintmax_t _size = 0;
+        std::uint64_t _overlayGeneration = 0;
+    };
+
+    // Stats a file, without reading it. Take the stamp before reading the file, so that an edit during the read is
+    // seen as a change later on.
+    FileStamp GetFileStamp(const std::string& filepath);
+
+    // Returns true if any of the files changed (or appeared or disappeared) since its stamp was taken.
+    bool HaveFilesChanged(const std::vector<FileStamp>& fileStamps);
+
 }
 
 #endif //GLSL_INCLUDE_UTIL_H
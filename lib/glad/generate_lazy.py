@@ -0,0 +1,86 @@
+"""Generates src/glad_lazy.c from include/glad/glad.h.
+
+For every GL entry point declared by glad, emits a trampoline that resolves the real function through the loader on first
+call, stores it in the glad function pointer and forwards the call. If the function cannot be resolved, the trampoline
+reports it, leaves the glad function pointer NULL (as the eager loader would) and returns 0 without calling anything.
+Rerun after regenerating glad.
+
+Usage: python generate_lazy.py
+"""
+
+import os
+import re
+
+GLAD_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+HEADER_PATH = os.path.join(GLAD_DIRECTORY, "include", "glad", "glad.h")
+OUTPUT_PATH = os.path.join(GLAD_DIRECTORY, "src", "glad_lazy.c")
+
+TYPEDEF_PATTERN = re.compile(r"^typedef (.+?) \(APIENTRYP (PFN\w+PROC)\)\((.*)\);$")
+DECLARATION_PATTERN = re.compile(r"^GLAPI (PFN\w+PROC) glad_(\w+);$")
+
+
+def parameter_name(parameter):
+    return re.split(r"[\s*]+", parameter.strip())[-1]
+
+
+def main():
+    with open(HEADER_PATH) as header:
+        lines = header.read().splitlines()
+
+    typedefs = {}
+    functions = []
+
+    for line in lines:
+        match = TYPEDEF_PATTERN.match(line)
+        if match:
+            typedefs[match.group(2)] = (match.group(1), match.group(3))
+            continue
+
+        match = DECLARATION_PATTERN.match(line)
+        if match:
+            functions.append((match.group(2), match.group(1)))
+
+    output = [
+        "// Lazy entry point resolution for glad (see gladLoadGLLoaderLazy).",
+        "// Generated by lib/glad/generate_lazy.py from include/glad/glad.h. Do not edit.",
+        "",
+        "#include <stdio.h>",
+        "#include \"glad/glad.h\"",
+        "",
+        "static GLADloadproc glad_lazy_load = NULL;",
+        "",
+        "static void* glad_lazy_resolve(const char *name) {",
+        "    void* proc = glad_lazy_load(name);",
+        "    if (proc == NULL) {",
+        "        fprintf(stderr, \"glad: failed to resolve %s, the call is ignored\\n\", name);",
+        "    }",
+        "    return proc;",
+        "}",
+        "",
+    ]
+
+    for name, pointer_type in functions:
+        return_type, parameters = typedefs[pointer_type]
+        arguments = "" if parameters.strip() == "void" else ", ".join(parameter_name(parameter) for parameter in parameters.split(","))
+        call = "glad_{0}({1});".format(name, arguments)
+
+        output.append("static {0} APIENTRY glad_lazy_{1}({2}) {{".format(return_type, name, parameters))
+        output.append("    glad_{0} = ({1})glad_lazy_resolve(\"{0}\");".format(name, pointer_type))
+        output.append("    if (glad_{0} == NULL) return{1};".format(name, "" if return_type == "void" else " ({0})0".format(return_type)))
+        output.append("    {0}{1}".format("" if return_type == "void" else "return ", call))
+        output.append("}")
+
+    output.append("")
+    output.append("void glad_install_lazy_loader(GLADloadproc load) {")
+    output.append("    glad_lazy_load = load;")
+    for name, _ in functions:
+        output.append("    glad_{0} = glad_lazy_{0};".format(name))
+    output.append("}")
+    output.append("")
+
+    with open(OUTPUT_PATH, "w") as source:
+        source.write("\n".join(output))
+
+
+if __name__ == "__main__":
+    main()
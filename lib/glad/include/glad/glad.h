@@ -62,6 +62,12 @@ typedef void* (* GLADloadproc)(const char *name);
 
 GLAPI struct gladGLversionStruct GLVersion;
 GLAPI int gladLoadGLLoader(GLADloadproc);
+/* Resolves entry points on first call instead of up front. The loader must stay valid while GL functions are in use.
+ * Version and extension flags (GLVersion, GLAD_GL_*) are set as by gladLoadGLLoader. Unlike with gladLoadGLLoader, every
+ * function pointer is non-NULL until its first call, so "if (glFoo)" does not tell whether glFoo is available; check
+ * the version and extension flags instead. A function the loader cannot resolve reports the failure on stderr on its
+ * first call, does nothing and returns 0 (output parameters are left untouched); its pointer is NULL afterwards. */
+GLAPI int gladLoadGLLoaderLazy(GLADloadproc);
 
 #include <khr/khrplatform.h>
 typedef unsigned int GLenum;
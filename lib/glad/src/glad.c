@@ -2365,3 +2365,18 @@ int gladLoadGLLoader(GLADloadproc load) {
 	return GLVersion.major != 0 || GLVersion.minor != 0;
 }
 
+void glad_install_lazy_loader(GLADloadproc load);
+
+int gladLoadGLLoaderLazy(GLADloadproc load) {
+	GLVersion.major = 0; GLVersion.minor = 0;
+	glad_install_lazy_loader(load);
+	glGetString = (PFNGLGETSTRINGPROC)load("glGetString");
+	if(glGetString == NULL) return 0;
+	if(glGetString(GL_VERSION) == NULL) return 0;
+	find_coreGL();
+
+	/* Extension flags are set up front, the functions queried here resolve through their trampolines. */
+	if (!find_extensionsGL()) return 0;
+	return GLVersion.major != 0 || GLVersion.minor != 0;
+}
+
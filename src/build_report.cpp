@@ -0,0 +1,319 @@
+
+#include <build_report.h>
+#include <util.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace GLSL {
+
+    namespace {
+
+        std::mutex reportMutex;
+        std::vector<ShaderBuildReport> shaderReports; // Ordered by first build.
+
+        // Minimal JSON reader for the report format written by BuildReport::Write.
+        struct JSONValue {
+            enum class Type { Null, Boolean, Number, String, Array, Object };
+
+            Type _type = Type::Null;
+            double _number = 0.0;
+            std::string _string;
+            std::vector<JSONValue> _array;
+            std::vector<std::pair<std::string, JSONValue>> _object;
+
+            [[nodiscard]] const JSONValue* Find(const std::string& key) const {
+                for (const auto& member : _object) {
+                    if (member.first == key) {
+                        return &member.second;
+                    }
+                }
+
+                return nullptr;
+            }
+        };
+
+        class JSONReader {
+            public:
+                JSONReader(const std::string& filepath, std::string text) : _filepath(filepath),
+                                                                            _text(std::move(text)),
+                                                                            _position(0) {
+                }
+
+                JSONValue Read() {
+                    JSONValue value = ReadValue();
+                    SkipWhitespace();
+
+                    if (_position != _text.size()) {
+                        Fail("Unexpected trailing characters");
+                    }
+
+                    return value;
+                }
+
+            private:
+                JSONValue ReadValue() {
+                    SkipWhitespace();
+                    if (_position >= _text.size()) {
+                        Fail("Unexpected end of file");
+                    }
+
+                    JSONValue value;
+                    char character = _text[_position];
+
+                    if (character == '{') {
+                        value._type = JSONValue::Type::Object;
+                        ++_position;
+
+                        SkipWhitespace();
+                        if (Consume('}')) {
+                            return value;
+                        }
+
+                        do {
+                            SkipWhitespace();
+                            std::string key = ReadString();
+                            SkipWhitespace();
+                            Expect(':');
+                            value._object.emplace_back(std::move(key), ReadValue());
+                            SkipWhitespace();
+                        } while (Consume(','));
+
+                        Expect('}');
+                    }
+                    else if (character == '[') {
+                        value._type = JSONValue::Type::Array;
+                        ++_position;
+
+                        SkipWhitespace();
+                        if (Consume(']')) {
+                            return value;
+                        }
+
+                        do {
+                            value._array.emplace_back(ReadValue());
+                            SkipWhitespace();
+                        } while (Consume(','));
+
+                        Expect(']');
+                    }
+                    else if (character == '"') {
+                        value._type = JSONValue::Type::String;
+                        value._string = ReadString();
+                    }
+                    else if (_text.compare(_position, 4, "true") == 0 || _text.compare(_position, 5, "false") == 0) {
+                        value._type = JSONValue::Type::Boolean;
+                        value._number = character == 't' ? 1.0 : 0.0;
+                        _position += character == 't' ? 4 : 5;
+                    }
+                    else if (_text.compare(_position, 4, "null") == 0) {
+                        _position += 4;
+                    }
+                    else {
+                        const char* begin = _text.c_str() + _position;
+                        char* end = nullptr;
+                        value._type = JSONValue::Type::Number;
+                        value._number = std::strtod(begin, &end);
+
+                        if (end == begin) {
+                            Fail("Unexpected character");
+                        }
+                        _position += end - begin;
+                    }
+
+                    return value;
+                }
+
+                std::string ReadString() {
+                    Expect('"');
+                    std::string string;
+
+                    while (_position < _text.size() && _text[_position] != '"') {
+                        char character = _text[_position++];
+
+                        if (character == '\\' && _position < _text.size()) {
+                            char escaped = _text[_position++];
+                            switch (escaped) {
+                                case 'n':
+                                    string += '\n';
+                                    break;
+                                case 'r':
+                                    string += '\r';
+                                    break;
+                                case 't':
+                                    string += '\t';
+                                    break;
+                                case 'u':
+                                    // Only control characters are written as \u escapes.
+                                    if (_position + 4 > _text.size()) {
+                                        Fail("Truncated unicode escape");
+                                    }
+                                    string += static_cast<char>(std::strtol(_text.substr(_position, 4).c_str(), nullptr, 16));
+                                    _position += 4;
+                                    break;
+                                default:
+                                    string += escaped;
+                                    break;
+                            }
+                        }
+                        else {
+                            string += character;
+                        }
+                    }
+
+                    Expect('"');
+                    return string;
+                }
+
+                void SkipWhitespace() {
+                    while (_position < _text.size() && std::isspace(static_cast<unsigned char>(_text[_position]))) {
+                        ++_position;
+                    }
+                }
+
+                bool Consume(char character) {
+                    if (_position < _text.size() && _text[_position] == character) {
+                        ++_position;
+                        return true;
+                    }
+
+                    return false;
+                }
+
+                void Expect(char character) {
+                    if (!Consume(character)) {
+                        Fail(std::string("Expected '") + character + "'");
+                    }
+                }
+
+                [[noreturn]] void Fail(const std::string& message) const {
+                    throw std::runtime_error("Malformed build report '" + _filepath + "' at offset " + std::to_string(_position) + ": " + message);
+                }
+
+                const std::string& _filepath;
+                std::string _text;
+                std::size_t _position;
+        };
+
+        double GetNumber(const JSONValue& object, const std::string& key) {
+            const JSONValue* value = object.Find(key);
+            return (value && value->_type == JSONValue::Type::Number) ? value->_number : 0.0;
+        }
+
+        std::string GetString(const JSONValue& object, const std::string& key) {
+            const JSONValue* value = object.Find(key);
+            return (value && value->_type == JSONValue::Type::String) ? value->_string : std::string();
+        }
+
+    }
+
+    void BuildReport::Record(const ShaderBuildReport& report) {
+        std::lock_guard<std::mutex> lock(reportMutex);
+
+        auto reportIt = std::find_if(shaderReports.begin(), shaderReports.end(), [&](const ShaderBuildReport& shaderReport) {
+            return shaderReport._shaderName == report._shaderName;
+        });
+
+        if (reportIt != shaderReports.end()) {
+            *reportIt = report;
+        }
+        else {
+            shaderReports.emplace_back(report);
+        }
+    }
+
+    std::vector<ShaderBuildReport> BuildReport::GetReports() {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        return shaderReports;
+    }
+
+    void BuildReport::Clear() {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        shaderReports.clear();
+    }
+
+    void BuildReport::Write(const std::string& filepath) {
+        std::ofstream outputStream(filepath);
+        if (!outputStream.is_open()) {
+            throw std::runtime_error("Could not open build report file: '" + filepath + "'");
+        }
+
+        std::vector<ShaderBuildReport> reports = GetReports();
+        outputStream << std::fixed << std::setprecision(3);
+
+        outputStream << "{\"shaders\":[";
+        for (std::size_t i = 0; i < reports.size(); ++i) {
+            const ShaderBuildReport& report = reports[i];
+
+            outputStream << (i == 0 ? "\n" : ",\n");
+            outputStream << "{\"name\":\"" << EscapeJSON(report._shaderName) << "\",\"link_ms\":" << report._linkMilliseconds << ",\"components\":[";
+
+            for (std::size_t j = 0; j < report._components.size(); ++j) {
+                const ShaderBuildReport::Component& component = report._components[j];
+
+                outputStream << (j == 0 ? "\n  " : ",\n  ");
+                outputStream << "{\"file\":\"" << EscapeJSON(component._filepath) << "\""
+                             << ",\"preprocessed_bytes\":" << component._preprocessedBytes
+                             << ",\"includes_opened\":" << component._preprocessStatistics._includesOpened
+                             << ",\"includes_skipped\":" << component._preprocessStatistics._includesSkipped
+                             << ",\"deepest_include_chain\":" << component._preprocessStatistics._deepestIncludeChain
+                             << ",\"preprocess_ms\":" << component._preprocessMilliseconds
+                             << ",\"compile_ms\":" << component._compileMilliseconds << "}";
+            }
+
+            outputStream << "]}";
+        }
+        outputStream << "\n]}" << std::endl;
+    }
+
+    std::vector<ShaderBuildReport> BuildReport::Read(const std::string& filepath) {
+        std::ifstream inputStream(filepath);
+        if (!inputStream.is_open()) {
+            throw std::runtime_error("Could not open build report file: '" + filepath + "'");
+        }
+
+        std::stringstream text;
+        text << inputStream.rdbuf();
+
+        JSONValue root = JSONReader(filepath, text.str()).Read();
+        const JSONValue* shaders = root.Find("shaders");
+        if (!shaders || shaders->_type != JSONValue::Type::Array) {
+            throw std::runtime_error("Malformed build report '" + filepath + "': missing \"shaders\" array");
+        }
+
+        std::vector<ShaderBuildReport> reports;
+        for (const JSONValue& shader : shaders->_array) {
+            ShaderBuildReport report;
+            report._shaderName = GetString(shader, "name");
+            report._linkMilliseconds = GetNumber(shader, "link_ms");
+
+            const JSONValue* components = shader.Find("components");
+            if (components && components->_type == JSONValue::Type::Array) {
+                for (const JSONValue& componentValue : components->_array) {
+                    ShaderBuildReport::Component component;
+                    component._filepath = GetString(componentValue, "file");
+                    component._preprocessedBytes = static_cast<std::size_t>(GetNumber(componentValue, "preprocessed_bytes"));
+                    component._preprocessStatistics._includesOpened = static_cast<int>(GetNumber(componentValue, "includes_opened"));
+                    component._preprocessStatistics._includesSkipped = static_cast<int>(GetNumber(componentValue, "includes_skipped"));
+                    component._preprocessStatistics._deepestIncludeChain = static_cast<int>(GetNumber(componentValue, "deepest_include_chain"));
+                    component._preprocessMilliseconds = GetNumber(componentValue, "preprocess_ms");
+                    component._compileMilliseconds = GetNumber(componentValue, "compile_ms");
+
+                    report._components.emplace_back(std::move(component));
+                }
+            }
+
+            reports.emplace_back(std::move(report));
+        }
+
+        return reports;
+    }
+
+}
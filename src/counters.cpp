@@ -0,0 +1,138 @@
+
+#include <counters.h>
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace GLSL {
+
+    // Static initialization.
+    std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Counters::Counter::Count)> Counters::_counters { };
+
+    namespace {
+
+        std::mutex frameMutex;
+        Counters::Snapshot lastFrame;
+
+        // Periodic dump state.
+        std::mutex dumpMutex;
+        std::condition_variable dumpCondition;
+        std::thread dumpThread;
+        bool dumpStopRequested = false;
+
+        void WriteSnapshot(std::ofstream& outputStream, const Counters::Snapshot& snapshot, long long timestamp) {
+            outputStream << "{\"time_ms\":" << timestamp;
+            for (std::size_t i = 0; i < snapshot._values.size(); ++i) {
+                outputStream << ",\"" << Counters::GetCounterName(static_cast<Counters::Counter>(i)) << "\":" << snapshot._values[i];
+            }
+            outputStream << "}" << std::endl;
+        }
+
+    }
+
+    std::uint64_t Counters::Snapshot::operator[](Counter counter) const {
+        return _values[static_cast<std::size_t>(counter)];
+    }
+
+    Counters::Snapshot Counters::Snapshot::operator-(const Snapshot& other) const {
+        Snapshot difference;
+        for (std::size_t i = 0; i < _values.size(); ++i) {
+            difference._values[i] = _values[i] - other._values[i];
+        }
+
+        return difference;
+    }
+
+    Counters::Snapshot Counters::GetSnapshot() {
+        Snapshot snapshot;
+        for (std::size_t i = 0; i < _counters.size(); ++i) {
+            snapshot._values[i] = _counters[i].load(std::memory_order_relaxed);
+        }
+
+        return snapshot;
+    }
+
+    Counters::Snapshot Counters::EndFrame() {
+        Snapshot current = GetSnapshot();
+
+        std::lock_guard<std::mutex> lock(frameMutex);
+        Snapshot frame = current - lastFrame;
+        lastFrame = current;
+
+        return frame;
+    }
+
+    void Counters::StartPeriodicDump(const std::string& filepath, std::chrono::milliseconds interval) {
+        std::lock_guard<std::mutex> lock(dumpMutex);
+        if (dumpThread.joinable()) {
+            throw std::runtime_error("Counter dump is already running.");
+        }
+
+        std::ofstream outputStream(filepath, std::ios::app);
+        if (!outputStream.is_open()) {
+            throw std::runtime_error("Could not open counter dump file: '" + filepath + "'");
+        }
+
+        dumpStopRequested = false;
+        dumpThread = std::thread([interval, outputStream = std::move(outputStream)]() mutable {
+            auto start = std::chrono::steady_clock::now();
+            std::unique_lock<std::mutex> dumpLock(dumpMutex);
+
+            bool stop = false;
+            while (!stop) {
+                stop = dumpCondition.wait_for(dumpLock, interval, []() { return dumpStopRequested; });
+
+                // The final totals are always written when stopping.
+                long long timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+                WriteSnapshot(outputStream, GetSnapshot(), timestamp);
+            }
+        });
+    }
+
+    void Counters::StopPeriodicDump() {
+        {
+            std::lock_guard<std::mutex> lock(dumpMutex);
+            if (!dumpThread.joinable()) {
+                return;
+            }
+            dumpStopRequested = true;
+        }
+
+        dumpCondition.notify_all();
+        dumpThread.join();
+    }
+
+    const char* Counters::GetCounterName(Counter counter) {
+        switch (counter) {
+            case Counter::UseProgram:               return "use_program";
+            case Counter::UniformInt:               return "uniform_int";
+            case Counter::UniformBool:              return "uniform_bool";
+            case Counter::UniformFloat:             return "uniform_float";
+            case Counter::UniformVec2:              return "uniform_vec2";
+            case Counter::UniformVec3:              return "uniform_vec3";
+            case Counter::UniformVec4:              return "uniform_vec4";
+            case Counter::UniformMat3:              return "uniform_mat3";
+            case Counter::UniformMat4:              return "uniform_mat4";
+            case Counter::UniformLookups:           return "uniform_lookups";
+            case Counter::UniformMisses:            return "uniform_misses";
+            case Counter::Builds:                   return "builds";
+            case Counter::Recompiles:               return "recompiles";
+            case Counter::RecompilesSkipped:        return "recompiles_skipped";
+            case Counter::FailedBuilds:             return "failed_builds";
+            case Counter::ProgramBinaryHits:        return "program_binary_hits";
+            case Counter::ProgramBinaryMisses:      return "program_binary_misses";
+            case Counter::ProgramBinaryStoreFailures: return "program_binary_store_failures";
+            case Counter::SharedCacheHits:          return "shared_cache_hits";
+            case Counter::SharedCacheMisses:        return "shared_cache_misses";
+            case Counter::BatchedDraws:             return "batched_draws";
+            case Counter::DrawSubmissions:          return "draw_submissions";
+            case Counter::PrewarmDraws:             return "prewarm_draws";
+            case Counter::DriverPerformanceMessages: return "driver_performance_messages";
+            default:                                return "";
+        }
+    }
+
+}
@@ -0,0 +1,198 @@
+
+#include <draw_batcher.h>
+#include <counters.h>
+#include <gl_dispatch.h>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace GLSL {
+
+    namespace {
+
+        // Layout of one command in the draw indirect buffer.
+        struct DrawElementsIndirectCommand {
+            GLuint _count;
+            GLuint _instanceCount;
+            GLuint _firstIndex;
+            GLint _baseVertex;
+            GLuint _baseInstance;
+        };
+
+        // Checks the extension rather than the version: shaders below #version 460 need it to read gl_DrawIDARB.
+        bool SupportsShaderDrawParameters() {
+            GLint extensionCount = 0;
+            GL().GetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+
+            for (GLint i = 0; i < extensionCount; ++i) {
+                const GLubyte* extension = GL().GetStringi(GL_EXTENSIONS, static_cast<GLuint>(i));
+                if (extension && std::strcmp(reinterpret_cast<const char*>(extension), "GL_ARB_shader_draw_parameters") == 0) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        const void* ToIndexOffset(GLuint firstIndex) {
+            return reinterpret_cast<const void*>(static_cast<std::uintptr_t>(firstIndex) * sizeof(GLuint));
+        }
+
+    }
+
+    DrawBatcher::DrawBatcher(Shader& shader) : _shader(shader),
+                                               _mode(GL_TRIANGLES),
+                                               _multiDraw(SupportsShaderDrawParameters()),
+                                               _perDrawBuffer(0),
+                                               _indirectBuffer(0) {
+    }
+
+    DrawBatcher::~DrawBatcher() {
+        if (_perDrawBuffer != 0) {
+            GL().DeleteBuffers(1, &_perDrawBuffer);
+        }
+        if (_indirectBuffer != 0) {
+            GL().DeleteBuffers(1, &_indirectBuffer);
+        }
+    }
+
+    void DrawBatcher::Begin(GLenum mode) {
+        _mode = mode;
+        _layout = _shader.GetPerDrawLayout();
+        _currentValues.assign(_layout._stride, 0);
+        _regularValues.clear();
+
+        _shader.Bind();
+    }
+
+    void DrawBatcher::Draw(GLsizei count, GLuint firstIndex, GLint baseVertex) {
+        // Nothing to batch.
+        if (_layout.IsEmpty()) {
+            GL().DrawElementsInstancedBaseVertex(_mode, count, GL_UNSIGNED_INT, ToIndexOffset(firstIndex), 1, baseVertex);
+            Counters::Increment(Counters::Counter::DrawSubmissions);
+            return;
+        }
+
+        _draws.push_back({ count, firstIndex, baseVertex });
+        _perDrawValues.insert(_perDrawValues.end(), _currentValues.begin(), _currentValues.end());
+        Counters::Increment(Counters::Counter::BatchedDraws);
+    }
+
+    void DrawBatcher::End() {
+        Flush();
+        _shader.Unbind();
+    }
+
+    std::size_t DrawBatcher::GetQueuedDraws() const {
+        return _draws.size();
+    }
+
+    void DrawBatcher::Flush() {
+        if (_draws.empty()) {
+            return;
+        }
+
+        // Buffers are respecified on every submission, so the driver can hand out fresh storage instead of waiting for
+        // the previous draws to finish reading it.
+        if (_perDrawBuffer == 0) {
+            GL().GenBuffers(1, &_perDrawBuffer);
+        }
+        GL().BindBuffer(GL_SHADER_STORAGE_BUFFER, _perDrawBuffer);
+        GL().BufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(_perDrawValues.size()), _perDrawValues.data(), GL_STREAM_DRAW);
+        GL().BindBufferBase(GL_SHADER_STORAGE_BUFFER, PerDrawUniforms::BufferBinding, _perDrawBuffer);
+
+        if (_multiDraw) {
+            std::vector<DrawElementsIndirectCommand> commands;
+            commands.reserve(_draws.size());
+            for (const DrawCommand& draw : _draws) {
+                commands.push_back({ static_cast<GLuint>(draw._count), 1, draw._firstIndex, draw._baseVertex, 0 });
+            }
+
+            if (_indirectBuffer == 0) {
+                GL().GenBuffers(1, &_indirectBuffer);
+            }
+            GL().BindBuffer(GL_DRAW_INDIRECT_BUFFER, _indirectBuffer);
+            GL().BufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(commands.size() * sizeof(DrawElementsIndirectCommand)), commands.data(), GL_STREAM_DRAW);
+
+            // Draw index is gl_DrawID alone.
+            _shader.SetUniform("glslDrawOffset", 0);
+            GL().MultiDrawElementsIndirect(_mode, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(commands.size()), 0);
+            GL().BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+            Counters::Increment(Counters::Counter::DrawSubmissions);
+        }
+        else {
+            // Runs of the same geometry are instanced, gl_InstanceID selects the draw within the run.
+            std::size_t runStart = 0;
+            while (runStart < _draws.size()) {
+                const DrawCommand& draw = _draws[runStart];
+                std::size_t runEnd = runStart + 1;
+                while (runEnd < _draws.size() && _draws[runEnd]._count == draw._count && _draws[runEnd]._firstIndex == draw._firstIndex &&
+                       _draws[runEnd]._baseVertex == draw._baseVertex) {
+                    ++runEnd;
+                }
+
+                _shader.SetUniform("glslDrawOffset", static_cast<int>(runStart));
+                GL().DrawElementsInstancedBaseVertex(_mode, draw._count, GL_UNSIGNED_INT, ToIndexOffset(draw._firstIndex), static_cast<GLsizei>(runEnd - runStart), draw._baseVertex);
+                Counters::Increment(Counters::Counter::DrawSubmissions);
+
+                runStart = runEnd;
+            }
+        }
+
+        GL().BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        _draws.clear();
+        _perDrawValues.clear();
+    }
+
+    void DrawBatcher::WritePerDrawValue(const PerDrawLayout::Member& member, int value) {
+        Write(member, "int", 0, &value, sizeof(value));
+    }
+
+    void DrawBatcher::WritePerDrawValue(const PerDrawLayout::Member& member, bool value) {
+        // Stored as uint, see PerDrawUniforms.
+        std::uint32_t storedValue = value ? 1 : 0;
+        Write(member, "bool", 0, &storedValue, sizeof(storedValue));
+    }
+
+    void DrawBatcher::WritePerDrawValue(const PerDrawLayout::Member& member, float value) {
+        Write(member, "float", 0, &value, sizeof(value));
+    }
+
+    void DrawBatcher::WritePerDrawValue(const PerDrawLayout::Member& member, const glm::vec2& value) {
+        Write(member, "vec2", 0, glm::value_ptr(value), sizeof(float) * 2);
+    }
+
+    void DrawBatcher::WritePerDrawValue(const PerDrawLayout::Member& member, const glm::vec3& value) {
+        Write(member, "vec3", 0, glm::value_ptr(value), sizeof(float) * 3);
+    }
+
+    void DrawBatcher::WritePerDrawValue(const PerDrawLayout::Member& member, const glm::vec4& value) {
+        Write(member, "vec4", 0, glm::value_ptr(value), sizeof(float) * 4);
+    }
+
+    void DrawBatcher::WritePerDrawValue(const PerDrawLayout::Member& member, const glm::mat3& value) {
+        // Columns are padded to vec4 in std430.
+        for (int column = 0; column < 3; ++column) {
+            Write(member, "mat3", column * sizeof(float) * 4, glm::value_ptr(value) + column * 3, sizeof(float) * 3);
+        }
+    }
+
+    void DrawBatcher::WritePerDrawValue(const PerDrawLayout::Member& member, const glm::mat4& value) {
+        Write(member, "mat4", 0, glm::value_ptr(value), sizeof(float) * 16);
+    }
+
+    void DrawBatcher::Write(const PerDrawLayout::Member& member, const std::string& type, std::size_t offset, const void* data, std::size_t size) {
+        if (member._type != type) {
+            throw std::runtime_error("Per-draw uniform '" + member._name + "' of shader '" + _shader.GetName() + "' is of type '" + member._type +
+                                     "', but was set as '" + type + "'.");
+        }
+
+        std::memcpy(_currentValues.data() + member._offset + offset, data, size);
+    }
+
+}
@@ -0,0 +1,160 @@
+
+#include <driver_messages.h>
+#include <counters.h>
+#include <gl_dispatch.h>
+
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace GLSL {
+
+    // Static initialization.
+    bool DriverMessages::_enabled = false;
+
+    namespace {
+
+        // Shader name, source, type and identifier of a message.
+        using MessageKey = std::tuple<std::string, GLenum, GLenum, GLuint>;
+
+        // Messages are delivered synchronously on the context thread, the lock only guards against drivers that ignore it.
+        std::mutex statisticsMutex;
+        std::map<MessageKey, DriverMessages::MessageStatistics> messageStatistics;
+
+        std::string boundShaderName;
+        std::string buildingShaderName;
+        bool isBuilding = false;
+
+        void OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity, const std::string& message) {
+            if (type == GL_DEBUG_TYPE_PERFORMANCE) {
+                Counters::Increment(Counters::Counter::DriverPerformanceMessages);
+            }
+
+            // A shader being built takes precedence over the one that happens to be bound.
+            const std::string& shaderName = isBuilding ? buildingShaderName : boundShaderName;
+
+            std::lock_guard<std::mutex> lock(statisticsMutex);
+            DriverMessages::MessageStatistics& statistics = messageStatistics[MessageKey(shaderName, source, type, id)];
+
+            if (statistics._count == 0) {
+                statistics._shaderName = shaderName;
+                statistics._source = source;
+                statistics._type = type;
+                statistics._id = id;
+                statistics._severity = severity;
+                statistics._message = message;
+            }
+            ++statistics._count;
+        }
+
+        void APIENTRY DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* /*userParam*/) {
+            // Length is negative if the message is null terminated.
+            OnMessage(source, type, id, severity, length < 0 ? std::string(message) : std::string(message, static_cast<std::size_t>(length)));
+        }
+
+    }
+
+    DriverMessages::BuildScope::BuildScope(const std::string& shaderName) : _active(DriverMessages::IsEnabled()),
+                                                                            _previousIsBuilding(isBuilding) {
+        if (!_active) {
+            return;
+        }
+
+        // Builds may nest (e.g. a shader built while another is reloaded), the enclosing one is restored on destruction.
+        _previousShaderName = std::move(buildingShaderName);
+        buildingShaderName = shaderName;
+        isBuilding = true;
+    }
+
+    DriverMessages::BuildScope::~BuildScope() {
+        if (!_active) {
+            return;
+        }
+
+        buildingShaderName = std::move(_previousShaderName);
+        isBuilding = _previousIsBuilding;
+    }
+
+    void DriverMessages::Enable(bool allTypes) {
+        if (_enabled) {
+            return;
+        }
+
+        GL().Enable(GL_DEBUG_OUTPUT);
+        GL().Enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        GL().DebugMessageCallback(DebugMessageCallback, nullptr);
+
+        GL().DebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, allTypes ? GL_TRUE : GL_FALSE);
+        GL().DebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_PERFORMANCE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+
+        _enabled = true;
+    }
+
+    void DriverMessages::Disable() {
+        if (!_enabled) {
+            return;
+        }
+
+        GL().DebugMessageCallback(nullptr, nullptr);
+        GL().Disable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        GL().Disable(GL_DEBUG_OUTPUT);
+
+        boundShaderName.clear();
+        _enabled = false;
+    }
+
+    void DriverMessages::Bind(const std::string& shaderName) {
+        if (_enabled) {
+            boundShaderName = shaderName;
+        }
+    }
+
+    void DriverMessages::Unbind() {
+        boundShaderName.clear();
+    }
+
+    std::vector<DriverMessages::MessageStatistics> DriverMessages::GetStatistics() {
+        std::lock_guard<std::mutex> lock(statisticsMutex);
+        std::vector<MessageStatistics> statistics;
+        statistics.reserve(messageStatistics.size());
+
+        for (const auto& entry : messageStatistics) {
+            statistics.emplace_back(entry.second);
+        }
+
+        return statistics;
+    }
+
+    void DriverMessages::Reset() {
+        std::lock_guard<std::mutex> lock(statisticsMutex);
+        messageStatistics.clear();
+    }
+
+    const char* DriverMessages::GetSourceName(GLenum source) {
+        switch (source) {
+            case GL_DEBUG_SOURCE_API:             return "api";
+            case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   return "window system";
+            case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+            case GL_DEBUG_SOURCE_THIRD_PARTY:     return "third party";
+            case GL_DEBUG_SOURCE_APPLICATION:     return "application";
+            case GL_DEBUG_SOURCE_OTHER:           return "other";
+            default:                              return "";
+        }
+    }
+
+    const char* DriverMessages::GetTypeName(GLenum type) {
+        switch (type) {
+            case GL_DEBUG_TYPE_ERROR:               return "error";
+            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated behavior";
+            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "undefined behavior";
+            case GL_DEBUG_TYPE_PORTABILITY:         return "portability";
+            case GL_DEBUG_TYPE_PERFORMANCE:         return "performance";
+            case GL_DEBUG_TYPE_MARKER:              return "marker";
+            case GL_DEBUG_TYPE_PUSH_GROUP:          return "push group";
+            case GL_DEBUG_TYPE_POP_GROUP:           return "pop group";
+            case GL_DEBUG_TYPE_OTHER:               return "other";
+            default:                                return "";
+        }
+    }
+
+}
@@ -0,0 +1,98 @@
+
+#include <gl_dispatch.h>
+
+namespace GLSL {
+
+    // glad entry points are function pointers that are only assigned once a context is loaded, so they are read at call time.
+    static const GLDispatch gladDispatch {
+        // Shader components.
+        [](GLenum type) { return glCreateShader(type); },
+        [](GLuint shader) { glDeleteShader(shader); },
+        [](GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) { glShaderSource(shader, count, string, length); },
+        [](GLuint shader) { glCompileShader(shader); },
+        [](GLuint shader, GLenum pname, GLint* params) { glGetShaderiv(shader, pname, params); },
+        [](GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog) { glGetShaderInfoLog(shader, bufSize, length, infoLog); },
+
+        // Shader programs.
+        []() { return glCreateProgram(); },
+        [](GLuint program) { glDeleteProgram(program); },
+        [](GLuint program, GLuint shader) { glAttachShader(program, shader); },
+        [](GLuint program, GLuint shader) { glDetachShader(program, shader); },
+        [](GLuint program) { glLinkProgram(program); },
+        [](GLuint program, GLenum pname, GLint* params) { glGetProgramiv(program, pname, params); },
+        [](GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog) { glGetProgramInfoLog(program, bufSize, length, infoLog); },
+        [](GLuint program) { glUseProgram(program); },
+        [](GLuint program, GLenum pname, GLint value) { glProgramParameteri(program, pname, value); },
+        [](GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary) { glGetProgramBinary(program, bufSize, length, binaryFormat, binary); },
+        [](GLuint program, GLenum binaryFormat, const void* binary, GLsizei length) { glProgramBinary(program, binaryFormat, binary, length); },
+        [](GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) { glGetActiveAttrib(program, index, bufSize, length, size, type, name); },
+        [](GLuint program, const GLchar* name) { return glGetAttribLocation(program, name); },
+
+        // Uniforms.
+        [](GLuint program, const GLchar* name) { return glGetUniformLocation(program, name); },
+        [](GLint location, GLint v0) { glUniform1i(location, v0); },
+        [](GLint location, GLfloat v0) { glUniform1f(location, v0); },
+        [](GLint location, GLsizei count, const GLfloat* value) { glUniform2fv(location, count, value); },
+        [](GLint location, GLsizei count, const GLfloat* value) { glUniform3fv(location, count, value); },
+        [](GLint location, GLsizei count, const GLfloat* value) { glUniform4fv(location, count, value); },
+        [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) { glUniformMatrix3fv(location, count, transpose, value); },
+        [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) { glUniformMatrix4fv(location, count, transpose, value); },
+
+        // Queries and context state.
+        [](GLenum name) { return glGetString(name); },
+        [](GLenum pname, GLint* data) { glGetIntegerv(pname, data); },
+        [](GLenum name, GLuint index) { return glGetStringi(name, index); },
+        [](GLsizei n, GLuint* ids) { glGenQueries(n, ids); },
+        [](GLsizei n, const GLuint* ids) { glDeleteQueries(n, ids); },
+        [](GLenum target, GLuint id) { glBeginQuery(target, id); },
+        [](GLenum target) { glEndQuery(target); },
+        [](GLuint id, GLenum pname, GLint* params) { glGetQueryObjectiv(id, pname, params); },
+        [](GLuint id, GLenum pname, GLuint64* params) { glGetQueryObjectui64v(id, pname, params); },
+
+        // Buffers and draws.
+        [](GLsizei n, GLuint* buffers) { glGenBuffers(n, buffers); },
+        [](GLsizei n, const GLuint* buffers) { glDeleteBuffers(n, buffers); },
+        [](GLenum target, GLuint buffer) { glBindBuffer(target, buffer); },
+        [](GLenum target, GLsizeiptr size, const void* data, GLenum usage) { glBufferData(target, size, data, usage); },
+        [](GLenum target, GLuint index, GLuint buffer) { glBindBufferBase(target, index, buffer); },
+        [](GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex) { glDrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex); },
+        [](GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride) { glMultiDrawElementsIndirect(mode, type, indirect, drawcount, stride); },
+        [](GLenum mode, GLint first, GLsizei count) { glDrawArrays(mode, first, count); },
+
+        // Framebuffers and vertex arrays.
+        [](GLsizei n, GLuint* framebuffers) { glGenFramebuffers(n, framebuffers); },
+        [](GLsizei n, const GLuint* framebuffers) { glDeleteFramebuffers(n, framebuffers); },
+        [](GLenum target, GLuint framebuffer) { glBindFramebuffer(target, framebuffer); },
+        [](GLsizei n, GLuint* renderbuffers) { glGenRenderbuffers(n, renderbuffers); },
+        [](GLsizei n, const GLuint* renderbuffers) { glDeleteRenderbuffers(n, renderbuffers); },
+        [](GLenum target, GLuint renderbuffer) { glBindRenderbuffer(target, renderbuffer); },
+        [](GLenum target, GLenum internalformat, GLsizei width, GLsizei height) { glRenderbufferStorage(target, internalformat, width, height); },
+        [](GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer) { glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer); },
+        [](GLsizei n, GLuint* arrays) { glGenVertexArrays(n, arrays); },
+        [](GLsizei n, const GLuint* arrays) { glDeleteVertexArrays(n, arrays); },
+        [](GLuint array) { glBindVertexArray(array); },
+        [](GLuint index) { glEnableVertexAttribArray(index); },
+        [](GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) { glVertexAttribPointer(index, size, type, normalized, stride, pointer); },
+        [](GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) { glVertexAttribIPointer(index, size, type, stride, pointer); },
+        [](GLint x, GLint y, GLsizei width, GLsizei height) { glViewport(x, y, width, height); },
+
+        // Debug output.
+        [](GLenum cap) { glEnable(cap); },
+        [](GLenum cap) { glDisable(cap); },
+        [](GLDEBUGPROC callback, const void* userParam) { glDebugMessageCallback(callback, userParam); },
+        [](GLenum source, GLenum type, GLenum severity, GLsizei count, const GLuint* ids, GLboolean enabled) { glDebugMessageControl(source, type, severity, count, ids, enabled); },
+    };
+
+    namespace Detail {
+        GLDispatch _glDispatch = gladDispatch;
+    }
+
+    const GLDispatch& GetGladDispatch() {
+        return gladDispatch;
+    }
+
+    void SetGLDispatch(const GLDispatch& dispatch) {
+        Detail::_glDispatch = dispatch;
+    }
+
+}
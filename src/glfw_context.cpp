@@ -0,0 +1,35 @@
+#include <glfw_context.h>
+
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+
+namespace GLSL {
+
+    bool InitializeGLFW(bool headless) {
+        if (headless) {
+            #if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+                if (!glfwPlatformSupported(GLFW_PLATFORM_NULL)) {
+                    std::cerr << "GLFW was built without the null platform, headless contexts are not available." << std::endl;
+                    return false;
+                }
+                glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+            #else
+                std::cerr << "Headless contexts require GLFW 3.4 or newer." << std::endl;
+                return false;
+            #endif
+        }
+
+        if (!glfwInit()) {
+            return false;
+        }
+
+        if (headless) {
+            // The null platform has no native context API, EGL picks the surfaceless platform on it.
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        }
+
+        return true;
+    }
+
+}
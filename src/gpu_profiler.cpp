@@ -0,0 +1,246 @@
+
+#include <gpu_profiler.h>
+#include <gl_dispatch.h>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+// Tokens of ARB_pipeline_statistics_query (core in OpenGL 4.6), which are not part of the OpenGL 4.5 glad headers.
+#ifndef GL_VERTICES_SUBMITTED_ARB
+    #define GL_VERTICES_SUBMITTED_ARB 0x82EE
+    #define GL_PRIMITIVES_SUBMITTED_ARB 0x82EF
+    #define GL_VERTEX_SHADER_INVOCATIONS_ARB 0x82F0
+    #define GL_FRAGMENT_SHADER_INVOCATIONS_ARB 0x82F4
+    #define GL_CLIPPING_INPUT_PRIMITIVES_ARB 0x82F6
+    #define GL_CLIPPING_OUTPUT_PRIMITIVES_ARB 0x82F7
+#endif
+
+namespace GLSL {
+
+    // Static initialization.
+    bool GPUProfiler::_enabled = false;
+
+    namespace {
+
+        constexpr std::size_t pipelineStatisticCount = static_cast<std::size_t>(GPUProfiler::PipelineStatistic::Count);
+
+        // Query targets, in PipelineStatistic order.
+        constexpr std::array<GLenum, pipelineStatisticCount> pipelineStatisticTargets {
+            GL_VERTICES_SUBMITTED_ARB, GL_PRIMITIVES_SUBMITTED_ARB, GL_VERTEX_SHADER_INVOCATIONS_ARB, GL_GEOMETRY_SHADER_INVOCATIONS,
+            GL_FRAGMENT_SHADER_INVOCATIONS_ARB, GL_CLIPPING_INPUT_PRIMITIVES_ARB, GL_CLIPPING_OUTPUT_PRIMITIVES_ARB
+        };
+
+        struct QuerySlot {
+            GLuint _timeQuery = 0;
+            std::array<GLuint, pipelineStatisticCount> _statisticQueries { };
+            std::size_t _shaderIndex = 0;
+        };
+
+        bool pipelineStatisticsSupported = false;
+
+        // Ring buffer of in-flight scopes: [tail, tail + pendingCount) are waiting for results, head is the next free slot.
+        std::vector<QuerySlot> ring;
+        std::size_t head = 0;
+        std::size_t tail = 0;
+        std::size_t pendingCount = 0;
+        bool scopeActive = false;
+
+        std::vector<GPUProfiler::ShaderStatistics> shaderStatistics;
+        std::unordered_map<std::string, std::size_t> shaderIndices;
+        std::uint64_t droppedScopes = 0;
+
+        bool SupportsPipelineStatistics() {
+            GLint majorVersion = 0;
+            GLint minorVersion = 0;
+            GL().GetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+            GL().GetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+            if (majorVersion > 4 || (majorVersion == 4 && minorVersion >= 6)) {
+                return true;
+            }
+
+            GLint extensionCount = 0;
+            GL().GetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+
+            for (GLint i = 0; i < extensionCount; ++i) {
+                const GLubyte* extension = GL().GetStringi(GL_EXTENSIONS, static_cast<GLuint>(i));
+                if (extension && std::strcmp(reinterpret_cast<const char*>(extension), "GL_ARB_pipeline_statistics_query") == 0) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool IsAvailable(GLuint query) {
+            GLint available = GL_FALSE;
+            GL().GetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            return available != GL_FALSE;
+        }
+
+    }
+
+    void GPUProfiler::Enable(std::size_t ringSize) {
+        if (_enabled) {
+            return;
+        }
+
+        pipelineStatisticsSupported = SupportsPipelineStatistics();
+
+        ring.assign(std::max<std::size_t>(ringSize, 1), QuerySlot());
+        for (QuerySlot& slot : ring) {
+            GL().GenQueries(1, &slot._timeQuery);
+            if (pipelineStatisticsSupported) {
+                GL().GenQueries(static_cast<GLsizei>(pipelineStatisticCount), slot._statisticQueries.data());
+            }
+        }
+
+        head = 0;
+        tail = 0;
+        pendingCount = 0;
+        scopeActive = false;
+        _enabled = true;
+    }
+
+    void GPUProfiler::Disable() {
+        if (!_enabled) {
+            return;
+        }
+
+        End();
+
+        for (QuerySlot& slot : ring) {
+            GL().DeleteQueries(1, &slot._timeQuery);
+            if (pipelineStatisticsSupported) {
+                GL().DeleteQueries(static_cast<GLsizei>(pipelineStatisticCount), slot._statisticQueries.data());
+            }
+        }
+
+        ring.clear();
+        pendingCount = 0;
+        _enabled = false;
+    }
+
+    bool GPUProfiler::HasPipelineStatistics() {
+        return pipelineStatisticsSupported;
+    }
+
+    void GPUProfiler::Begin(const std::string& shaderName) {
+        if (!_enabled) {
+            return;
+        }
+
+        // Only one query per target may be active, binding another shader ends the current scope.
+        End();
+
+        // Never wait for the GPU, drop the scope instead.
+        if (pendingCount == ring.size()) {
+            ++droppedScopes;
+            return;
+        }
+
+        auto shaderIndexIt = shaderIndices.find(shaderName);
+        if (shaderIndexIt == shaderIndices.end()) {
+            shaderIndexIt = shaderIndices.emplace(shaderName, shaderStatistics.size()).first;
+            shaderStatistics.emplace_back()._shaderName = shaderName;
+        }
+
+        QuerySlot& slot = ring[head];
+        slot._shaderIndex = shaderIndexIt->second;
+
+        GL().BeginQuery(GL_TIME_ELAPSED, slot._timeQuery);
+        if (pipelineStatisticsSupported) {
+            for (std::size_t i = 0; i < pipelineStatisticCount; ++i) {
+                GL().BeginQuery(pipelineStatisticTargets[i], slot._statisticQueries[i]);
+            }
+        }
+
+        scopeActive = true;
+    }
+
+    void GPUProfiler::End() {
+        if (!scopeActive) {
+            return;
+        }
+
+        if (pipelineStatisticsSupported) {
+            for (GLenum target : pipelineStatisticTargets) {
+                GL().EndQuery(target);
+            }
+        }
+        GL().EndQuery(GL_TIME_ELAPSED);
+
+        head = (head + 1) % ring.size();
+        ++pendingCount;
+        scopeActive = false;
+    }
+
+    void GPUProfiler::Collect() {
+        while (pendingCount > 0) {
+            QuerySlot& slot = ring[tail];
+
+            // Results of a scope are read back only once all of its queries have completed.
+            if (!IsAvailable(slot._timeQuery)) {
+                break;
+            }
+            if (pipelineStatisticsSupported && !std::all_of(slot._statisticQueries.begin(), slot._statisticQueries.end(), IsAvailable)) {
+                break;
+            }
+
+            ShaderStatistics& statistics = shaderStatistics[slot._shaderIndex];
+
+            GLuint64 elapsed = 0;
+            GL().GetQueryObjectui64v(slot._timeQuery, GL_QUERY_RESULT, &elapsed);
+
+            ++statistics._samples;
+            statistics._totalNanoseconds += elapsed;
+            statistics._minNanoseconds = std::min<std::uint64_t>(statistics._minNanoseconds, elapsed);
+            statistics._maxNanoseconds = std::max<std::uint64_t>(statistics._maxNanoseconds, elapsed);
+
+            if (pipelineStatisticsSupported) {
+                for (std::size_t i = 0; i < pipelineStatisticCount; ++i) {
+                    GLuint64 value = 0;
+                    GL().GetQueryObjectui64v(slot._statisticQueries[i], GL_QUERY_RESULT, &value);
+                    statistics._pipelineStatistics[i] += value;
+                }
+            }
+
+            tail = (tail + 1) % ring.size();
+            --pendingCount;
+        }
+    }
+
+    const std::vector<GPUProfiler::ShaderStatistics>& GPUProfiler::GetStatistics() {
+        return shaderStatistics;
+    }
+
+    std::uint64_t GPUProfiler::GetDroppedScopes() {
+        return droppedScopes;
+    }
+
+    void GPUProfiler::Reset() {
+        // Scopes in flight keep referring to their shader, so only the totals are cleared.
+        for (ShaderStatistics& statistics : shaderStatistics) {
+            std::string shaderName = std::move(statistics._shaderName);
+            statistics = ShaderStatistics();
+            statistics._shaderName = std::move(shaderName);
+        }
+
+        droppedScopes = 0;
+    }
+
+    const char* GPUProfiler::GetPipelineStatisticName(PipelineStatistic statistic) {
+        switch (statistic) {
+            case PipelineStatistic::VerticesSubmitted:         return "vertices submitted";
+            case PipelineStatistic::PrimitivesSubmitted:       return "primitives submitted";
+            case PipelineStatistic::VertexShaderInvocations:   return "vertex shader invocations";
+            case PipelineStatistic::GeometryShaderInvocations: return "geometry shader invocations";
+            case PipelineStatistic::FragmentShaderInvocations: return "fragment shader invocations";
+            case PipelineStatistic::ClippingInputPrimitives:   return "clipping input primitives";
+            case PipelineStatistic::ClippingOutputPrimitives:  return "clipping output primitives";
+            default:                                           return "";
+        }
+    }
+
+}
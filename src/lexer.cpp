@@ -0,0 +1,302 @@
+
+#include <lexer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <iterator>
+#include <thread>
+
+namespace GLSL {
+
+    namespace {
+
+        struct Chunk {
+            std::string_view _text;
+            bool _isLast = false; // Text after the last newline is a line of the last chunk only.
+
+            std::vector<std::string> _lines;
+            std::vector<std::size_t> _directiveLines; // Relative to the first line of the chunk.
+            std::vector<Lexer::State> _lineEndStates; // Kept for the fix-up of parallel chunks only.
+            Lexer::State _endState = Lexer::State::Code;
+        };
+
+        // Returns the line starting at position and advances position past its newline. Returns false at the end of the chunk.
+        bool NextLine(const Chunk& chunk, std::size_t& position, std::string_view& line) {
+            if (position > chunk._text.size()) {
+                return false;
+            }
+
+            std::size_t newlinePosition = chunk._text.find('\n', position);
+            if (newlinePosition == std::string_view::npos) {
+                if (!chunk._isLast) {
+                    return false;
+                }
+
+                line = chunk._text.substr(position);
+                position = chunk._text.size() + 1;
+                return true;
+            }
+
+            line = chunk._text.substr(position, newlinePosition - position);
+            position = newlinePosition + 1;
+            return true;
+        }
+
+        void LexChunk(Chunk& chunk, Lexer::State state, bool keepLineEndStates) {
+            std::size_t position = 0;
+            std::string_view line;
+
+            while (NextLine(chunk, position, line)) {
+                std::string& lexedLine = chunk._lines.emplace_back();
+                state = Lexer::LexLine(line, state, lexedLine);
+
+                if (Lexer::IsDirective(lexedLine)) {
+                    chunk._directiveLines.emplace_back(chunk._lines.size() - 1);
+                }
+                if (keepLineEndStates) {
+                    chunk._lineEndStates.emplace_back(state);
+                }
+            }
+
+            chunk._endState = state;
+        }
+
+        // Re-lexes a chunk that was speculatively lexed from outside of a comment, but starts inside one. Lines are
+        // re-lexed until the comment state at the end of a line matches the speculative one, all following lines were
+        // lexed correctly already.
+        void FixUpChunk(Chunk& chunk, Lexer::State state) {
+            std::size_t position = 0;
+            std::size_t lineIndex = 0;
+            std::string_view line;
+            std::vector<std::size_t> directiveLines;
+            bool hasConverged = false;
+
+            while (!hasConverged && NextLine(chunk, position, line)) {
+                std::string& lexedLine = chunk._lines[lineIndex];
+                lexedLine.clear();
+                state = Lexer::LexLine(line, state, lexedLine);
+
+                if (Lexer::IsDirective(lexedLine)) {
+                    directiveLines.emplace_back(lineIndex);
+                }
+
+                hasConverged = state == chunk._lineEndStates[lineIndex];
+                ++lineIndex;
+            }
+
+            // Merge the directives of the re-lexed lines with the speculative directives of the following lines.
+            auto firstKept = std::lower_bound(chunk._directiveLines.begin(), chunk._directiveLines.end(), lineIndex);
+            directiveLines.insert(directiveLines.end(), firstKept, chunk._directiveLines.end());
+            chunk._directiveLines = std::move(directiveLines);
+
+            if (!hasConverged) {
+                chunk._endState = state;
+            }
+        }
+
+        std::size_t FindComment(std::string_view line, std::size_t position) {
+            for (std::size_t i = position; i + 1 < line.size(); ++i) {
+                if (line[i] == '/' && (line[i + 1] == '/' || line[i + 1] == '*')) {
+                    return i;
+                }
+            }
+
+            return std::string_view::npos;
+        }
+
+        bool IsWordCharacter(char character) {
+            return std::isalnum(static_cast<unsigned char>(character)) || character == '_' || character == '.';
+        }
+
+        // Whitespace between two word characters (identifiers, numbers) separates tokens, as does whitespace between
+        // punctuation characters that would otherwise form an operator ("+ +", "< =") or a comment ("/ *"). In directives,
+        // whitespace before a parenthesis distinguishes object-like from function-like macros.
+        bool NeedsSeparator(char previous, char next, bool isDirective) {
+            if (previous == '\n') {
+                return false;
+            }
+            if (isDirective && next == '(' && IsWordCharacter(previous)) {
+                return true;
+            }
+            if (IsWordCharacter(previous) || IsWordCharacter(next)) {
+                return IsWordCharacter(previous) && IsWordCharacter(next);
+            }
+
+            bool isAssignment = next == '=' && std::strchr("+-*/%<>=!&|^", previous) != nullptr;
+            bool isDoubled = previous == next && std::strchr("+-<>&|^#", previous) != nullptr;
+            bool isComment = (previous == '/' && (next == '/' || next == '*')) || (previous == '*' && next == '/');
+            return isAssignment || isDoubled || isComment;
+        }
+
+    }
+
+    Lexer::State Lexer::LexLine(std::string_view line, State state, std::string& lexedLine) {
+        std::size_t position = 0;
+
+        while (position < line.size()) {
+            // Code resumes after the closing */ of a block comment opened on a previous line.
+            if (state == State::BlockComment) {
+                std::size_t commentEnd = line.find("*/", position);
+                if (commentEnd == std::string_view::npos) {
+                    return state;
+                }
+
+                position = commentEnd + 2;
+                state = State::Code;
+                continue;
+            }
+
+            std::size_t commentPosition = FindComment(line, position);
+            lexedLine.append(line.substr(position, commentPosition == std::string_view::npos ? std::string_view::npos : commentPosition - position));
+
+            // No comment, or a line comment that discards the remainder of the line.
+            if (commentPosition == std::string_view::npos || line[commentPosition + 1] == '/') {
+                break;
+            }
+
+            // Block comment. The search for */ starts at the opening '*', like EraseComments.
+            std::size_t commentEnd = line.find("*/", commentPosition + 1);
+            if (commentEnd == std::string_view::npos) {
+                return State::BlockComment;
+            }
+
+            position = commentEnd + 2;
+        }
+
+        return state;
+    }
+
+    bool Lexer::IsDirective(std::string_view lexedLine) {
+        std::size_t position = lexedLine.find_first_not_of(" \t\r\v\f");
+        return position != std::string_view::npos && lexedLine[position] == '#';
+    }
+
+    LexedSource Lexer::Lex(std::string_view source, std::size_t threadCount) {
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // Split at the first newline after every ChunkSize bytes.
+        std::vector<Chunk> chunks;
+        std::size_t chunkStart = 0;
+        while (threadCount > 1 && source.size() - chunkStart >= 2 * ChunkSize) {
+            std::size_t newlinePosition = source.find('\n', chunkStart + ChunkSize);
+            if (newlinePosition == std::string_view::npos) {
+                break;
+            }
+
+            chunks.emplace_back()._text = source.substr(chunkStart, newlinePosition + 1 - chunkStart);
+            chunkStart = newlinePosition + 1;
+        }
+        Chunk& lastChunk = chunks.emplace_back();
+        lastChunk._text = source.substr(chunkStart);
+        lastChunk._isLast = true;
+
+        // Small sources are lexed on the calling thread.
+        if (chunks.size() == 1) {
+            LexedSource lexedSource;
+            LexChunk(chunks.front(), State::Code, false);
+
+            lexedSource._lines = std::move(chunks.front()._lines);
+            lexedSource._directiveLines = std::move(chunks.front()._directiveLines);
+            return lexedSource;
+        }
+
+        // Speculative pass, every chunk starts outside of a comment.
+        std::atomic<std::size_t> nextChunk { 0 };
+        auto lexChunks = [&]() {
+            for (std::size_t i = nextChunk++; i < chunks.size(); i = nextChunk++) {
+                LexChunk(chunks[i], State::Code, true);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < std::min(threadCount, chunks.size()); ++i) {
+            threads.emplace_back(lexChunks);
+        }
+        lexChunks();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        // Stitch chunks together in order, fixing up those that start inside a block comment.
+        LexedSource lexedSource;
+        std::size_t lineCount = 0;
+        State state = State::Code;
+
+        for (Chunk& chunk : chunks) {
+            if (state == State::BlockComment) {
+                FixUpChunk(chunk, state);
+            }
+
+            state = chunk._endState;
+            lineCount += chunk._lines.size();
+        }
+
+        lexedSource._lines.reserve(lineCount);
+        for (Chunk& chunk : chunks) {
+            std::size_t firstLine = lexedSource._lines.size();
+
+            for (std::size_t directiveLine : chunk._directiveLines) {
+                lexedSource._directiveLines.emplace_back(firstLine + directiveLine);
+            }
+            std::move(chunk._lines.begin(), chunk._lines.end(), std::back_inserter(lexedSource._lines));
+        }
+
+        return lexedSource;
+    }
+
+    std::string Lexer::Canonicalize(std::string_view source) {
+        LexedSource lexedSource = Lex(source);
+        bool keepLineBreaks = source.find("__LINE__") != std::string_view::npos;
+
+        std::string canonical;
+        canonical.reserve(source.size());
+        bool isInDirective = false;  // Directive continued with a backslash on the previous line.
+        bool hasWhitespace = false;  // Whitespace since the last character appended.
+
+        for (std::string& line : lexedSource._lines) {
+            bool startsDirective = !isInDirective && IsDirective(line);
+            bool isDirective = isInDirective || startsDirective;
+
+            std::size_t lineEnd = line.find_last_not_of(" \t\r\v\f");
+            line.resize(lineEnd == std::string::npos ? 0 : lineEnd + 1);
+            isInDirective = isDirective && !line.empty() && line.back() == '\\';
+            if (isInDirective) {
+                line.pop_back();
+            }
+
+            // Directives start on a line of their own.
+            if (startsDirective && !canonical.empty() && canonical.back() != '\n') {
+                canonical += '\n';
+                hasWhitespace = false;
+            }
+
+            for (char character : line) {
+                if (std::isspace(static_cast<unsigned char>(character))) {
+                    hasWhitespace = !canonical.empty();
+                    continue;
+                }
+
+                if (hasWhitespace && NeedsSeparator(canonical.back(), character, isDirective)) {
+                    canonical += ' ';
+                }
+                hasWhitespace = false;
+                canonical += character;
+            }
+
+            if ((isDirective && !isInDirective) || keepLineBreaks) {
+                canonical += '\n';
+                hasWhitespace = false;
+            }
+            else {
+                hasWhitespace = !canonical.empty();
+            }
+        }
+
+        return canonical;
+    }
+
+}
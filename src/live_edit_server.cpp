@@ -0,0 +1,191 @@
+
+#include <live_edit_server.h>
+#include <shader.h>
+#include <sockets.h>
+#include <source_overlay.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace GLSL {
+
+    namespace {
+
+        const std::size_t maximumPayloadLength = 64 * 1024 * 1024;
+
+    }
+
+    LiveEditServer::LiveEditServer(unsigned short port) : _listenSocket(Sockets::InvalidSocket),
+                                                          _port(port) {
+        _listenSocket = Sockets::Listen("Live edit server", _port);
+    }
+
+    LiveEditServer::~LiveEditServer() {
+        for (Connection& connection : _connections) {
+            Sockets::Close(connection._socket);
+            for (const std::string& filepath : connection._openFiles) {
+                SourceOverlay::Close(filepath);
+            }
+        }
+
+        Sockets::Close(_listenSocket);
+    }
+
+    unsigned short LiveEditServer::GetPort() const {
+        return _port;
+    }
+
+    void LiveEditServer::Register(Shader& shader) {
+        if (std::find(_shaders.begin(), _shaders.end(), &shader) == _shaders.end()) {
+            _shaders.emplace_back(&shader);
+        }
+    }
+
+    void LiveEditServer::Unregister(Shader& shader) {
+        _shaders.erase(std::remove(_shaders.begin(), _shaders.end(), &shader), _shaders.end());
+    }
+
+    std::size_t LiveEditServer::Poll() {
+        AcceptConnections();
+
+        std::set<std::string> changedFiles;
+        for (Connection& connection : _connections) {
+            Sockets::Receive(connection);
+            ProcessMessages(connection, changedFiles);
+        }
+
+        // Buffers of a disconnected editor are discarded.
+        for (Connection& connection : _connections) {
+            if (connection._isClosed) {
+                for (const std::string& filepath : connection._openFiles) {
+                    SourceOverlay::Close(filepath);
+                    changedFiles.insert(filepath);
+                }
+
+                Sockets::Close(connection._socket);
+            }
+        }
+        _connections.erase(std::remove_if(_connections.begin(), _connections.end(), [](const Connection& connection) {
+            return connection._isClosed;
+        }), _connections.end());
+
+        std::size_t recompiledCount = RecompileAffectedShaders(changedFiles);
+
+        for (Connection& connection : _connections) {
+            Sockets::Send(connection);
+        }
+
+        return recompiledCount;
+    }
+
+    void LiveEditServer::AcceptConnections() {
+        for (std::intptr_t clientSocket = Sockets::Accept(_listenSocket); clientSocket != Sockets::InvalidSocket; clientSocket = Sockets::Accept(_listenSocket)) {
+            Connection connection;
+            connection._socket = clientSocket;
+            _connections.emplace_back(std::move(connection));
+        }
+    }
+
+    void LiveEditServer::ProcessMessages(Connection& connection, std::set<std::string>& changedFiles) const {
+        std::size_t messageStart = 0;
+
+        while (!connection._isClosed) {
+            std::size_t headerEnd = connection._incoming.find('\n', messageStart);
+            if (headerEnd == std::string::npos) {
+                if (connection._incoming.size() - messageStart > Sockets::MaximumHeaderLength) {
+                    connection._isClosed = true;
+                }
+                break;
+            }
+
+            std::istringstream header(connection._incoming.substr(messageStart, headerEnd - messageStart));
+            std::string command;
+            header >> command;
+
+            int startLine = 0, startColumn = 0, endLine = 0, endColumn = 0;
+            std::size_t payloadLength = 0;
+            if (command == "EDIT") {
+                header >> startLine >> startColumn >> endLine >> endColumn;
+            }
+            if (command == "OPEN" || command == "EDIT") {
+                header >> payloadLength;
+            }
+
+            std::string filepath;
+            std::getline(header >> std::ws, filepath);
+
+            bool isKnownCommand = command == "OPEN" || command == "EDIT" || command == "CLOSE";
+            if (!isKnownCommand || header.fail() || filepath.empty() || payloadLength > maximumPayloadLength) {
+                Sockets::Reject(connection, "Malformed live edit message: '" + header.str() + "'");
+                break;
+            }
+
+            // Wait for the rest of the payload.
+            std::size_t payloadStart = headerEnd + 1;
+            if (connection._incoming.size() - payloadStart < payloadLength) {
+                break;
+            }
+            std::string payload = connection._incoming.substr(payloadStart, payloadLength);
+            messageStart = payloadStart + payloadLength;
+
+            try {
+                std::string key = SourceOverlay::GetKey(filepath);
+
+                if (command == "OPEN") {
+                    SourceOverlay::Open(key, payload);
+                    connection._openFiles.insert(key);
+                }
+                else if (command == "EDIT") {
+                    SourceOverlay::Edit(key, startLine, startColumn, endLine, endColumn, payload);
+                }
+                else {
+                    SourceOverlay::Close(key);
+                    connection._openFiles.erase(key);
+                }
+
+                changedFiles.insert(key);
+                connection._outgoing += "OK\n";
+            }
+            catch (std::runtime_error& exception) {
+                connection._outgoing += Sockets::FormatError(exception.what());
+            }
+        }
+
+        connection._incoming.erase(0, messageStart);
+    }
+
+    std::size_t LiveEditServer::RecompileAffectedShaders(const std::set<std::string>& changedFiles) {
+        if (changedFiles.empty()) {
+            return 0;
+        }
+
+        std::size_t recompiledCount = 0;
+        for (Shader* shader : _shaders) {
+            bool isAffected = std::any_of(shader->GetDependencies().begin(), shader->GetDependencies().end(), [&](const std::string& dependency) {
+                return changedFiles.count(SourceOverlay::GetKey(dependency)) != 0;
+            });
+            if (!isAffected) {
+                continue;
+            }
+
+            std::string result;
+            try {
+                shader->Recompile();
+                result = "BUILD OK " + shader->GetName() + "\n";
+            }
+            catch (std::runtime_error& exception) {
+                std::string message = exception.what();
+                result = "BUILD FAILED " + std::to_string(message.size()) + " " + shader->GetName() + "\n" + message;
+            }
+
+            for (Connection& connection : _connections) {
+                connection._outgoing += result;
+            }
+            ++recompiledCount;
+        }
+
+        return recompiledCount;
+    }
+
+}
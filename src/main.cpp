@@ -5,16 +5,167 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 
+#include <driver_messages.h>
+#include <glfw_context.h>
+#include <live_edit_server.h>
 #include <shader.h>
-
-int main() {
+#include <stress_benchmark.h>
+#include <trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#ifdef GLSL_INCLUDE_EMBEDDED_SHADERS
+    #include <embedded_shaders/DemoShaders.h>
+#endif
+
+// Uniforms of the SingleColor shader, uploaded with a single SetParams call per frame.
+struct SingleColorParams {
+    glm::mat4 modelTransform;
+    glm::mat4 cameraTransform;
+    glm::vec3 surfaceColor;
+};
+
+template <>
+struct GLSL::ParamBlock<SingleColorParams> {
+    static constexpr auto Members = std::make_tuple(GLSL::Param("modelTransform", &SingleColorParams::modelTransform),
+                                                    GLSL::Param("cameraTransform", &SingleColorParams::cameraTransform),
+                                                    GLSL::Param("surfaceColor", &SingleColorParams::surfaceColor));
+};
+
+// Usage: glsl-include [--trace <file>] [--build-report <file>] [--counters <file>] [--live-edit <port>] [--driver-messages] [--benchmark [--shaders N] [--draws N] [--uniforms N] [--frames N] [--egl] [--gpu-profile] [--batch]]
+//  --trace writes a Chrome trace of shader building to <file> on exit (requires GLSL_INCLUDE_ENABLE_TRACING).
+//  --build-report writes the per-shader build cost report to <file> on exit (compare reports with glsl-report-diff).
+//  --counters appends the runtime counters of shader OpenGL traffic to <file> once per second.
+//  --live-edit accepts shader edits from an editor on 127.0.0.1:<port> (see LiveEditServer) in the interactive demo.
+//  --driver-messages creates a debug context and prints the driver performance messages per shader on exit (see DriverMessages).
+//  --benchmark renders a fixed number of frames offscreen with a hidden window and reports timings instead of
+//  running the interactive demo. --egl runs headless, on GLFW's null platform with a surfaceless EGL context (e.g. for
+//  llvmpipe on machines without a display server, see InitializeGLFW). --gpu-profile additionally reports GPU time per
+//  shader. --batch submits the draws of each shader through a DrawBatcher, with per-draw uniforms in a storage buffer.
+int main(int argc, char* argv[]) {
+    auto startTime = std::chrono::steady_clock::now();
     GLSL::Shader::AddIncludeDirectory(GLSL_INCLUDE_DIRECTORY);
 
-    // Initialize GLFW.
-    int initializationCode = glfwInit();
+    // Parse arguments.
+    bool benchmark = false;
+    bool useEGL = false;
+    std::string traceFile;
+    std::string buildReportFile;
+    std::string countersFile;
+    int liveEditPort = -1;
+    bool driverMessages = false;
+    GLSL::StressBenchmarkSettings benchmarkSettings;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+
+        // Numeric values that do not parse are rejected, counts are clamped to their valid range.
+        try {
+            if (std::strcmp(argv[i], "--benchmark") == 0) {
+                benchmark = true;
+            }
+            else if (std::strcmp(argv[i], "--egl") == 0) {
+                useEGL = true;
+            }
+            else if (std::strcmp(argv[i], "--gpu-profile") == 0) {
+                benchmarkSettings._gpuProfiling = true;
+            }
+            else if (std::strcmp(argv[i], "--driver-messages") == 0) {
+                driverMessages = true;
+            }
+            else if (std::strcmp(argv[i], "--batch") == 0) {
+                benchmarkSettings._batchDraws = true;
+            }
+            else if (std::strcmp(argv[i], "--trace") == 0 && hasValue) {
+                traceFile = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--build-report") == 0 && hasValue) {
+                buildReportFile = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--counters") == 0 && hasValue) {
+                countersFile = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--live-edit") == 0 && hasValue) {
+                liveEditPort = std::stoi(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--shaders") == 0 && hasValue) {
+                benchmarkSettings._shaderCount = std::max(1, std::stoi(argv[++i]));
+            }
+            else if (std::strcmp(argv[i], "--draws") == 0 && hasValue) {
+                benchmarkSettings._drawsPerFrame = std::max(0, std::stoi(argv[++i]));
+            }
+            else if (std::strcmp(argv[i], "--uniforms") == 0 && hasValue) {
+                benchmarkSettings._uniformsPerDraw = std::max(0, std::stoi(argv[++i]));
+            }
+            else if (std::strcmp(argv[i], "--frames") == 0 && hasValue) {
+                benchmarkSettings._frameCount = std::max(1, std::stoi(argv[++i]));
+            }
+            else {
+                std::cerr << "Unknown or incomplete argument: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        catch (const std::logic_error&) {
+            std::cerr << "Invalid value for " << argv[i - 1] << ": " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    if (!traceFile.empty()) {
+        #ifndef GLSL_INCLUDE_TRACING
+            std::cerr << "Tracing is not compiled in, configure with -DGLSL_INCLUDE_ENABLE_TRACING=ON." << std::endl;
+        #endif
+        GLSL::Trace::Enable();
+    }
+
+    // Returns false if a report could not be written.
+    auto writeReports = [&]() {
+        bool written = true;
+
+        GLSL::Counters::StopPeriodicDump();
+        if (!traceFile.empty()) {
+            try {
+                GLSL::Trace::WriteChromeTrace(traceFile);
+            }
+            catch (std::runtime_error& exception) {
+                std::cerr << exception.what() << std::endl;
+                written = false;
+            }
+        }
+        if (!buildReportFile.empty()) {
+            try {
+                GLSL::BuildReport::Write(buildReportFile);
+            }
+            catch (std::runtime_error& exception) {
+                std::cerr << exception.what() << std::endl;
+                written = false;
+            }
+        }
+        if (driverMessages) {
+            std::cout << "Driver messages per shader:" << std::endl;
+            for (const GLSL::DriverMessages::MessageStatistics& statistics : GLSL::DriverMessages::GetStatistics()) {
+                std::cout << "    " << (statistics._shaderName.empty() ? "(no shader)" : statistics._shaderName) << ", "
+                          << GLSL::DriverMessages::GetTypeName(statistics._type) << " " << statistics._id << " x" << statistics._count << ": "
+                          << statistics._message << std::endl;
+            }
+        }
+
+        return written;
+    };
+
+    // The interactive demo needs a window system.
+    if (useEGL && !benchmark) {
+        std::cerr << "--egl requires --benchmark." << std::endl;
+        return 1;
+    }
 
-    // Failed to initialize GLFW.
-    if (!initializationCode) {
+    // Initialize GLFW.
+    if (!GLSL::InitializeGLFW(useEGL)) {
         std::cerr << "Failed to initialize GLFW." << std::endl;
         return 1;
     }
@@ -25,6 +176,15 @@ int main() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+    // Benchmark renders offscreen, the window only provides the context.
+    if (benchmark) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    }
+    // Some drivers only report performance messages in debug contexts.
+    if (driverMessages) {
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+    }
+
     GLFWwindow* window = glfwCreateWindow(1920, 1080, "OpenGL 4.6", nullptr, nullptr);
 
     // Failed to create GLFW window.
@@ -33,13 +193,31 @@ int main() {
         return 1;
     }
 
-    // Initialize OpenGL.
+    // Initialize OpenGL. Entry points are resolved on first use.
     glfwMakeContextCurrent(window);
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+    if (!gladLoadGLLoaderLazy((GLADloadproc)glfwGetProcAddress)) {
         std::cerr << "Failed to initialize Glad (OpenGL)." << std::endl;
         return 1;
     }
 
+    if (!countersFile.empty()) {
+        GLSL::Counters::StartPeriodicDump(countersFile, std::chrono::seconds(1));
+    }
+    if (driverMessages) {
+        GLSL::DriverMessages::Enable();
+    }
+
+    if (benchmark) {
+        int exitCode = GLSL::RunStressBenchmark(benchmarkSettings, startTime);
+        if (!writeReports()) {
+            exitCode = 1;
+        }
+
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return exitCode;
+    }
+
     // OpenGL properties.
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
@@ -49,13 +227,33 @@ int main() {
     GLSL::Shader* singleColorShader;
 
     try {
-        singleColorShader = new GLSL::Shader("SingleColor", { "assets/shaders/color.vert", "assets/shaders/color.frag" });
+        #ifdef GLSL_INCLUDE_EMBEDDED_SHADERS
+            singleColorShader = new GLSL::Shader("SingleColor", { DemoShaders::color_vert, DemoShaders::color_frag });
+        #else
+            singleColorShader = new GLSL::Shader("SingleColor", { "assets/shaders/color.vert", "assets/shaders/color.frag" });
+        #endif
+
+        // Render state is set up, so the driver can finish compiling now instead of stalling the first frame.
+        singleColorShader->Prewarm();
     }
     catch (std::runtime_error& exception) {
         std::cerr << exception.what() << std::endl;
+        writeReports();
         return 1;
     }
 
+    std::unique_ptr<GLSL::LiveEditServer> liveEditServer;
+    if (liveEditPort >= 0) {
+        try {
+            liveEditServer = std::make_unique<GLSL::LiveEditServer>(static_cast<unsigned short>(liveEditPort));
+            liveEditServer->Register(*singleColorShader);
+            std::cout << "Live edit server listening on 127.0.0.1:" << liveEditServer->GetPort() << std::endl;
+        }
+        catch (std::runtime_error& exception) {
+            std::cerr << exception.what() << std::endl;
+        }
+    }
+
     // Camera properties.
     glm::vec3 cameraEyePosition(0.0f, 2.0f, 4.0f);
     glm::vec3 upVector(0.0f, 1.0f, 0.0f);
@@ -129,6 +327,11 @@ int main() {
         glClearColor(0.0f, 20.0f / 255.0f, 40.0f / 255.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        // Apply shader edits before rendering with the shader.
+        if (liveEditServer) {
+            liveEditServer->Poll();
+        }
+
         // dt calculations.
         currentFrameTime = (float)glfwGetTime();
         dt = currentFrameTime - previousFrameTime;
@@ -139,11 +342,9 @@ int main() {
         glm::mat4 rotation = glm::rotate(glm::radians(rotationAngle), glm::vec3(0.0f, 1.0f, 0.0f));
         glm::mat4 modelMatrix = translation * rotation * scale;
 
-        // Pass shader uniforms.
+        // Pass shader uniforms, only the model transform changes between frames.
         singleColorShader->Bind();
-        singleColorShader->SetUniform("modelTransform", modelMatrix);
-        singleColorShader->SetUniform("cameraTransform", cameraMatrix);
-        singleColorShader->SetUniform("surfaceColor", glm::vec3(1.0f, 0.45f, 0.0f));
+        singleColorShader->SetParams(SingleColorParams { modelMatrix, cameraMatrix, glm::vec3(1.0f, 0.45f, 0.0f) }, true);
 
         // Render cube.
         glBindVertexArray(vao);
@@ -163,5 +364,5 @@ int main() {
 
     glfwDestroyWindow(window);
 
-    return 0;
+    return writeReports() ? 0 : 1;
 }
@@ -0,0 +1,351 @@
+
+#include <per_draw_uniforms.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace GLSL {
+
+    namespace {
+
+        struct UniformDeclaration {
+            std::string _type;
+            std::string _name;
+        };
+
+        std::vector<std::string> SplitLines(const std::string& source) {
+            std::vector<std::string> lines;
+            std::stringstream sourceStream(source);
+            std::string line;
+
+            while (std::getline(sourceStream, line)) {
+                lines.emplace_back(line);
+            }
+
+            return lines;
+        }
+
+        bool IsMarker(const std::string& line) {
+            std::stringstream lineStream(line);
+            std::string directive, argument;
+            lineStream >> directive >> argument;
+
+            return directive == "#pragma" && argument == "per_draw";
+        }
+
+        // Parses "uniform <type> <name>;". Returns false for anything else.
+        bool ParseDeclaration(const std::string& line, UniformDeclaration& declaration) {
+            std::stringstream lineStream(line);
+            std::string qualifier, type, name, rest;
+            lineStream >> qualifier >> type >> name;
+
+            if (qualifier != "uniform" || type.empty() || name.empty()) {
+                return false;
+            }
+
+            // Semicolon may be attached to the name or follow it.
+            if (name.back() == ';') {
+                name.pop_back();
+            }
+            else if (!(lineStream >> rest) || rest != ";") {
+                return false;
+            }
+            if (lineStream >> rest || name.empty()) {
+                return false;
+            }
+
+            declaration._type = type;
+            declaration._name = name;
+            return true;
+        }
+
+        // Returns the declarations marked with #pragma per_draw in source, in order.
+        std::vector<UniformDeclaration> CollectDeclarations(const std::string& filepath, const std::vector<std::string>& lines) {
+            std::vector<UniformDeclaration> declarations;
+
+            for (std::size_t i = 0; i < lines.size(); ++i) {
+                if (!IsMarker(lines[i])) {
+                    continue;
+                }
+
+                UniformDeclaration declaration;
+                if (i + 1 >= lines.size() || !ParseDeclaration(lines[i + 1], declaration)) {
+                    throw std::runtime_error("In file '" + filepath + "': #pragma per_draw must be followed by a uniform declaration (uniform <type> <name>;).");
+                }
+                if (PerDrawUniforms::GetTypeSize(declaration._type) == 0) {
+                    throw std::runtime_error("In file '" + filepath + "': per-draw uniform '" + declaration._name + "' has unsupported type '" + declaration._type +
+                                             "'. Supported types are int, bool, float, vec2, vec3, vec4, mat3 and mat4.");
+                }
+
+                declarations.emplace_back(std::move(declaration));
+            }
+
+            return declarations;
+        }
+
+        // Returns the index of the line the prelude follows: the last of the #extension directives leading the source
+        // (outside of conditional blocks, or the block containing it), or the #version directive if there are none.
+        // #extension must precede all other code. Returns lines.size() if there is no #version directive.
+        std::size_t FindPreludePosition(const std::vector<std::string>& lines) {
+            std::size_t position = lines.size();
+            int conditionalDepth = 0;
+            bool pendingExtension = false;
+
+            for (std::size_t i = 0; i < lines.size(); ++i) {
+                std::stringstream lineStream(lines[i]);
+                std::string directive;
+                if (!(lineStream >> directive)) {
+                    continue;
+                }
+
+                if (position == lines.size()) {
+                    if (directive == "#version") {
+                        position = i;
+                    }
+                    continue;
+                }
+
+                // Leading directives end with the first line of code.
+                if (directive.front() != '#') {
+                    break;
+                }
+
+                if (directive == "#if" || directive == "#ifdef" || directive == "#ifndef") {
+                    ++conditionalDepth;
+                }
+                else if (directive == "#endif") {
+                    --conditionalDepth;
+                }
+                else if (directive == "#extension") {
+                    pendingExtension = true;
+                }
+
+                if (pendingExtension && conditionalDepth == 0) {
+                    position = i;
+                    pendingExtension = false;
+                }
+            }
+
+            return position;
+        }
+
+        std::string CreatePrelude(GLenum shaderType, const PerDrawLayout& layout) {
+            std::stringstream prelude;
+
+            if (shaderType == GL_VERTEX_SHADER) {
+                prelude << "#extension GL_ARB_shader_draw_parameters : enable\n";
+            }
+
+            prelude << "struct GLSLPerDraw {\n";
+            for (const PerDrawLayout::Member& member : layout._members) {
+                // Buffers cannot hold bool, it is stored as uint and converted on access.
+                prelude << "    " << (member._type == "bool" ? "uint" : member._type) << " " << member._name << ";\n";
+            }
+            prelude << "};\n";
+            prelude << "layout(std430, binding = " << PerDrawUniforms::BufferBinding << ") readonly buffer GLSLPerDrawBuffer {\n";
+            prelude << "    GLSLPerDraw glslPerDraw[];\n";
+            prelude << "};\n";
+
+            std::string drawIndex;
+            if (shaderType == GL_VERTEX_SHADER) {
+                // The draw ID is only used when submitted with a multi-draw (see DrawBatcher).
+                prelude << "#if __VERSION__ >= 460\n";
+                prelude << "#define GLSL_DRAW_ID gl_DrawID\n";
+                prelude << "#elif defined(GL_ARB_shader_draw_parameters)\n";
+                prelude << "#define GLSL_DRAW_ID gl_DrawIDARB\n";
+                prelude << "#else\n";
+                prelude << "#define GLSL_DRAW_ID 0\n";
+                prelude << "#endif\n";
+                prelude << "uniform int glslDrawOffset;\n";
+                prelude << "flat out int glslDrawIndex;\n";
+                prelude << "#define main glslPerDrawMain\n";
+                drawIndex = "glslDrawOffset + GLSL_DRAW_ID + gl_InstanceID";
+            }
+            else {
+                prelude << "flat in int glslDrawIndex;\n";
+                drawIndex = "glslDrawIndex";
+            }
+
+            for (const PerDrawLayout::Member& member : layout._members) {
+                std::string access = "glslPerDraw[" + drawIndex + "]." + member._name;
+                prelude << "#define " << member._name << " " << (member._type == "bool" ? "bool(" + access + ")" : access) << "\n";
+            }
+
+            return prelude.str();
+        }
+
+        std::string Rewrite(const std::string& filepath, const std::vector<std::string>& lines, GLenum shaderType, const PerDrawLayout* layout) {
+            std::stringstream output;
+            std::size_t preludePosition = layout ? FindPreludePosition(lines) : lines.size();
+
+            for (std::size_t i = 0; i < lines.size(); ++i) {
+                const std::string& line = lines[i];
+                if (IsMarker(line)) {
+                    continue;
+                }
+
+                UniformDeclaration declaration;
+                if (layout && ParseDeclaration(line, declaration)) {
+                    const PerDrawLayout::Member* member = layout->Find(declaration._name);
+
+                    // Declarations of per-draw uniforms in other components are replaced as well, even if unmarked.
+                    if (member) {
+                        if (member->_type != declaration._type) {
+                            throw std::runtime_error("In file '" + filepath + "': uniform '" + declaration._name + "' is declared as '" + declaration._type +
+                                                     "', but as per-draw uniform of type '" + member->_type + "'.");
+                        }
+
+                        continue;
+                    }
+                }
+
+                output << line << '\n';
+
+                if (i == preludePosition) {
+                    output << CreatePrelude(shaderType, *layout);
+                }
+            }
+
+            // Wrap main to hand the draw index to the following stages.
+            if (layout && shaderType == GL_VERTEX_SHADER) {
+                output << "#undef main\n";
+                output << "void main() {\n";
+                output << "    glslDrawIndex = glslDrawOffset + GLSL_DRAW_ID + gl_InstanceID;\n";
+                output << "    glslPerDrawMain();\n";
+                output << "}\n";
+            }
+
+            return output.str();
+        }
+
+    }
+
+    bool PerDrawLayout::IsEmpty() const {
+        return _members.empty();
+    }
+
+    const PerDrawLayout::Member* PerDrawLayout::Find(const std::string& name) const {
+        for (const Member& member : _members) {
+            if (member._name == name) {
+                return &member;
+            }
+        }
+
+        return nullptr;
+    }
+
+    std::size_t PerDrawUniforms::GetTypeSize(const std::string& type) {
+        if (type == "int" || type == "bool" || type == "float") {
+            return 4;
+        }
+        if (type == "vec2") {
+            return 8;
+        }
+        if (type == "vec3") {
+            return 12;
+        }
+        if (type == "vec4") {
+            return 16;
+        }
+        // Matrix columns are aligned like vec4.
+        if (type == "mat3") {
+            return 48;
+        }
+        if (type == "mat4") {
+            return 64;
+        }
+
+        return 0;
+    }
+
+    std::size_t PerDrawUniforms::GetTypeAlignment(const std::string& type) {
+        if (type == "int" || type == "bool" || type == "float") {
+            return 4;
+        }
+        if (type == "vec2") {
+            return 8;
+        }
+        if (type == "vec3" || type == "vec4" || type == "mat3" || type == "mat4") {
+            return 16;
+        }
+
+        return 0;
+    }
+
+    PerDrawLayout PerDrawUniforms::Apply(std::unordered_map<std::string, std::pair<GLenum, std::string>>& shaderComponents, bool enabled) {
+        // Components in a fixed order, so the layout (and the rewritten sources) do not depend on hashing.
+        std::vector<std::string> filepaths;
+        for (const auto& shaderComponent : shaderComponents) {
+            filepaths.emplace_back(shaderComponent.first);
+        }
+        std::sort(filepaths.begin(), filepaths.end());
+
+        std::unordered_map<std::string, std::vector<std::string>> componentLines;
+        std::vector<UniformDeclaration> declarations;
+        bool hasMarkers = false;
+
+        for (const std::string& filepath : filepaths) {
+            std::vector<std::string>& lines = componentLines[filepath] = SplitLines(shaderComponents[filepath].second);
+
+            for (UniformDeclaration& declaration : CollectDeclarations(filepath, lines)) {
+                hasMarkers = true;
+
+                auto declarationIt = std::find_if(declarations.begin(), declarations.end(), [&](const UniformDeclaration& existing) {
+                    return existing._name == declaration._name;
+                });
+
+                if (declarationIt == declarations.end()) {
+                    declarations.emplace_back(std::move(declaration));
+                }
+                else if (declarationIt->_type != declaration._type) {
+                    throw std::runtime_error("In file '" + filepath + "': per-draw uniform '" + declaration._name + "' is declared with different types ('" +
+                                             declarationIt->_type + "' and '" + declaration._type + "').");
+                }
+            }
+        }
+
+        PerDrawLayout layout;
+        if (!hasMarkers) {
+            return layout;
+        }
+
+        if (enabled) {
+            bool hasVertexStage = false;
+            for (const auto& shaderComponent : shaderComponents) {
+                GLenum shaderType = shaderComponent.second.first;
+                hasVertexStage |= shaderType == GL_VERTEX_SHADER;
+
+                if (shaderType != GL_VERTEX_SHADER && shaderType != GL_FRAGMENT_SHADER) {
+                    throw std::runtime_error("Per-draw uniforms are only supported in programs of vertex and fragment shaders (" + shaderComponent.first + ").");
+                }
+            }
+            if (!hasVertexStage) {
+                throw std::runtime_error("Per-draw uniforms require a vertex shader to compute the draw index.");
+            }
+
+            // std430: members aligned to their base alignment, element stride rounded to the largest alignment.
+            std::size_t structAlignment = 4;
+            for (const UniformDeclaration& declaration : declarations) {
+                std::size_t alignment = GetTypeAlignment(declaration._type);
+                structAlignment = std::max(structAlignment, alignment);
+
+                PerDrawLayout::Member& member = layout._members.emplace_back();
+                member._name = declaration._name;
+                member._type = declaration._type;
+                member._offset = (layout._stride + alignment - 1) / alignment * alignment;
+
+                layout._stride = member._offset + GetTypeSize(declaration._type);
+            }
+            layout._stride = (layout._stride + structAlignment - 1) / structAlignment * structAlignment;
+        }
+
+        for (const std::string& filepath : filepaths) {
+            std::pair<GLenum, std::string>& shaderComponent = shaderComponents[filepath];
+            shaderComponent.second = Rewrite(filepath, componentLines[filepath], shaderComponent.first, enabled ? &layout : nullptr);
+        }
+
+        return layout;
+    }
+
+}
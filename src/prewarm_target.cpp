@@ -0,0 +1,176 @@
+
+#include <prewarm_target.h>
+#include <counters.h>
+#include <gl_dispatch.h>
+#include <per_draw_uniforms.h>
+#include <shader.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace GLSL {
+
+    namespace {
+
+        // Vertex input format of an attribute type. Matrices take one location per column.
+        struct AttributeFormat {
+            GLint _components = 0; // 0 for types that cannot be fed here (doubles).
+            GLint _locations = 1;
+            GLenum _type = GL_FLOAT;
+            bool _isInteger = false;
+        };
+
+        AttributeFormat GetAttributeFormat(GLenum type) {
+            switch (type) {
+                case GL_FLOAT:             return { 1, 1, GL_FLOAT, false };
+                case GL_FLOAT_VEC2:        return { 2, 1, GL_FLOAT, false };
+                case GL_FLOAT_VEC3:        return { 3, 1, GL_FLOAT, false };
+                case GL_FLOAT_VEC4:        return { 4, 1, GL_FLOAT, false };
+                case GL_FLOAT_MAT2:        return { 2, 2, GL_FLOAT, false };
+                case GL_FLOAT_MAT3:        return { 3, 3, GL_FLOAT, false };
+                case GL_FLOAT_MAT4:        return { 4, 4, GL_FLOAT, false };
+                case GL_FLOAT_MAT2x3:      return { 3, 2, GL_FLOAT, false };
+                case GL_FLOAT_MAT2x4:      return { 4, 2, GL_FLOAT, false };
+                case GL_FLOAT_MAT3x2:      return { 2, 3, GL_FLOAT, false };
+                case GL_FLOAT_MAT3x4:      return { 4, 3, GL_FLOAT, false };
+                case GL_FLOAT_MAT4x2:      return { 2, 4, GL_FLOAT, false };
+                case GL_FLOAT_MAT4x3:      return { 3, 4, GL_FLOAT, false };
+                case GL_INT:               return { 1, 1, GL_INT, true };
+                case GL_INT_VEC2:          return { 2, 1, GL_INT, true };
+                case GL_INT_VEC3:          return { 3, 1, GL_INT, true };
+                case GL_INT_VEC4:          return { 4, 1, GL_INT, true };
+                case GL_UNSIGNED_INT:      return { 1, 1, GL_UNSIGNED_INT, true };
+                case GL_UNSIGNED_INT_VEC2: return { 2, 1, GL_UNSIGNED_INT, true };
+                case GL_UNSIGNED_INT_VEC3: return { 3, 1, GL_UNSIGNED_INT, true };
+                case GL_UNSIGNED_INT_VEC4: return { 4, 1, GL_UNSIGNED_INT, true };
+                default:                   return { 0, 1, GL_FLOAT, false };
+            }
+        }
+
+        // Largest vertex count of a pre-warm draw (see GetVertexCount), times the largest attribute (vec4).
+        constexpr GLsizeiptr minimumZeroBufferSize = 32 * 4 * sizeof(float);
+
+        GLsizei GetVertexCount(GLenum mode) {
+            if (mode != GL_PATCHES) {
+                return 3;
+            }
+
+            GLint patchVertices = 3;
+            GL().GetIntegerv(GL_PATCH_VERTICES, &patchVertices);
+            return static_cast<GLsizei>(std::clamp(patchVertices, 1, 32));
+        }
+
+    }
+
+    PrewarmTarget::PrewarmTarget() : _framebuffer(0),
+                                     _colorRenderbuffer(0),
+                                     _depthStencilRenderbuffer(0),
+                                     _zeroBuffer(0),
+                                     _zeroBufferSize(0),
+                                     _previousFramebuffer(0),
+                                     _previousRenderbuffer(0),
+                                     _previousVertexArray(0),
+                                     _previousArrayBuffer(0),
+                                     _previousProgram(0),
+                                     _previousViewport() {
+        GL().GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_previousFramebuffer);
+        GL().GetIntegerv(GL_RENDERBUFFER_BINDING, &_previousRenderbuffer);
+        GL().GetIntegerv(GL_VERTEX_ARRAY_BINDING, &_previousVertexArray);
+        GL().GetIntegerv(GL_ARRAY_BUFFER_BINDING, &_previousArrayBuffer);
+        GL().GetIntegerv(GL_CURRENT_PROGRAM, &_previousProgram);
+        GL().GetIntegerv(GL_VIEWPORT, _previousViewport);
+
+        GLuint renderbuffers[2] = { 0, 0 };
+        GL().GenRenderbuffers(2, renderbuffers);
+        _colorRenderbuffer = renderbuffers[0];
+        _depthStencilRenderbuffer = renderbuffers[1];
+
+        GL().BindRenderbuffer(GL_RENDERBUFFER, _colorRenderbuffer);
+        GL().RenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 1, 1);
+        GL().BindRenderbuffer(GL_RENDERBUFFER, _depthStencilRenderbuffer);
+        GL().RenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, 1, 1);
+
+        GL().GenFramebuffers(1, &_framebuffer);
+        GL().BindFramebuffer(GL_DRAW_FRAMEBUFFER, _framebuffer);
+        GL().FramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _colorRenderbuffer);
+        GL().FramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depthStencilRenderbuffer);
+        GL().Viewport(0, 0, 1, 1);
+
+        ReserveZeroBuffer(minimumZeroBufferSize);
+    }
+
+    PrewarmTarget::~PrewarmTarget() {
+        GL().BindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(_previousFramebuffer));
+        GL().BindRenderbuffer(GL_RENDERBUFFER, static_cast<GLuint>(_previousRenderbuffer));
+        GL().BindVertexArray(static_cast<GLuint>(_previousVertexArray));
+        GL().BindBuffer(GL_ARRAY_BUFFER, static_cast<GLuint>(_previousArrayBuffer));
+        GL().UseProgram(static_cast<GLuint>(_previousProgram));
+        GL().Viewport(_previousViewport[0], _previousViewport[1], _previousViewport[2], _previousViewport[3]);
+
+        GL().DeleteFramebuffers(1, &_framebuffer);
+        GLuint renderbuffers[2] = { _colorRenderbuffer, _depthStencilRenderbuffer };
+        GL().DeleteRenderbuffers(2, renderbuffers);
+        GL().DeleteBuffers(1, &_zeroBuffer);
+    }
+
+    void PrewarmTarget::Draw(const Shader& shader, GLenum mode) {
+        const PerDrawLayout& perDrawLayout = shader.GetPerDrawLayout();
+        ReserveZeroBuffer(static_cast<GLsizeiptr>(perDrawLayout._stride));
+
+        // Fresh vertex array, so that only the attributes of this shader are enabled.
+        GLuint vertexArray = 0;
+        GL().GenVertexArrays(1, &vertexArray);
+        GL().BindVertexArray(vertexArray);
+
+        for (const VertexAttribute& attribute : shader.GetVertexAttributes()) {
+            AttributeFormat format = GetAttributeFormat(attribute._type);
+            if (format._components == 0 || attribute._location < 0) {
+                continue;
+            }
+
+            GLint locationCount = format._locations * attribute._size;
+            for (GLint i = 0; i < locationCount; ++i) {
+                GLuint location = static_cast<GLuint>(attribute._location + i);
+                GL().EnableVertexAttribArray(location);
+
+                if (format._isInteger) {
+                    GL().VertexAttribIPointer(location, format._components, format._type, 0, nullptr);
+                }
+                else {
+                    GL().VertexAttribPointer(location, format._components, format._type, GL_FALSE, 0, nullptr);
+                }
+            }
+        }
+
+        if (!perDrawLayout.IsEmpty()) {
+            GL().BindBufferBase(GL_SHADER_STORAGE_BUFFER, PerDrawUniforms::BufferBinding, _zeroBuffer);
+        }
+
+        shader.Bind();
+        GL().DrawArrays(mode, 0, GetVertexCount(mode));
+        shader.Unbind();
+        Counters::Increment(Counters::Counter::PrewarmDraws);
+
+        if (!perDrawLayout.IsEmpty()) {
+            GL().BindBufferBase(GL_SHADER_STORAGE_BUFFER, PerDrawUniforms::BufferBinding, 0);
+        }
+
+        GL().BindVertexArray(0);
+        GL().DeleteVertexArrays(1, &vertexArray);
+    }
+
+    void PrewarmTarget::ReserveZeroBuffer(GLsizeiptr size) {
+        if (_zeroBuffer == 0) {
+            GL().GenBuffers(1, &_zeroBuffer);
+        }
+        GL().BindBuffer(GL_ARRAY_BUFFER, _zeroBuffer);
+
+        if (size > _zeroBufferSize) {
+            std::vector<std::uint8_t> zeros(static_cast<std::size_t>(size), 0);
+            GL().BufferData(GL_ARRAY_BUFFER, size, zeros.data(), GL_STATIC_DRAW);
+            _zeroBufferSize = size;
+        }
+    }
+
+}
@@ -0,0 +1,203 @@
+
+#include <program_binary_cache.h>
+#include <embedded.h>
+#include <gl_dispatch.h>
+#include <lexer.h>
+#include <shared_cache.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace GLSL {
+
+    namespace {
+
+        // Entry layout: magic, binary format, binary length, binary. Identical on disk and in the shared cache.
+        const char entryMagic[8] = { 'G', 'L', 'S', 'L', 'P', 'B', '0', '1' };
+        const std::size_t entryHeaderSize = sizeof(entryMagic) + 2 * sizeof(std::uint32_t);
+
+        // Shared cache keys are prefixed by the kind of entry.
+        const std::string remoteKeyPrefix = "program-";
+
+        std::vector<char> SerializeEntry(const ProgramBinaryCache::ProgramBinary& programBinary) {
+            std::uint32_t format = programBinary._format;
+            std::uint32_t length = static_cast<std::uint32_t>(programBinary._data.size());
+
+            std::vector<char> entry(entryHeaderSize + length);
+            std::memcpy(entry.data(), entryMagic, sizeof(entryMagic));
+            std::memcpy(entry.data() + sizeof(entryMagic), &format, sizeof(format));
+            std::memcpy(entry.data() + sizeof(entryMagic) + sizeof(format), &length, sizeof(length));
+            std::copy(programBinary._data.begin(), programBinary._data.end(), entry.begin() + entryHeaderSize);
+            return entry;
+        }
+
+        bool DeserializeEntry(const std::vector<char>& entry, ProgramBinaryCache::ProgramBinary& programBinary) {
+            if (entry.size() < entryHeaderSize || std::memcmp(entry.data(), entryMagic, sizeof(entryMagic)) != 0) {
+                return false;
+            }
+
+            std::uint32_t format = 0;
+            std::uint32_t length = 0;
+            std::memcpy(&format, entry.data() + sizeof(entryMagic), sizeof(format));
+            std::memcpy(&length, entry.data() + sizeof(entryMagic) + sizeof(format), sizeof(length));
+
+            if (entry.size() - entryHeaderSize != length) {
+                return false;
+            }
+
+            programBinary._format = format;
+            programBinary._data.assign(entry.begin() + entryHeaderSize, entry.end());
+            return true;
+        }
+
+        std::string GetGLString(GLenum name) {
+            const GLubyte* string = GL().GetString(name);
+            return string ? reinterpret_cast<const char*>(string) : "";
+        }
+
+    }
+
+    ProgramBinaryCache::ProgramBinaryCache(std::string directory, const std::string& remoteAddress) : _directory(std::move(directory)) {
+        if (!_directory.empty()) {
+            std::filesystem::create_directories(_directory);
+
+            if (!remoteAddress.empty()) {
+                _remote = std::make_shared<SharedCacheClient>(remoteAddress);
+            }
+        }
+    }
+
+    bool ProgramBinaryCache::IsEnabled() const {
+        return !_directory.empty();
+    }
+
+    const std::string& ProgramBinaryCache::GetDirectory() const {
+        return _directory;
+    }
+
+    std::string ProgramBinaryCache::GetRemoteAddress() const {
+        return _remote ? _remote->GetAddress() : "";
+    }
+
+    std::string ProgramBinaryCache::GetKey(const std::unordered_map<std::string, std::pair<GLenum, std::string>>& shaderComponents) {
+        // Component paths do not matter, only the tokens handed to the driver: comments and formatting do not change
+        // the compiled program. Sort for a stable order.
+        std::vector<std::pair<GLenum, std::string>> components;
+        for (const auto& shaderComponent : shaderComponents) {
+            components.emplace_back(shaderComponent.second.first, Lexer::Canonicalize(shaderComponent.second.second));
+        }
+        std::sort(components.begin(), components.end());
+
+        std::string keySource = GetDriverIdentity();
+        for (const std::pair<GLenum, std::string>& component : components) {
+            keySource += '\0' + std::to_string(component.first) + '\0' + component.second;
+        }
+
+        std::stringstream key;
+        key << std::hex << std::setw(16) << std::setfill('0') << HashShaderSource(keySource);
+        return key.str();
+    }
+
+    const std::string& ProgramBinaryCache::GetDriverIdentity() {
+        static const std::string driverIdentity = GetGLString(GL_VENDOR) + '\n' + GetGLString(GL_RENDERER) + '\n' + GetGLString(GL_VERSION);
+        return driverIdentity;
+    }
+
+    bool ProgramBinaryCache::Contains(const std::string& key) const {
+        std::error_code error;
+        return IsEnabled() && std::filesystem::is_regular_file(GetEntryPath(key), error);
+    }
+
+    bool ProgramBinaryCache::Load(const std::string& key, ProgramBinary& programBinary) const {
+        if (!IsEnabled()) {
+            return false;
+        }
+
+        std::vector<char> entry;
+        std::ifstream inputStream(GetEntryPath(key), std::ios::binary);
+
+        if (inputStream.is_open()) {
+            entry.assign(std::istreambuf_iterator<char>(inputStream), std::istreambuf_iterator<char>());
+            return DeserializeEntry(entry, programBinary);
+        }
+
+        if (!_remote || !_remote->Get(remoteKeyPrefix + key, entry) || !DeserializeEntry(entry, programBinary)) {
+            return false;
+        }
+
+        // Keep a local copy for the next build. The entry is usable either way.
+        try {
+            WriteEntry(key, entry);
+        }
+        catch (const std::exception&) {
+        }
+
+        return true;
+    }
+
+    void ProgramBinaryCache::Store(const std::string& key, const ProgramBinary& programBinary) const {
+        if (!IsEnabled()) {
+            return;
+        }
+
+        std::vector<char> entry = SerializeEntry(programBinary);
+        WriteEntry(key, entry);
+
+        if (_remote) {
+            _remote->Put(remoteKeyPrefix + key, entry);
+        }
+    }
+
+    std::size_t ProgramBinaryCache::Merge(const ProgramBinaryCache& source) const {
+        std::size_t merged = 0;
+
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(source.GetDirectory())) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".bin") {
+                continue;
+            }
+
+            std::filesystem::path destination = std::filesystem::path(_directory) / entry.path().filename();
+            if (std::filesystem::exists(destination)) {
+                continue;
+            }
+
+            std::filesystem::rename(entry.path(), destination);
+            ++merged;
+        }
+
+        return merged;
+    }
+
+    std::string ProgramBinaryCache::GetEntryPath(const std::string& key) const {
+        return (std::filesystem::path(_directory) / (key + ".bin")).string();
+    }
+
+    void ProgramBinaryCache::WriteEntry(const std::string& key, const std::vector<char>& entry) const {
+        // Unique per process and thread, renamed into place once complete.
+        std::stringstream temporaryPath;
+        temporaryPath << GetEntryPath(key) << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id())
+                      << '.' << std::chrono::steady_clock::now().time_since_epoch().count();
+
+        {
+            std::ofstream outputStream(temporaryPath.str(), std::ios::binary);
+            if (!outputStream.is_open()) {
+                throw std::runtime_error("Could not write program binary cache entry: '" + temporaryPath.str() + "'");
+            }
+
+            outputStream.write(entry.data(), static_cast<std::streamsize>(entry.size()));
+        }
+
+        std::filesystem::rename(temporaryPath.str(), GetEntryPath(key));
+    }
+
+}
@@ -0,0 +1,839 @@
+
+#include <recording_gl.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace GLSL {
+
+    // Static initialization.
+    RecordingGL* RecordingGL::_current = nullptr;
+
+    namespace {
+
+        const char simulatedCompileError[] = "Simulated compilation failure.";
+        const char simulatedLinkError[] = "Simulated link failure.";
+        const GLenum mockBinaryFormat = 0x4D4F434B; // 'MOCK'.
+
+        void CopyInfoLog(const char* message, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+            GLsizei messageLength = static_cast<GLsizei>(std::strlen(message));
+            GLsizei copyLength = bufSize > 0 ? std::min(messageLength, bufSize - 1) : 0;
+
+            if (infoLog && bufSize > 0) {
+                std::memcpy(infoLog, message, copyLength);
+                infoLog[copyLength] = '\0';
+            }
+            if (length) {
+                *length = copyLength;
+            }
+        }
+
+    }
+
+    RecordingGL::RecordingGL() : _forwarding(false),
+                                 _forwardDispatch(),
+                                 _previousDispatch(),
+                                 _installed(false),
+                                 _callCounts(),
+                                 _captureUniforms(true),
+                                 _compileLatency(0),
+                                 _linkLatency(0),
+                                 _compileFailure(false),
+                                 _linkFailure(false),
+                                 _nextObjectID(1),
+                                 _boundProgram(0),
+                                 _debugCallback(nullptr),
+                                 _debugCallbackUserParam(nullptr) {
+    }
+
+    RecordingGL::RecordingGL(const GLDispatch& forwardDispatch) : RecordingGL() {
+        _forwarding = true;
+        _forwardDispatch = forwardDispatch;
+    }
+
+    RecordingGL::~RecordingGL() {
+        Uninstall();
+    }
+
+    void RecordingGL::Install() {
+        if (_installed) {
+            return;
+        }
+
+        if (_current) {
+            throw std::runtime_error("Another RecordingGL instance is already installed.");
+        }
+
+        _current = this;
+        _previousDispatch = GL();
+        _installed = true;
+        SetGLDispatch(CreateDispatch());
+    }
+
+    void RecordingGL::Uninstall() {
+        if (!_installed) {
+            return;
+        }
+
+        SetGLDispatch(_previousDispatch);
+        _current = nullptr;
+        _installed = false;
+    }
+
+    void RecordingGL::SetCompileLatency(std::chrono::microseconds compileLatency) {
+        _compileLatency = compileLatency;
+    }
+
+    void RecordingGL::SetLinkLatency(std::chrono::microseconds linkLatency) {
+        _linkLatency = linkLatency;
+    }
+
+    void RecordingGL::SetCompileFailure(bool fail) {
+        _compileFailure = fail;
+    }
+
+    void RecordingGL::SetLinkFailure(bool fail) {
+        _linkFailure = fail;
+    }
+
+    void RecordingGL::InjectDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, const std::string& message) {
+        if (_debugCallback) {
+            _debugCallback(source, type, id, severity, static_cast<GLsizei>(message.size()), message.c_str(), _debugCallbackUserParam);
+        }
+    }
+
+    void RecordingGL::SetCaptureUniforms(bool capture) {
+        _captureUniforms = capture;
+    }
+
+    std::uint64_t RecordingGL::GetCallCount(Function function) const {
+        return _callCounts[static_cast<std::size_t>(function)];
+    }
+
+    std::uint64_t RecordingGL::GetTotalCallCount() const {
+        std::uint64_t total = 0;
+
+        for (std::uint64_t callCount : _callCounts) {
+            total += callCount;
+        }
+
+        return total;
+    }
+
+    const std::vector<RecordingGL::UniformUpload>& RecordingGL::GetUniformUploads() const {
+        return _uniformUploads;
+    }
+
+    void RecordingGL::Reset() {
+        _callCounts.fill(0);
+        _uniformUploads.clear();
+    }
+
+    const char* RecordingGL::GetFunctionName(Function function) {
+        switch (function) {
+            case Function::CreateShader:                    return "glCreateShader";
+            case Function::DeleteShader:                    return "glDeleteShader";
+            case Function::ShaderSource:                    return "glShaderSource";
+            case Function::CompileShader:                   return "glCompileShader";
+            case Function::GetShaderiv:                     return "glGetShaderiv";
+            case Function::GetShaderInfoLog:                return "glGetShaderInfoLog";
+            case Function::CreateProgram:                   return "glCreateProgram";
+            case Function::DeleteProgram:                   return "glDeleteProgram";
+            case Function::AttachShader:                    return "glAttachShader";
+            case Function::DetachShader:                    return "glDetachShader";
+            case Function::LinkProgram:                     return "glLinkProgram";
+            case Function::GetProgramiv:                    return "glGetProgramiv";
+            case Function::GetProgramInfoLog:               return "glGetProgramInfoLog";
+            case Function::UseProgram:                      return "glUseProgram";
+            case Function::ProgramParameteri:               return "glProgramParameteri";
+            case Function::GetProgramBinary:                return "glGetProgramBinary";
+            case Function::ProgramBinary:                   return "glProgramBinary";
+            case Function::GetActiveAttrib:                 return "glGetActiveAttrib";
+            case Function::GetAttribLocation:               return "glGetAttribLocation";
+            case Function::GetUniformLocation:              return "glGetUniformLocation";
+            case Function::Uniform1i:                       return "glUniform1i";
+            case Function::Uniform1f:                       return "glUniform1f";
+            case Function::Uniform2fv:                      return "glUniform2fv";
+            case Function::Uniform3fv:                      return "glUniform3fv";
+            case Function::Uniform4fv:                      return "glUniform4fv";
+            case Function::UniformMatrix3fv:                return "glUniformMatrix3fv";
+            case Function::UniformMatrix4fv:                return "glUniformMatrix4fv";
+            case Function::GetString:                       return "glGetString";
+            case Function::GetIntegerv:                     return "glGetIntegerv";
+            case Function::GetStringi:                      return "glGetStringi";
+            case Function::GenQueries:                      return "glGenQueries";
+            case Function::DeleteQueries:                   return "glDeleteQueries";
+            case Function::BeginQuery:                      return "glBeginQuery";
+            case Function::EndQuery:                        return "glEndQuery";
+            case Function::GetQueryObjectiv:                return "glGetQueryObjectiv";
+            case Function::GetQueryObjectui64v:             return "glGetQueryObjectui64v";
+            case Function::GenBuffers:                      return "glGenBuffers";
+            case Function::DeleteBuffers:                   return "glDeleteBuffers";
+            case Function::BindBuffer:                      return "glBindBuffer";
+            case Function::BufferData:                      return "glBufferData";
+            case Function::BindBufferBase:                  return "glBindBufferBase";
+            case Function::DrawElementsInstancedBaseVertex: return "glDrawElementsInstancedBaseVertex";
+            case Function::MultiDrawElementsIndirect:       return "glMultiDrawElementsIndirect";
+            case Function::DrawArrays:                      return "glDrawArrays";
+            case Function::GenFramebuffers:                 return "glGenFramebuffers";
+            case Function::DeleteFramebuffers:              return "glDeleteFramebuffers";
+            case Function::BindFramebuffer:                 return "glBindFramebuffer";
+            case Function::GenRenderbuffers:                return "glGenRenderbuffers";
+            case Function::DeleteRenderbuffers:             return "glDeleteRenderbuffers";
+            case Function::BindRenderbuffer:                return "glBindRenderbuffer";
+            case Function::RenderbufferStorage:             return "glRenderbufferStorage";
+            case Function::FramebufferRenderbuffer:         return "glFramebufferRenderbuffer";
+            case Function::GenVertexArrays:                 return "glGenVertexArrays";
+            case Function::DeleteVertexArrays:              return "glDeleteVertexArrays";
+            case Function::BindVertexArray:                 return "glBindVertexArray";
+            case Function::EnableVertexAttribArray:         return "glEnableVertexAttribArray";
+            case Function::VertexAttribPointer:             return "glVertexAttribPointer";
+            case Function::VertexAttribIPointer:            return "glVertexAttribIPointer";
+            case Function::Viewport:                        return "glViewport";
+            case Function::Enable:                          return "glEnable";
+            case Function::Disable:                         return "glDisable";
+            case Function::DebugMessageCallback:            return "glDebugMessageCallback";
+            case Function::DebugMessageControl:             return "glDebugMessageControl";
+            default:                                        return "";
+        }
+    }
+
+    RecordingGL& RecordingGL::Current() {
+        return *_current;
+    }
+
+    void RecordingGL::Record(Function function) {
+        ++_callCounts[static_cast<std::size_t>(function)];
+    }
+
+    void RecordingGL::RecordUniform(GLint location, Function function, const float* data, std::size_t count) {
+        Record(function);
+
+        if (_captureUniforms) {
+            _uniformUploads.push_back({ _boundProgram, location, function, std::vector<float>(data, data + count) });
+        }
+    }
+
+    GLDispatch RecordingGL::CreateDispatch() {
+        return GLDispatch {
+            // Shader components.
+            [](GLenum type) -> GLuint {
+                RecordingGL& gl = Current();
+                gl.Record(Function::CreateShader);
+
+                if (gl._forwarding) {
+                    return gl._forwardDispatch.CreateShader(type);
+                }
+                return gl._nextObjectID++;
+            },
+            [](GLuint shader) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::DeleteShader);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.DeleteShader(shader);
+                    return;
+                }
+                gl._compileStatus.erase(shader);
+            },
+            [](GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::ShaderSource);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.ShaderSource(shader, count, string, length);
+                }
+            },
+            [](GLuint shader) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::CompileShader);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.CompileShader(shader);
+                    return;
+                }
+
+                std::this_thread::sleep_for(gl._compileLatency);
+                gl._compileStatus[shader] = gl._compileFailure ? GL_FALSE : GL_TRUE;
+            },
+            [](GLuint shader, GLenum pname, GLint* params) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetShaderiv);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GetShaderiv(shader, pname, params);
+                    return;
+                }
+
+                switch (pname) {
+                    case GL_COMPILE_STATUS:
+                        *params = gl._compileStatus[shader];
+                        break;
+                    case GL_INFO_LOG_LENGTH:
+                        *params = gl._compileStatus[shader] ? 0 : static_cast<GLint>(sizeof(simulatedCompileError));
+                        break;
+                    default:
+                        *params = 0;
+                        break;
+                }
+            },
+            [](GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetShaderInfoLog);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GetShaderInfoLog(shader, bufSize, length, infoLog);
+                    return;
+                }
+                CopyInfoLog(gl._compileStatus[shader] ? "" : simulatedCompileError, bufSize, length, infoLog);
+            },
+
+            // Shader programs.
+            []() -> GLuint {
+                RecordingGL& gl = Current();
+                gl.Record(Function::CreateProgram);
+
+                if (gl._forwarding) {
+                    return gl._forwardDispatch.CreateProgram();
+                }
+                return gl._nextObjectID++;
+            },
+            [](GLuint program) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::DeleteProgram);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.DeleteProgram(program);
+                    return;
+                }
+                gl._linkStatus.erase(program);
+                gl._uniformLocations.erase(program);
+            },
+            [](GLuint program, GLuint shader) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::AttachShader);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.AttachShader(program, shader);
+                }
+            },
+            [](GLuint program, GLuint shader) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::DetachShader);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.DetachShader(program, shader);
+                }
+            },
+            [](GLuint program) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::LinkProgram);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.LinkProgram(program);
+                    return;
+                }
+
+                std::this_thread::sleep_for(gl._linkLatency);
+                gl._linkStatus[program] = gl._linkFailure ? GL_FALSE : GL_TRUE;
+            },
+            [](GLuint program, GLenum pname, GLint* params) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetProgramiv);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GetProgramiv(program, pname, params);
+                    return;
+                }
+
+                switch (pname) {
+                    case GL_LINK_STATUS:
+                        *params = gl._linkStatus[program];
+                        break;
+                    case GL_PROGRAM_BINARY_LENGTH:
+                        *params = static_cast<GLint>(sizeof(GLuint));
+                        break;
+                    case GL_INFO_LOG_LENGTH:
+                        *params = gl._linkStatus[program] ? 0 : static_cast<GLint>(sizeof(simulatedLinkError));
+                        break;
+                    default:
+                        *params = 0;
+                        break;
+                }
+            },
+            [](GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetProgramInfoLog);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GetProgramInfoLog(program, bufSize, length, infoLog);
+                    return;
+                }
+                CopyInfoLog(gl._linkStatus[program] ? "" : simulatedLinkError, bufSize, length, infoLog);
+            },
+            [](GLuint program) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::UseProgram);
+                gl._boundProgram = program;
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.UseProgram(program);
+                }
+            },
+            [](GLuint program, GLenum pname, GLint value) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::ProgramParameteri);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.ProgramParameteri(program, pname, value);
+                }
+            },
+            [](GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetProgramBinary);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GetProgramBinary(program, bufSize, length, binaryFormat, binary);
+                    return;
+                }
+
+                GLsizei copyLength = std::min<GLsizei>(bufSize, sizeof(GLuint));
+                std::memcpy(binary, &program, copyLength);
+                *binaryFormat = mockBinaryFormat;
+                if (length) {
+                    *length = copyLength;
+                }
+            },
+            [](GLuint program, GLenum binaryFormat, const void* binary, GLsizei length) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::ProgramBinary);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.ProgramBinary(program, binaryFormat, binary, length);
+                    return;
+                }
+                gl._linkStatus[program] = (gl._linkFailure || binaryFormat != mockBinaryFormat) ? GL_FALSE : GL_TRUE;
+            },
+            [](GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetActiveAttrib);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GetActiveAttrib(program, index, bufSize, length, size, type, name);
+                    return;
+                }
+                CopyInfoLog("", bufSize, length, name);
+                *size = 0;
+                *type = GL_FLOAT;
+            },
+            [](GLuint program, const GLchar* name) -> GLint {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetAttribLocation);
+
+                if (gl._forwarding) {
+                    return gl._forwardDispatch.GetAttribLocation(program, name);
+                }
+                return -1;
+            },
+
+            // Uniforms.
+            [](GLuint program, const GLchar* name) -> GLint {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetUniformLocation);
+
+                if (gl._forwarding) {
+                    return gl._forwardDispatch.GetUniformLocation(program, name);
+                }
+
+                // Every queried name is treated as an active uniform, locations are assigned in query order.
+                std::unordered_map<std::string, GLint>& locations = gl._uniformLocations[program];
+                return locations.emplace(name, static_cast<GLint>(locations.size())).first->second;
+            },
+            [](GLint location, GLint v0) {
+                RecordingGL& gl = Current();
+                float value = static_cast<float>(v0);
+                gl.RecordUniform(location, Function::Uniform1i, &value, 1);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.Uniform1i(location, v0);
+                }
+            },
+            [](GLint location, GLfloat v0) {
+                RecordingGL& gl = Current();
+                gl.RecordUniform(location, Function::Uniform1f, &v0, 1);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.Uniform1f(location, v0);
+                }
+            },
+            [](GLint location, GLsizei count, const GLfloat* value) {
+                RecordingGL& gl = Current();
+                gl.RecordUniform(location, Function::Uniform2fv, value, 2 * count);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.Uniform2fv(location, count, value);
+                }
+            },
+            [](GLint location, GLsizei count, const GLfloat* value) {
+                RecordingGL& gl = Current();
+                gl.RecordUniform(location, Function::Uniform3fv, value, 3 * count);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.Uniform3fv(location, count, value);
+                }
+            },
+            [](GLint location, GLsizei count, const GLfloat* value) {
+                RecordingGL& gl = Current();
+                gl.RecordUniform(location, Function::Uniform4fv, value, 4 * count);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.Uniform4fv(location, count, value);
+                }
+            },
+            [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+                RecordingGL& gl = Current();
+                gl.RecordUniform(location, Function::UniformMatrix3fv, value, 9 * count);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.UniformMatrix3fv(location, count, transpose, value);
+                }
+            },
+            [](GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+                RecordingGL& gl = Current();
+                gl.RecordUniform(location, Function::UniformMatrix4fv, value, 16 * count);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.UniformMatrix4fv(location, count, transpose, value);
+                }
+            },
+
+            // Queries and context state.
+            [](GLenum name) -> const GLubyte* {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetString);
+
+                if (gl._forwarding) {
+                    return gl._forwardDispatch.GetString(name);
+                }
+                return reinterpret_cast<const GLubyte*>("RecordingGL");
+            },
+            [](GLenum pname, GLint* data) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetIntegerv);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GetIntegerv(pname, data);
+                    return;
+                }
+                *data = 0;
+            },
+            [](GLenum name, GLuint index) -> const GLubyte* {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetStringi);
+
+                if (gl._forwarding) {
+                    return gl._forwardDispatch.GetStringi(name, index);
+                }
+                return nullptr;
+            },
+            [](GLsizei n, GLuint* ids) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GenQueries);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GenQueries(n, ids);
+                    return;
+                }
+                for (GLsizei i = 0; i < n; ++i) {
+                    ids[i] = gl._nextObjectID++;
+                }
+            },
+            [](GLsizei n, const GLuint* ids) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::DeleteQueries);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.DeleteQueries(n, ids);
+                }
+            },
+            [](GLenum target, GLuint id) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::BeginQuery);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.BeginQuery(target, id);
+                }
+            },
+            [](GLenum target) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::EndQuery);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.EndQuery(target);
+                }
+            },
+            [](GLuint id, GLenum pname, GLint* params) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetQueryObjectiv);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GetQueryObjectiv(id, pname, params);
+                    return;
+                }
+                *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+            },
+            [](GLuint id, GLenum pname, GLuint64* params) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GetQueryObjectui64v);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GetQueryObjectui64v(id, pname, params);
+                    return;
+                }
+                *params = 0;
+            },
+
+            // Buffers and draws.
+            [](GLsizei n, GLuint* buffers) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GenBuffers);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GenBuffers(n, buffers);
+                    return;
+                }
+                for (GLsizei i = 0; i < n; ++i) {
+                    buffers[i] = gl._nextObjectID++;
+                }
+            },
+            [](GLsizei n, const GLuint* buffers) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::DeleteBuffers);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.DeleteBuffers(n, buffers);
+                }
+            },
+            [](GLenum target, GLuint buffer) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::BindBuffer);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.BindBuffer(target, buffer);
+                }
+            },
+            [](GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::BufferData);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.BufferData(target, size, data, usage);
+                }
+            },
+            [](GLenum target, GLuint index, GLuint buffer) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::BindBufferBase);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.BindBufferBase(target, index, buffer);
+                }
+            },
+            [](GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::DrawElementsInstancedBaseVertex);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.DrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex);
+                }
+            },
+            [](GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::MultiDrawElementsIndirect);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.MultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+                }
+            },
+            [](GLenum mode, GLint first, GLsizei count) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::DrawArrays);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.DrawArrays(mode, first, count);
+                }
+            },
+
+            // Framebuffers and vertex arrays.
+            [](GLsizei n, GLuint* framebuffers) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GenFramebuffers);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GenFramebuffers(n, framebuffers);
+                    return;
+                }
+                for (GLsizei i = 0; i < n; ++i) {
+                    framebuffers[i] = gl._nextObjectID++;
+                }
+            },
+            [](GLsizei n, const GLuint* framebuffers) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::DeleteFramebuffers);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.DeleteFramebuffers(n, framebuffers);
+                }
+            },
+            [](GLenum target, GLuint framebuffer) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::BindFramebuffer);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.BindFramebuffer(target, framebuffer);
+                }
+            },
+            [](GLsizei n, GLuint* renderbuffers) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GenRenderbuffers);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GenRenderbuffers(n, renderbuffers);
+                    return;
+                }
+                for (GLsizei i = 0; i < n; ++i) {
+                    renderbuffers[i] = gl._nextObjectID++;
+                }
+            },
+            [](GLsizei n, const GLuint* renderbuffers) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::DeleteRenderbuffers);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.DeleteRenderbuffers(n, renderbuffers);
+                }
+            },
+            [](GLenum target, GLuint renderbuffer) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::BindRenderbuffer);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.BindRenderbuffer(target, renderbuffer);
+                }
+            },
+            [](GLenum target, GLenum internalformat, GLsizei width, GLsizei height) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::RenderbufferStorage);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.RenderbufferStorage(target, internalformat, width, height);
+                }
+            },
+            [](GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::FramebufferRenderbuffer);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.FramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+                }
+            },
+            [](GLsizei n, GLuint* arrays) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::GenVertexArrays);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.GenVertexArrays(n, arrays);
+                    return;
+                }
+                for (GLsizei i = 0; i < n; ++i) {
+                    arrays[i] = gl._nextObjectID++;
+                }
+            },
+            [](GLsizei n, const GLuint* arrays) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::DeleteVertexArrays);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.DeleteVertexArrays(n, arrays);
+                }
+            },
+            [](GLuint array) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::BindVertexArray);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.BindVertexArray(array);
+                }
+            },
+            [](GLuint index) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::EnableVertexAttribArray);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.EnableVertexAttribArray(index);
+                }
+            },
+            [](GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::VertexAttribPointer);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.VertexAttribPointer(index, size, type, normalized, stride, pointer);
+                }
+            },
+            [](GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::VertexAttribIPointer);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.VertexAttribIPointer(index, size, type, stride, pointer);
+                }
+            },
+            [](GLint x, GLint y, GLsizei width, GLsizei height) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::Viewport);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.Viewport(x, y, width, height);
+                }
+            },
+            [](GLenum cap) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::Enable);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.Enable(cap);
+                }
+            },
+            [](GLenum cap) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::Disable);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.Disable(cap);
+                }
+            },
+            [](GLDEBUGPROC callback, const void* userParam) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::DebugMessageCallback);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.DebugMessageCallback(callback, userParam);
+                    return;
+                }
+                gl._debugCallback = callback;
+                gl._debugCallbackUserParam = userParam;
+            },
+            [](GLenum source, GLenum type, GLenum severity, GLsizei count, const GLuint* ids, GLboolean enabled) {
+                RecordingGL& gl = Current();
+                gl.Record(Function::DebugMessageControl);
+
+                if (gl._forwarding) {
+                    gl._forwardDispatch.DebugMessageControl(source, type, severity, count, ids, enabled);
+                }
+            },
+        };
+    }
+
+}
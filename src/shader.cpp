@@ -1,64 +1,311 @@
 
 #include <shader.h>
+#include <driver_messages.h>
+#include <gpu_profiler.h>
+#include <lexer.h>
+#include <prewarm_target.h>
+#include <source_overlay.h>
+#include <trace.h>
 #include <util.h>
 
 #include <algorithm>
+#include <chrono>
 #include <stdexcept>
 #include <iostream>
 #include <iomanip>
 #include <utility>
 #include <filesystem>
+#include <mutex>
 
 namespace GLSL {
 
     // Static initialization.
     std::vector<std::string> Shader::_includeDirectories { };
+    ProgramBinaryCache Shader::_programBinaryCache { };
+    bool Shader::_drawBatching = false;
+    #ifdef OUTPUT_DIRECTORY
+        std::string Shader::_outputDirectory = OUTPUT_DIRECTORY;
+    #else
+        std::string Shader::_outputDirectory;
+    #endif
 
     Shader::Shader(std::string name, const std::initializer_list<std::string>& shaderComponentPaths) : _shaderName(std::move(name)),
                                                                                                        _shaderID(-1),
-                                                                                                       _shaderComponentPaths(shaderComponentPaths) {
-        CompileShader(GetShaderSources());
+                                                                                                       _shaderComponentPaths(shaderComponentPaths),
+                                                                                                       _primitiveMode(GL_TRIANGLES) {
+        Build();
+    }
+
+    Shader::Shader(std::string name, const std::vector<std::string>& shaderComponentPaths) : _shaderName(std::move(name)),
+                                                                                            _shaderID(-1),
+                                                                                            _shaderComponentPaths(shaderComponentPaths),
+                                                                                            _primitiveMode(GL_TRIANGLES) {
+        Build();
+    }
+
+    Shader::Shader(std::string name, const std::initializer_list<EmbeddedShaderComponent>& embeddedComponents) : _shaderName(std::move(name)),
+                                                                                                             _shaderID(-1),
+                                                                                                             _embeddedComponents(embeddedComponents),
+                                                                                                             _primitiveMode(GL_TRIANGLES) {
+        Build();
+    }
+
+    Shader::Shader(PreprocessedShader preprocessedShader) : _shaderName(std::move(preprocessedShader._shaderName)),
+                                                            _shaderID(-1),
+                                                            _shaderComponentPaths(std::move(preprocessedShader._shaderComponentPaths)),
+                                                            _buildReport(std::move(preprocessedShader._buildReport)),
+                                                            _dependencies(std::move(preprocessedShader._dependencies)),
+                                                            _dependencyStamps(std::move(preprocessedShader._dependencyStamps)),
+                                                            _perDrawLayout(std::move(preprocessedShader._perDrawLayout)),
+                                                            _primitiveMode(GL_TRIANGLES) {
+        try {
+            CompileShader(preprocessedShader._shaderComponents);
+        }
+        catch (...) {
+            _dependencyStamps.clear();
+            Counters::Increment(Counters::Counter::FailedBuilds);
+            throw;
+        }
+
+        Counters::Increment(Counters::Counter::Builds);
     }
 
     std::unordered_map<std::string, std::pair<GLenum, std::string>> Shader::GetShaderSources() {
-        std::string outputDirectory = CreateDirectory(std::string(OUTPUT_DIRECTORY));
-        std::unordered_map<std::string, std::pair<GLenum, std::string>> shaderComponents;
+        GLSL_TRACE_SPAN("Get shader sources", "preprocess", _shaderName);
+
+        // Embedded shader components were already processed at build time.
+        if (!_embeddedComponents.empty()) {
+            std::unordered_map<std::string, std::pair<GLenum, std::string>> shaderComponents;
+            _buildReport = ShaderBuildReport();
+            _buildReport._shaderName = _shaderName;
+
+            for (const EmbeddedShaderComponent& embeddedComponent : _embeddedComponents) {
+                shaderComponents.emplace(std::string(embeddedComponent._filepath), std::make_pair(embeddedComponent._shaderType, std::string(embeddedComponent._source)));
+
+                ShaderBuildReport::Component& component = _buildReport._components.emplace_back();
+                component._filepath = std::string(embeddedComponent._filepath);
+                component._preprocessedBytes = embeddedComponent._source.size();
+            }
 
-        // Get shader types.
-        std::for_each(_shaderComponentPaths.begin(), _shaderComponentPaths.end(), [&](const std::string& filepath) {
-            std::size_t dotPosition = filepath.find_last_of('.');
+            _perDrawLayout = PerDrawUniforms::Apply(shaderComponents, _drawBatching);
+            return shaderComponents;
+        }
+
+        PreprocessedShader preprocessedShader = PreprocessShader(_shaderName, _shaderComponentPaths);
 
-            // Found extension.
-            if (dotPosition != std::string::npos) {
-                std::string shaderExtension = filepath.substr(dotPosition + 1);
-                GLenum shaderType = ShaderTypeFromString(shaderExtension);
+        // Only replaced once every component pre-processed, a failed build keeps the files of the last good one.
+        _buildReport = std::move(preprocessedShader._buildReport);
+        _dependencies = std::move(preprocessedShader._dependencies);
+        _dependencyStamps = std::move(preprocessedShader._dependencyStamps);
+        _perDrawLayout = std::move(preprocessedShader._perDrawLayout);
+        return std::move(preprocessedShader._shaderComponents);
+    }
 
-                if (shaderType == GL_INVALID_VALUE) {
-                    throw std::runtime_error("Unknown or unsupported shader of type: \"" + shaderExtension + "\"");
+    PreprocessedShader Shader::PreprocessShader(const std::string& shaderName, const std::vector<std::string>& shaderComponentPaths, const std::vector<std::string>& shaderComponentSources,
+                                                const std::vector<FileStamp>& shaderComponentStamps, std::size_t lexerThreadCount) {
+        PreprocessedShader preprocessedShader;
+        preprocessedShader._shaderName = shaderName;
+        preprocessedShader._shaderComponentPaths = shaderComponentPaths;
+        preprocessedShader._buildReport._shaderName = shaderName;
+
+        for (std::size_t i = 0; i < shaderComponentPaths.size(); ++i) {
+            const std::string& filepath = shaderComponentPaths[i];
+            std::vector<std::string> dependencies;
+            std::vector<FileStamp> dependencyStamps;
+            PreprocessStatistics statistics;
+
+            auto preprocessStart = std::chrono::steady_clock::now();
+            std::string shaderFile = ProcessFile(shaderName, filepath, dependencies, dependencyStamps, statistics, i < shaderComponentSources.size() ? &shaderComponentSources[i] : nullptr,
+                                                 i < shaderComponentStamps.size() ? &shaderComponentStamps[i] : nullptr, lexerThreadCount);
+            auto preprocessEnd = std::chrono::steady_clock::now();
+            double preprocessMilliseconds = std::chrono::duration<double, std::milli>(preprocessEnd - preprocessStart).count();
+
+            // Multi-stage file, one component per stage. The file is pre-processed once, its cost is reported on the first stage.
+            std::vector<ShaderStage> stages = SplitStages(shaderFile);
+            if (stages.empty()) {
+                stages.push_back({ "", GetShaderType(filepath), std::move(shaderFile) });
+            }
+
+            for (std::size_t j = 0; j < stages.size(); ++j) {
+                ShaderStage& stage = stages[j];
+                std::string componentPath = stage._name.empty() ? filepath : filepath + "." + stage._name;
+                ShaderBuildReport::Component& component = preprocessedShader._buildReport._components.emplace_back();
+
+                component._filepath = componentPath;
+                component._preprocessedBytes = stage._source.size();
+                if (j == 0) {
+                    component._preprocessMilliseconds = preprocessMilliseconds;
+                    component._preprocessStatistics = statistics;
                 }
 
-                std::string shaderFile = ProcessFile(filepath);
+                preprocessedShader._shaderComponents.emplace(componentPath, std::make_pair(stage._shaderType, std::move(stage._source)));
+            }
 
-                #ifdef OUTPUT_DIRECTORY
-                    WriteToOutputDirectory(outputDirectory, filepath, shaderFile);
-                #endif
+            // Files shared between components keep the stamp from their first read.
+            for (std::size_t j = 0; j < dependencies.size(); ++j) {
+                if (std::find(preprocessedShader._dependencies.begin(), preprocessedShader._dependencies.end(), dependencies[j]) == preprocessedShader._dependencies.end()) {
+                    preprocessedShader._dependencies.emplace_back(std::move(dependencies[j]));
+                    preprocessedShader._dependencyStamps.emplace_back(std::move(dependencyStamps[j]));
+                }
+            }
+        }
 
-                shaderComponents.emplace(filepath, std::make_pair(shaderType, shaderFile));
+        // Per-draw uniforms span every component, they can only be rewritten once all are pre-processed.
+        preprocessedShader._perDrawLayout = PerDrawUniforms::Apply(preprocessedShader._shaderComponents, _drawBatching);
+
+        if (!_outputDirectory.empty()) {
+            std::string outputDirectory = CreateDirectory(_outputDirectory);
+            for (const auto& shaderComponent : preprocessedShader._shaderComponents) {
+                WriteToOutputDirectory(shaderName, outputDirectory, shaderComponent.first, shaderComponent.second.second);
             }
-            else {
-                throw std::runtime_error("Could not find shader extension on file: \"" + filepath + "\"");
+        }
+
+        return preprocessedShader;
+    }
+
+    std::string Shader::Preprocess(const std::string& filepath) {
+        std::vector<std::string> dependencies;
+        std::vector<FileStamp> dependencyStamps;
+        PreprocessStatistics statistics;
+        return ProcessFile(GetAssetName(filepath), filepath, dependencies, dependencyStamps, statistics);
+    }
+
+    std::string Shader::Preprocess(const std::string& filepath, std::vector<std::string>& dependencies) {
+        std::vector<FileStamp> dependencyStamps;
+        PreprocessStatistics statistics;
+        return ProcessFile(GetAssetName(filepath), filepath, dependencies, dependencyStamps, statistics);
+    }
+
+    std::string Shader::Preprocess(const std::string& filepath, std::vector<std::string>& dependencies, PreprocessStatistics& statistics, std::size_t lexerThreadCount) {
+        std::vector<FileStamp> dependencyStamps;
+        return ProcessFile(GetAssetName(filepath), filepath, dependencies, dependencyStamps, statistics, nullptr, nullptr, lexerThreadCount);
+    }
+
+    std::vector<ShaderStage> Shader::SplitStages(const std::string& source) {
+        std::vector<ShaderStage> stages;
+
+        ForEachShaderStage(source, [&stages](std::string_view stageName, std::string_view prefix, std::string_view section) {
+            ShaderStage stage;
+            stage._name = std::string(stageName);
+            stage._shaderType = ShaderTypeFromStageName(stageName);
+
+            if (stage._shaderType == GL_INVALID_VALUE) {
+                throw std::runtime_error("Unknown or unsupported shader stage: \"" + stage._name + "\"");
+            }
+            for (const ShaderStage& existingStage : stages) {
+                if (existingStage._name == stage._name) {
+                    throw std::runtime_error("Shader stage \"" + stage._name + "\" is repeated.");
+                }
             }
+
+            stage._source.reserve(prefix.size() + section.size());
+            stage._source.append(prefix).append(section);
+            stages.emplace_back(std::move(stage));
         });
 
-        return std::move(shaderComponents);
+        return stages;
+    }
+
+    GLenum Shader::GetShaderType(const std::string& filepath) {
+        std::size_t dotPosition = filepath.find_last_of('.');
+
+        // Could not find extension.
+        if (dotPosition == std::string::npos) {
+            throw std::runtime_error("Could not find shader extension on file: \"" + filepath + "\"");
+        }
+
+        std::string shaderExtension = filepath.substr(dotPosition + 1);
+        GLenum shaderType = ShaderTypeFromString(shaderExtension);
+
+        if (shaderType == GL_INVALID_VALUE) {
+            throw std::runtime_error("Unknown or unsupported shader of type: \"" + shaderExtension + "\"");
+        }
+
+        return shaderType;
+    }
+
+    void Shader::Recompile(bool force) {
+        if (!force && !NeedsRecompile()) {
+            Counters::Increment(Counters::Counter::RecompilesSkipped);
+            return;
+        }
+
+        Counters::Increment(Counters::Counter::Recompiles);
+        Build();
     }
 
-    void Shader::Recompile() {
-        CompileShader(GetShaderSources());
+    bool Shader::NeedsRecompile() const {
+        GLSL_TRACE_SPAN("Check dependencies", "io", _shaderName);
+
+        // Embedded shader components cannot change.
+        if (!_embeddedComponents.empty()) {
+            return false;
+        }
+
+        // Last build failed.
+        if (_dependencyStamps.empty()) {
+            return true;
+        }
+
+        return HaveFilesChanged(_dependencyStamps);
+    }
+
+    void Shader::Prewarm() const {
+        Prewarm({ this });
+    }
+
+    void Shader::Prewarm(const std::vector<const Shader*>& shaders) {
+        GLSL_TRACE_SPAN("Prewarm shaders", "driver");
+        PrewarmTarget prewarmTarget;
+
+        for (const Shader* shader : shaders) {
+            if (shader && shader->_primitiveMode != 0) {
+                GLSL_TRACE_SPAN("Prewarm draw", "driver", shader->_shaderName);
+                prewarmTarget.Draw(*shader, shader->_primitiveMode);
+            }
+        }
+    }
+
+    void Shader::Build() {
+        try {
+            CompileShader(GetShaderSources());
+        }
+        catch (...) {
+            _dependencyStamps.clear();
+            Counters::Increment(Counters::Counter::FailedBuilds);
+            throw;
+        }
+
+        Counters::Increment(Counters::Counter::Builds);
     }
 
     void Shader::CompileShader(const std::unordered_map<std::string, std::pair<GLenum, std::string>> &shaderComponents) {
-        GLuint shaderProgram = glCreateProgram();
+        GLSL_TRACE_SPAN("Compile shader program", "driver", _shaderName);
+        DriverMessages::BuildScope driverMessageScope(_shaderName);
+
+        _primitiveMode = GL_TRIANGLES;
+        for (const auto& shaderComponent : shaderComponents) {
+            if (shaderComponent.second.first == GL_TESS_CONTROL_SHADER || shaderComponent.second.first == GL_TESS_EVALUATION_SHADER) {
+                _primitiveMode = GL_PATCHES;
+            }
+            else if (shaderComponent.second.first == GL_COMPUTE_SHADER) {
+                _primitiveMode = 0;
+            }
+        }
+
+        std::string cacheKey;
+        if (_programBinaryCache.IsEnabled()) {
+            cacheKey = ProgramBinaryCache::GetKey(shaderComponents);
+
+            GLuint cachedProgram = LoadProgramBinary(cacheKey);
+            if (cachedProgram != 0) {
+                ReplaceProgram(cachedProgram);
+                BuildReport::Record(_buildReport);
+                return;
+            }
+        }
+
+        GLuint shaderProgram = GL().CreateProgram();
         unsigned numShaderComponents = shaderComponents.size();
         GLuint* shaders = new GLenum[numShaderComponents];
         unsigned currentShaderIndex = 0;
@@ -71,53 +318,158 @@ namespace GLSL {
             GLuint shader = CompileShaderComponent(shaderComponent);
 
             // Shader successfully compiled.
-            glAttachShader(shaderProgram, shader);
+            GL().AttachShader(shaderProgram, shader);
             shaders[currentShaderIndex++] = shader;
         }
 
         //--------------------------------------------------------------------------------------------------------------
         // SHADER PROGRAM LINKING
         //--------------------------------------------------------------------------------------------------------------
-        glLinkProgram(shaderProgram);
+        // Binary can only be retrieved if requested before linking.
+        if (!cacheKey.empty()) {
+            GL().ProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+
+        auto linkStart = std::chrono::steady_clock::now();
+        {
+            GLSL_TRACE_SPAN("glLinkProgram", "driver", _shaderName);
+            GL().LinkProgram(shaderProgram);
+        }
 
         GLint isLinked = 0;
-        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &isLinked);
+        {
+            GLSL_TRACE_SPAN("Wait for link status", "driver", _shaderName);
+            GL().GetProgramiv(shaderProgram, GL_LINK_STATUS, &isLinked);
+        }
+        _buildReport._linkMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - linkStart).count();
         if (!isLinked) {
             // Shader failed to link - get error information from OpenGL.
             GLint errorMessageLength = 0;
-            glGetProgramiv(shaderProgram, GL_INFO_LOG_LENGTH, &errorMessageLength);
+            GL().GetProgramiv(shaderProgram, GL_INFO_LOG_LENGTH, &errorMessageLength);
 
             std::vector<GLchar> errorMessageBuffer;
             errorMessageBuffer.resize(errorMessageLength + 1);
-            glGetProgramInfoLog(shaderProgram, errorMessageLength, nullptr, &errorMessageBuffer[0]);
+            GL().GetProgramInfoLog(shaderProgram, errorMessageLength, nullptr, &errorMessageBuffer[0]);
             std::string errorMessage(errorMessageBuffer.begin(), errorMessageBuffer.end());
 
             // Program is unnecessary at this point.
-            glDeleteProgram(shaderProgram);
+            GL().DeleteProgram(shaderProgram);
 
             // Delete shader types.
             for (int i = 0; i < numShaderComponents; ++i) {
-                glDeleteShader(shaders[i]);
+                GL().DeleteShader(shaders[i]);
             }
 
             throw std::runtime_error("Shader: " + _shaderName + " failed to link. Provided error information: " + errorMessage);
         }
 
+        ReplaceProgram(shaderProgram);
+
+        // Shader types are no longer necessary.
+        for (int i = 0; i < numShaderComponents; ++i) {
+            GLuint shaderComponentID = shaders[i];
+            GL().DetachShader(shaderProgram, shaderComponentID);
+            GL().DeleteShader(shaderComponentID);
+        }
+
+        if (!cacheKey.empty()) {
+            StoreProgramBinary(cacheKey, shaderProgram);
+        }
+
+        BuildReport::Record(_buildReport);
+    }
+
+    GLuint Shader::LoadProgramBinary(const std::string& cacheKey) {
+        GLSL_TRACE_SPAN("Load program binary", "cache", _shaderName);
+        ProgramBinaryCache::ProgramBinary programBinary;
+
+        if (!_programBinaryCache.Load(cacheKey, programBinary)) {
+            Counters::Increment(Counters::Counter::ProgramBinaryMisses);
+            return 0;
+        }
+
+        auto linkStart = std::chrono::steady_clock::now();
+        GLuint shaderProgram = GL().CreateProgram();
+        GL().ProgramBinary(shaderProgram, programBinary._format, programBinary._data.data(), static_cast<GLsizei>(programBinary._data.size()));
+
+        // Driver rejects binaries it can no longer load (e.g. after a driver update), fall back to compiling.
+        GLint isLinked = 0;
+        GL().GetProgramiv(shaderProgram, GL_LINK_STATUS, &isLinked);
+        if (!isLinked) {
+            GL().DeleteProgram(shaderProgram);
+            Counters::Increment(Counters::Counter::ProgramBinaryMisses);
+            return 0;
+        }
+
+        _buildReport._linkMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - linkStart).count();
+        Counters::Increment(Counters::Counter::ProgramBinaryHits);
+        return shaderProgram;
+    }
+
+    void Shader::StoreProgramBinary(const std::string& cacheKey, GLuint shaderProgram) const {
+        GLSL_TRACE_SPAN("Store program binary", "cache", _shaderName);
+
+        GLint binaryLength = 0;
+        GL().GetProgramiv(shaderProgram, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+
+        // Drivers without binary formats report a length of 0.
+        if (binaryLength <= 0) {
+            return;
+        }
+
+        ProgramBinaryCache::ProgramBinary programBinary;
+        programBinary._data.resize(binaryLength);
+
+        GLsizei length = 0;
+        GL().GetProgramBinary(shaderProgram, binaryLength, &length, &programBinary._format, programBinary._data.data());
+        programBinary._data.resize(length);
+
+        // Storing is best effort, the program is already installed and the build succeeded either way.
+        try {
+            _programBinaryCache.Store(cacheKey, programBinary);
+        }
+        catch (const std::exception&) {
+            Counters::Increment(Counters::Counter::ProgramBinaryStoreFailures);
+        }
+    }
+
+    void Shader::ReplaceProgram(GLuint shaderProgram) {
         // Shader has already been initialized, delete prior shader program.
         if (_shaderID != (GLuint)-1) {
-            glDeleteProgram(_shaderID);
+            GL().DeleteProgram(_shaderID);
         }
         // Shader is successfully initialized.
         _shaderID = shaderProgram;
 
         // Clear previous shader uniform locations.
         _uniformLocations.clear();
+        _paramUploadPlans.clear();
 
-        // Shader types are no longer necessary.
-        for (int i = 0; i < numShaderComponents; ++i) {
-            GLuint shaderComponentID = shaders[i];
-            glDetachShader(shaderProgram, shaderComponentID);
-            glDeleteShader(shaderComponentID);
+        ReflectVertexAttributes();
+    }
+
+    void Shader::ReflectVertexAttributes() {
+        _vertexAttributes.clear();
+
+        GLint attributeCount = 0;
+        GLint maxNameLength = 0;
+        GL().GetProgramiv(_shaderID, GL_ACTIVE_ATTRIBUTES, &attributeCount);
+        GL().GetProgramiv(_shaderID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLength);
+
+        std::vector<GLchar> nameBuffer(static_cast<std::size_t>(std::max(maxNameLength, 1)));
+        for (GLint i = 0; i < attributeCount; ++i) {
+            GLsizei nameLength = 0;
+            VertexAttribute attribute;
+            GL().GetActiveAttrib(_shaderID, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()), &nameLength, &attribute._size, &attribute._type, nameBuffer.data());
+            attribute._name.assign(nameBuffer.data(), nameLength);
+
+            // Built-in inputs have no location.
+            if (attribute._name.empty() || attribute._name.compare(0, 3, "gl_") == 0) {
+                continue;
+            }
+
+            attribute._location = GL().GetAttribLocation(_shaderID, attribute._name.c_str());
+            _vertexAttributes.emplace_back(std::move(attribute));
         }
     }
 
@@ -127,24 +479,39 @@ namespace GLSL {
         const GLchar* shaderSource = reinterpret_cast<const GLchar*>(shaderComponent.second.second.c_str());
 
         // Create shader from source.
-        GLuint shader = glCreateShader(shaderType);
-        glShaderSource(shader, 1, &shaderSource, nullptr); // If length is NULL, each string is assumed to be null terminated.
-        glCompileShader(shader);
+        GLuint shader = GL().CreateShader(shaderType);
+        GL().ShaderSource(shader, 1, &shaderSource, nullptr); // If length is NULL, each string is assumed to be null terminated.
+
+        auto compileStart = std::chrono::steady_clock::now();
+        {
+            GLSL_TRACE_SPAN("glCompileShader", "driver", _shaderName, shaderFilePath);
+            GL().CompileShader(shader);
+        }
 
         // Compile shader source code.
         GLint isCompiled = 0;
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+        {
+            GLSL_TRACE_SPAN("Wait for compile status", "driver", _shaderName, shaderFilePath);
+            GL().GetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+        }
+        double compileMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count();
+
+        for (ShaderBuildReport::Component& component : _buildReport._components) {
+            if (component._filepath == shaderFilePath) {
+                component._compileMilliseconds = compileMilliseconds;
+            }
+        }
         if (!isCompiled) {
             // Shader failed to compile - get error information from OpenGL.
             GLint errorMessageLength = 0;
-            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &errorMessageLength);
+            GL().GetShaderiv(shader, GL_INFO_LOG_LENGTH, &errorMessageLength);
 
             std::vector<GLchar> errorMessageBuffer;
             errorMessageBuffer.resize(errorMessageLength + 1);
-            glGetShaderInfoLog(shader, errorMessageLength, nullptr, &errorMessageBuffer[0]);
+            GL().GetShaderInfoLog(shader, errorMessageLength, nullptr, &errorMessageBuffer[0]);
             std::string errorMessage(errorMessageBuffer.begin(), errorMessageBuffer.end());
 
-            glDeleteShader(shader);
+            GL().DeleteShader(shader);
             throw std::runtime_error("Shader: " + _shaderName + " failed to compile " + ShaderTypeToString(shaderType) + " component (" + shaderFilePath + "). Provided error information: " + errorMessage);
         }
 
@@ -159,63 +526,114 @@ namespace GLSL {
                 return "VERTEX";
             case GL_GEOMETRY_SHADER:
                 return "GEOMETRY";
+            case GL_COMPUTE_SHADER:
+                return "COMPUTE";
             default:
                 return "";
         }
     }
 
-    std::string Shader::ProcessFile(const std::string &filepath) {
-        Parser parser;
+    std::string Shader::ProcessFile(const std::string& shaderName, const std::string &filepath, std::vector<std::string>& dependencies, std::vector<FileStamp>& dependencyStamps,
+                                    PreprocessStatistics& statistics, const std::string* fileContents, const FileStamp* fileStamp, std::size_t lexerThreadCount) {
+        GLSL_TRACE_SPAN("Preprocess shader component", "preprocess", shaderName, filepath);
+        Parser parser(shaderName, lexerThreadCount);
 
-        std::string processedShaderSource = parser.ProcessFile(filepath);
-        EraseNewlines(processedShaderSource, false);
+        std::string processedShaderSource = parser.ProcessFile(filepath, fileContents, fileStamp);
+        {
+            GLSL_TRACE_SPAN("Compact output", "preprocess", shaderName, filepath);
+            EraseNewlines(processedShaderSource, false);
+        }
         parser.ValidateIncludeGuardScope();
 
+        dependencies = parser.GetDependencies();
+        dependencyStamps = parser.GetDependencyStamps();
+        statistics = parser.GetStatistics();
+
         return std::move(processedShaderSource);
     }
 
     GLenum Shader::ShaderTypeFromString(const std::string &shaderExtension) {
-        if (shaderExtension == "vert") {
-            return GL_VERTEX_SHADER;
-        }
-        if (shaderExtension == "frag") {
-            return GL_FRAGMENT_SHADER;
-        }
-        if (shaderExtension == "geom") {
-            return GL_GEOMETRY_SHADER;
-        }
-
-        return GL_INVALID_VALUE;
+        return ShaderTypeFromExtension(shaderExtension);
     }
 
     Shader::~Shader() {
-        glDeleteProgram(_shaderID);
+        GL().DeleteProgram(_shaderID);
     }
 
     void Shader::Bind() const {
-        glUseProgram(_shaderID);
+        Counters::Increment(Counters::Counter::UseProgram);
+        GL().UseProgram(_shaderID);
+
+        if (GPUProfiler::IsEnabled()) {
+            GPUProfiler::Begin(_shaderName);
+        }
+        if (DriverMessages::IsEnabled()) {
+            DriverMessages::Bind(_shaderName);
+        }
     }
 
     void Shader::Unbind() const {
-        glUseProgram(0);
+        if (GPUProfiler::IsEnabled()) {
+            GPUProfiler::End();
+        }
+        if (DriverMessages::IsEnabled()) {
+            DriverMessages::Unbind();
+        }
+
+        Counters::Increment(Counters::Counter::UseProgram);
+        GL().UseProgram(0);
     }
 
     const std::string &Shader::GetName() const {
         return _shaderName;
     }
 
-    void Shader::WriteToOutputDirectory(const std::string& outputDirectory, const std::string& filepath, const std::string& shaderFile) const {
+    const ShaderBuildReport& Shader::GetBuildReport() const {
+        return _buildReport;
+    }
+
+    const std::vector<std::string>& Shader::GetDependencies() const {
+        return _dependencies;
+    }
+
+    const PerDrawLayout& Shader::GetPerDrawLayout() const {
+        return _perDrawLayout;
+    }
+
+    const std::vector<VertexAttribute>& Shader::GetVertexAttributes() const {
+        return _vertexAttributes;
+    }
+
+    void Shader::WriteToOutputDirectory([[maybe_unused]] const std::string& shaderName, const std::string& outputDirectory, const std::string& filepath, const std::string& shaderFile) {
+        GLSL_TRACE_SPAN("Write output", "io", shaderName, filepath);
         std::ofstream outputStream;
 
         // Get only the shader name from the full filepath.
         std::string assetName = GetAssetName(filepath);
 
+        // Components in different directories can share an asset name, and ShaderLibraryLoader pre-processes shaders
+        // on several threads. Writes are serialized, so the output file always holds one complete component.
+        static std::mutex outputMutex;
+        std::lock_guard<std::mutex> lock(outputMutex);
+
         // Create file.
         outputStream.open(outputDirectory + assetName);
         outputStream << shaderFile;
         outputStream.close();
     }
 
+    void Shader::SetProgramBinaryCache(const std::string& directory, const std::string& remoteAddress) {
+        _programBinaryCache = ProgramBinaryCache(directory, remoteAddress);
+    }
+
+    void Shader::SetDrawBatching(bool enabled) {
+        _drawBatching = enabled;
+    }
+
+    void Shader::SetOutputDirectory(const std::string& directory) {
+        _outputDirectory = directory;
+    }
+
     void Shader::AddIncludeDirectory(std::string includeDirectory) {
         char slash = includeDirectory.back();
 
@@ -231,16 +649,26 @@ namespace GLSL {
         _includeDirectories.emplace_back(includeDirectory);
     }
 
-    Shader::Parser::Parser() : _hasVersionInformation(false),
-                               _processingExistingInclude(false) {
+    Shader::Parser::Parser(std::string shaderName, std::size_t lexerThreadCount) : _shaderName(std::move(shaderName)),
+                                                                                   _lexerThreadCount(lexerThreadCount),
+                                                                                   _includeDepth(0),
+                                                                                   _hasVersionInformation(false),
+                                                                                   _processingExistingInclude(false) {
     }
 
     Shader::Parser::~Parser() {
         _includeGuards.clear();
         _includeGuardInstances.clear();
+        _dependencies.clear();
+        _dependencyStamps.clear();
 
         _pragmaInstances.clear();
 
+        _stageNames.clear();
+        _sharedIncludeGuards.clear();
+        _sharedIncludeGuardInstances.clear();
+        _sharedPragmaInstances.clear();
+
         while (!_pragmaStack.empty()) {
             _pragmaStack.pop();
         }
@@ -249,18 +677,69 @@ namespace GLSL {
         _processingExistingInclude = false;
     }
 
-    std::string Shader::Parser::ProcessFile(const std::string &filepath) {
-        std::ifstream fileReader;
+    std::string Shader::Parser::ProcessFile(const std::string &filepath, const std::string* fileContents, const FileStamp* fileStamp) {
+        GLSL_TRACE_SPAN("Process file", "preprocess", _shaderName, filepath);
+
+        // Stamp files before reading them, an edit that lands during the read must not be recorded as seen.
+        bool isNewDependency = std::find(_dependencies.begin(), _dependencies.end(), filepath) == _dependencies.end();
+        FileStamp dependencyStamp;
+        if (isNewDependency) {
+            dependencyStamp = fileStamp ? *fileStamp : GetFileStamp(filepath);
+        }
+
+        // Files overlaid in memory (e.g. unsaved editor buffers) are already lexed.
+        LexedSource lexedSource;
+        bool isOverlaid = SourceOverlay::GetLexedSource(filepath, lexedSource);
+        bool isOpen = isOverlaid || fileContents;
+        std::string fileReadContents;
+
+        // Read the file, unless it was already read. Files are lexed as a whole, large ones in parallel (see Lexer).
+        if (!isOverlaid && !fileContents) {
+            GLSL_TRACE_SPAN("Read file", "io", _shaderName, filepath);
+            std::ifstream fileReader(filepath);
+
+            if (fileReader.is_open()) {
+                std::stringstream fileBuffer;
+                fileBuffer << fileReader.rdbuf();
+                fileReadContents = fileBuffer.str();
+                fileContents = &fileReadContents;
+                isOpen = true;
+            }
+        }
+        if (!isOverlaid && fileContents) {
+            GLSL_TRACE_SPAN("Lex file", "preprocess", _shaderName, filepath);
+            lexedSource = Lexer::Lex(*fileContents, _lexerThreadCount);
+        }
+
+        if (isOpen) {
+            if (isNewDependency) {
+                _dependencies.emplace_back(filepath);
+                _dependencyStamps.emplace_back(std::move(dependencyStamp));
+            }
+
+            // Depth of the shader component itself is 0.
+            if (_includeDepth > 0) {
+                ++_statistics._includesOpened;
+                _statistics._deepestIncludeChain = std::max(_statistics._deepestIncludeChain, _includeDepth);
+            }
+            ++_includeDepth;
 
-        // Open the file.
-        fileReader.open(filepath);
-        if (fileReader.is_open()) {
             std::stringstream file;
-            int lineNumber = 1;
+            std::size_t nextDirective = 0;
 
             // Process file.
-            while (!fileReader.eof()) {
-                std::string line = GetLine(fileReader);
+            for (std::size_t lineIndex = 0; lineIndex < lexedSource._lines.size(); ++lineIndex) {
+                const std::string& line = lexedSource._lines[lineIndex];
+                int lineNumber = static_cast<int>(lineIndex) + 1;
+
+                // Only directives need to be tokenized.
+                if (nextDirective == lexedSource._directiveLines.size() || lexedSource._directiveLines[nextDirective] != lineIndex) {
+                    if (!_processingExistingInclude && _hasVersionInformation) {
+                        file << line << std::endl;
+                    }
+                    continue;
+                }
+                ++nextDirective;
 
                 // Stringstream for parsing the line.
                 std::stringstream parser(line);
@@ -269,13 +748,30 @@ namespace GLSL {
 
                 // Pragma.
                 if (token == "#pragma") {
+                    GLSL_TRACE_SPAN("#pragma", "directive", _shaderName, filepath);
                     // Get token following #pragma directive.
                     parser >> token;
-                    PragmaDirective(filepath, line, lineNumber, token);
+
+                    // Per-draw markers are kept for PerDrawUniforms, which rewrites the declaration that follows.
+                    if (token == "per_draw") {
+                        if (!_processingExistingInclude && _hasVersionInformation) {
+                            file << line << std::endl;
+                        }
+                    }
+                    // Stage markers are written in the form Shader::SplitStages expects.
+                    else if (token == "stage") {
+                        parser >> token;
+                        StageDirective(filepath, line, lineNumber, token);
+                        file << StageMarker << token << std::endl;
+                    }
+                    else {
+                        PragmaDirective(filepath, line, lineNumber, token);
+                    }
                 }
 
                 // Open include guard.
                 else if (token == "#ifndef") {
+                    GLSL_TRACE_SPAN("#ifndef", "directive", _shaderName, filepath);
                     // Get include guard name.
                     parser >> token;
                     OpenIncludeGuard(filepath, line, lineNumber, token);
@@ -283,6 +779,7 @@ namespace GLSL {
 
                 // Define (macro or include guard).
                 else if (token == "#define") {
+                    GLSL_TRACE_SPAN("#define", "directive", _shaderName, filepath);
                     // Get define name.
                     parser >> token;
                     bool regularDefine = DefineDirective(filepath, line, lineNumber, token);
@@ -295,12 +792,14 @@ namespace GLSL {
 
                 // Close include guard.
                 else if (token == "#endif") {
+                    GLSL_TRACE_SPAN("#endif", "directive", _shaderName, filepath);
                     parser >> token;
                     CloseIncludeGuard(filepath, line, lineNumber, token);
                 }
 
                 // GLSL shader version.
                 else if (token == "#version") {
+                    GLSL_TRACE_SPAN("#version", "directive", _shaderName, filepath);
                     // Skip additional shader versions if they appear. First version is the version of the shader.
                     if (!_hasVersionInformation) {
                         file << line << std::endl;
@@ -310,8 +809,9 @@ namespace GLSL {
 
                 // Include external file.
                 else if (token == "#include") {
+                    GLSL_TRACE_SPAN("#include", "directive", _shaderName, filepath);
                     parser >> token; // Get filename to include;
-                    IncludeFile(filepath, line, lineNumber, token);
+                    file << IncludeFile(filepath, line, lineNumber, token);
                 }
 
                 // Normal shader line, emplace entire line.
@@ -320,24 +820,16 @@ namespace GLSL {
                         file << line << std::endl;
                     }
                 }
-
-                ++lineNumber;
             }
 
-            // #pragma one preprocessor directive pushes filename.
-            if (_processingExistingInclude) {
-                const std::pair<std::string, int>& pragmaData = _pragmaStack.top();
-
-                // Ensure filename is the same as the current processed filename.
-                // This file has been included the maximum one time in this shader unit.
-                if (pragmaData.first == filepath) {
-                    _processingExistingInclude = false;
-                    _pragmaStack.pop();
-                }
-
-                // Otherwise, pragma is kept and will be processed as an error later.
+            // #pragma once preprocessor directive of an already included file pushes filename.
+            // This file has been included the maximum one time in this shader unit, resume processing after it.
+            if (!_pragmaStack.empty() && _pragmaStack.top().first == filepath) {
+                _processingExistingInclude = false;
+                _pragmaStack.pop();
             }
 
+            --_includeDepth;
             return file.str();
         }
         else {
@@ -346,19 +838,10 @@ namespace GLSL {
         }
     }
 
-    std::string Shader::Parser::GetLine(std::ifstream &stream) const {
-        std::string line;
-
-        std::getline(stream, line);
-        line += '\n'; // getline consumes the newline.
-        EraseComments(line);
-        EraseNewlines(line, true);
-
-        return std::move(line);
-    }
-
     std::string Shader::Parser::IncludeFile(const std::string &currentFile, const std::string& line, int lineNumber, const std::string& fileToInclude) {
         if (!_processingExistingInclude) {
+            GLSL_TRACE_SPAN("Resolve include", "include", _shaderName, fileToInclude);
+
             if (ValidateAgainst("#include", fileToInclude)) {
                 ThrowFormattedError(currentFile, line, lineNumber, "Empty #include pre-processor directive. Expected <filename> or \"filename\".", 9);
             }
@@ -373,7 +856,7 @@ namespace GLSL {
                     std::string fileLocation = directory + filename;
 
                     // File exists.
-                    if (std::filesystem::is_regular_file(fileLocation)) {
+                    if (SourceOverlay::Contains(fileLocation) || std::filesystem::is_regular_file(fileLocation)) {
                         try {
                             return ProcessFile(fileLocation);
                         }
@@ -406,6 +889,42 @@ namespace GLSL {
         return "";
     }
 
+    void Shader::Parser::StageDirective(const std::string &currentFile, const std::string &line, int lineNumber, const std::string& stageName) {
+        // Depth of the shader component itself is 1 while it is processed.
+        if (_includeDepth != 1) {
+            ThrowFormattedError(currentFile, line, lineNumber, "#pragma stage is only supported in shader component files, not in included files.", 8);
+        }
+        if (!_hasVersionInformation) {
+            ThrowFormattedError(currentFile, line, lineNumber, "Version directive must precede the first #pragma stage.", 0);
+        }
+        if (ShaderTypeFromStageName(stageName) == GL_INVALID_VALUE) {
+            ThrowFormattedError(currentFile, line, lineNumber, "Unknown shader stage '" + stageName + "'. Expected vertex, fragment, geometry or compute.", 14);
+        }
+        if (!_stageNames.insert(stageName).second) {
+            ThrowFormattedError(currentFile, line, lineNumber, "Shader stage '" + stageName + "' is repeated.", 14);
+        }
+
+        // Files included in the shared prefix stay included, every stage may include any other file once. Include
+        // guards opened in a stage must be closed in it, the include state is reset at every marker.
+        if (_stageNames.size() == 1) {
+            _sharedIncludeGuards = _includeGuards;
+            _sharedIncludeGuardInstances = _includeGuardInstances;
+            _sharedPragmaInstances = _pragmaInstances;
+        }
+        else {
+            for (std::size_t i = _sharedIncludeGuards.size(); i < _includeGuards.size(); ++i) {
+                const IncludeGuard& includeGuard = _includeGuards[i];
+                if (includeGuard._endifLineNumber == -1) {
+                    ThrowFormattedError(includeGuard._includeGuardFile, includeGuard._includeGuardLine, includeGuard._includeGuardLineNumber, "Unterminated #ifndef directive.", 0);
+                }
+            }
+
+            _includeGuards = _sharedIncludeGuards;
+            _includeGuardInstances = _sharedIncludeGuardInstances;
+            _pragmaInstances = _sharedPragmaInstances;
+        }
+    }
+
     void Shader::Parser::PragmaDirective(const std::string &currentFile, const std::string &line, int lineNumber, const std::string& pragmaArgument) {
         if (ValidateAgainst("#pragma", pragmaArgument)) {
             ThrowFormattedError(currentFile, line, lineNumber, "#pragma pre-processing directive must be followed by 'once'.", 8);
@@ -414,11 +933,12 @@ namespace GLSL {
         // Track this file for it to be only be included once.
         if (_pragmaInstances.find(currentFile) == _pragmaInstances.end()) {
             _pragmaInstances.insert(currentFile);
-            _pragmaStack.push(std::make_pair(currentFile, lineNumber));
         }
         else {
-            // File has already been included.
+            // File has already been included, skip it until its end.
             _processingExistingInclude = true;
+            _pragmaStack.push(std::make_pair(currentFile, lineNumber));
+            ++_statistics._includesSkipped;
         }
     }
 
@@ -449,6 +969,7 @@ namespace GLSL {
                 // include guard has associated #define, this has already been included.
                 if (includeGuard._includeGuardName == includeGuardName && includeGuard._defineLineNumber != -1) {
                     _processingExistingInclude = true;
+                    ++_statistics._includesSkipped;
                 }
             }
         }
@@ -514,8 +1035,8 @@ namespace GLSL {
     }
 
     void Shader::Parser::ThrowFormattedError(std::string filename, std::string line, int lineNumber, std::string errorMessage, int locationOffset) const {
-        static std::stringstream errorMessageBuilder;
-        errorMessageBuilder.str(std::string()); // Clear.
+        // Local, files may be pre-processed on several threads at once.
+        std::stringstream errorMessageBuilder;
 
         // Clear all newlines.
         EraseNewlines(filename, true);
@@ -545,6 +1066,18 @@ namespace GLSL {
         }
     }
 
+    const std::vector<std::string>& Shader::Parser::GetDependencies() const {
+        return _dependencies;
+    }
+
+    const std::vector<FileStamp>& Shader::Parser::GetDependencyStamps() const {
+        return _dependencyStamps;
+    }
+
+    const PreprocessStatistics& Shader::Parser::GetStatistics() const {
+        return _statistics;
+    }
+
     bool Shader::Parser::ValidateAgainst(const std::string &directiveName, const std::string& token) const {
         // Token cannot be empty, the same as the pre-processor directive (happens when token is empty), or be another pre-processor directive.
         bool condition = token.empty() || directiveName == token || token.front() == '#';
@@ -0,0 +1,199 @@
+
+#include <shader_library_loader.h>
+#include <bounded_queue.h>
+#include <source_overlay.h>
+#include <trace.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace GLSL {
+
+    namespace {
+
+        // Output of the read stage.
+        struct ReadShader {
+            std::size_t _index = 0;
+            std::vector<std::string> _shaderComponentSources;
+            std::vector<FileStamp> _shaderComponentStamps; // Taken before the sources were read.
+            std::string _error;
+        };
+
+        // Output of the pre-processing stage.
+        struct PreprocessedEntry {
+            std::size_t _index = 0;
+            PreprocessedShader _preprocessedShader;
+            std::string _error;
+        };
+
+        std::string ReadFile(const std::string& filepath) {
+            // Overlaid files are taken from memory by the pre-processor.
+            if (SourceOverlay::Contains(filepath)) {
+                return "";
+            }
+
+            std::ifstream inputStream(filepath);
+            if (!inputStream.is_open()) {
+                throw std::runtime_error("Could not open shader file: '" + filepath + "'");
+            }
+
+            std::stringstream contents;
+            contents << inputStream.rdbuf();
+            return contents.str();
+        }
+
+    }
+
+    ShaderLibraryLoader::ShaderLibraryLoader(unsigned readThreadCount, unsigned preprocessThreadCount, std::size_t queueCapacity, bool prewarm) : _readThreadCount(readThreadCount),
+                                                                                                                                                  _preprocessThreadCount(preprocessThreadCount),
+                                                                                                                                                  _queueCapacity(queueCapacity),
+                                                                                                                                                  _prewarm(prewarm) {
+        unsigned hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+        if (_readThreadCount == 0) {
+            _readThreadCount = std::min(2u, hardwareThreads);
+        }
+        // The calling thread compiles, leave it a core.
+        if (_preprocessThreadCount == 0) {
+            _preprocessThreadCount = std::max(1u, hardwareThreads - 1);
+        }
+    }
+
+    void ShaderLibraryLoader::SetSkippedPrograms(ProgramBinaryCache cache) {
+        _skippedPrograms = std::move(cache);
+    }
+
+    std::vector<std::unique_ptr<Shader>> ShaderLibraryLoader::Load(const std::vector<ShaderLibraryEntry>& entries, std::vector<std::string>& errors) const {
+        GLSL_TRACE_SPAN("Load shader library", "pipeline");
+        std::vector<std::unique_ptr<Shader>> shaders(entries.size());
+
+        BoundedQueue<ReadShader> readQueue(_queueCapacity);
+        BoundedQueue<PreprocessedEntry> preprocessedQueue(_queueCapacity);
+
+        std::atomic<std::size_t> nextEntry { 0 };
+        std::atomic<unsigned> activeReadThreads { _readThreadCount };
+        std::atomic<unsigned> activePreprocessThreads { _preprocessThreadCount };
+
+        // Stage 1: file I/O.
+        auto readStage = [&]() {
+            for (std::size_t index = nextEntry++; index < entries.size(); index = nextEntry++) {
+                ReadShader readShader;
+                readShader._index = index;
+
+                try {
+                    GLSL_TRACE_SPAN("Read shader files", "io", entries[index]._name);
+                    for (const std::string& filepath : entries[index]._shaderComponentPaths) {
+                        readShader._shaderComponentStamps.emplace_back(GetFileStamp(filepath));
+                        readShader._shaderComponentSources.emplace_back(ReadFile(filepath));
+                    }
+                }
+                catch (std::runtime_error& exception) {
+                    readShader._error = exception.what();
+                }
+
+                if (!readQueue.Push(std::move(readShader))) {
+                    break;
+                }
+            }
+
+            // Last thread out ends the stage.
+            if (--activeReadThreads == 0) {
+                readQueue.Close();
+            }
+        };
+
+        // Stage 2: pre-processing.
+        auto preprocessStage = [&]() {
+            ReadShader readShader;
+
+            while (readQueue.Pop(readShader)) {
+                PreprocessedEntry preprocessedEntry;
+                preprocessedEntry._index = readShader._index;
+                preprocessedEntry._error = std::move(readShader._error);
+
+                if (preprocessedEntry._error.empty()) {
+                    const ShaderLibraryEntry& entry = entries[readShader._index];
+
+                    // Shaders are already pre-processed in parallel, lexing large files in parallel too would oversubscribe the cores.
+                    try {
+                        preprocessedEntry._preprocessedShader = Shader::PreprocessShader(entry._name, entry._shaderComponentPaths, readShader._shaderComponentSources,
+                                                                                         readShader._shaderComponentStamps, 1);
+                    }
+                    catch (std::runtime_error& exception) {
+                        preprocessedEntry._error = exception.what();
+                    }
+                }
+
+                if (!preprocessedQueue.Push(std::move(preprocessedEntry))) {
+                    break;
+                }
+            }
+
+            if (--activePreprocessThreads == 0) {
+                preprocessedQueue.Close();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < _readThreadCount; ++i) {
+            threads.emplace_back(readStage);
+        }
+        for (unsigned i = 0; i < _preprocessThreadCount; ++i) {
+            threads.emplace_back(preprocessStage);
+        }
+
+        // Stage 3: compiling and linking, on the thread owning the OpenGL context.
+        try {
+            PreprocessedEntry preprocessedEntry;
+
+            while (preprocessedQueue.Pop(preprocessedEntry)) {
+                if (!preprocessedEntry._error.empty()) {
+                    Counters::Increment(Counters::Counter::FailedBuilds);
+                    errors.emplace_back(std::move(preprocessedEntry._error));
+                    continue;
+                }
+
+                try {
+                    if (_skippedPrograms.IsEnabled() && _skippedPrograms.Contains(ProgramBinaryCache::GetKey(preprocessedEntry._preprocessedShader._shaderComponents))) {
+                        continue;
+                    }
+
+                    shaders[preprocessedEntry._index] = std::make_unique<Shader>(std::move(preprocessedEntry._preprocessedShader));
+                }
+                catch (std::runtime_error& exception) {
+                    errors.emplace_back(exception.what());
+                }
+            }
+        }
+        catch (...) {
+            // Unblock every stage before unwinding.
+            readQueue.Close();
+            preprocessedQueue.Close();
+
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            throw;
+        }
+
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        // Pre-warm draws only start once every shader is built, so they do not hold up the pipeline.
+        if (_prewarm) {
+            std::vector<const Shader*> builtShaders;
+            for (const std::unique_ptr<Shader>& shader : shaders) {
+                builtShaders.emplace_back(shader.get());
+            }
+            Shader::Prewarm(builtShaders);
+        }
+
+        return shaders;
+    }
+
+}
@@ -0,0 +1,339 @@
+
+#include <shared_cache.h>
+#include <counters.h>
+#include <sockets.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace GLSL {
+
+    namespace {
+
+        const std::size_t maximumKeyLength = 128;
+        const std::size_t maximumPayloadLength = 256 * 1024 * 1024;
+
+    }
+
+    bool IsValidSharedCacheKey(const std::string& key) {
+        if (key.empty() || key.size() > maximumKeyLength) {
+            return false;
+        }
+
+        return std::all_of(key.begin(), key.end(), [](char character) {
+            return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || (character >= '0' && character <= '9') ||
+                   character == '-' || character == '_';
+        });
+    }
+
+    //------------------------------------------------------------------------------------------------------------------
+    // CLIENT
+    //------------------------------------------------------------------------------------------------------------------
+    SharedCacheClient::SharedCacheClient(const std::string& address, std::chrono::milliseconds timeout, std::chrono::milliseconds retryInterval) : _address(address),
+                                                                                                                                                  _timeout(timeout),
+                                                                                                                                                  _retryInterval(retryInterval),
+                                                                                                                                                  _retryAfter(),
+                                                                                                                                                  _socket(Sockets::InvalidSocket) {
+        std::size_t colonPosition = address.find_last_of(':');
+        if (colonPosition == std::string::npos || colonPosition == 0 || colonPosition + 1 == address.size()) {
+            throw std::runtime_error("Shared cache address must be <host>:<port>: '" + address + "'");
+        }
+
+        _host = address.substr(0, colonPosition);
+        _port = address.substr(colonPosition + 1);
+    }
+
+    SharedCacheClient::~SharedCacheClient() {
+        Disconnect(false);
+    }
+
+    const std::string& SharedCacheClient::GetAddress() const {
+        return _address;
+    }
+
+    bool SharedCacheClient::Get(const std::string& key, std::vector<char>& data) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!IsValidSharedCacheKey(key) || !Connect() || !SendAll("GET " + key + "\n")) {
+            Counters::Increment(Counters::Counter::SharedCacheMisses);
+            return false;
+        }
+
+        std::string line;
+        if (!ReceiveLine(line)) {
+            Counters::Increment(Counters::Counter::SharedCacheMisses);
+            return false;
+        }
+
+        std::istringstream response(line);
+        std::string status;
+        std::size_t length = 0;
+        response >> status >> length;
+
+        if (status == "FOUND" && !response.fail() && length <= maximumPayloadLength && ReceiveExactly(data, length)) {
+            Counters::Increment(Counters::Counter::SharedCacheHits);
+            return true;
+        }
+
+        // Anything but a regular miss leaves the stream in an unknown state.
+        if (status != "MISSING") {
+            Disconnect(true);
+        }
+
+        Counters::Increment(Counters::Counter::SharedCacheMisses);
+        return false;
+    }
+
+    bool SharedCacheClient::Put(const std::string& key, const std::vector<char>& data) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!IsValidSharedCacheKey(key) || data.size() > maximumPayloadLength || !Connect()) {
+            return false;
+        }
+
+        std::string request = "PUT " + key + " " + std::to_string(data.size()) + "\n";
+        request.append(data.begin(), data.end());
+
+        std::string line;
+        if (!SendAll(request) || !ReceiveLine(line)) {
+            return false;
+        }
+
+        if (line != "OK") {
+            Disconnect(true);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool SharedCacheClient::Connect() {
+        if (_socket != Sockets::InvalidSocket) {
+            return true;
+        }
+        if (std::chrono::steady_clock::now() < _retryAfter) {
+            return false;
+        }
+
+        _socket = Sockets::Connect(_host, _port, _timeout);
+        if (_socket == Sockets::InvalidSocket) {
+            Disconnect(true);
+            return false;
+        }
+
+        return true;
+    }
+
+    void SharedCacheClient::Disconnect(bool failed) {
+        if (_socket != Sockets::InvalidSocket) {
+            Sockets::Close(_socket);
+            _socket = Sockets::InvalidSocket;
+        }
+        _received.clear();
+
+        if (failed) {
+            _retryAfter = std::chrono::steady_clock::now() + _retryInterval;
+        }
+    }
+
+    bool SharedCacheClient::SendAll(const std::string& data) {
+        if (!Sockets::SendAll(_socket, data)) {
+            Disconnect(true);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool SharedCacheClient::ReceiveLine(std::string& line) {
+        std::size_t lineEnd = _received.find('\n');
+
+        while (lineEnd == std::string::npos) {
+            if (_received.size() > Sockets::MaximumHeaderLength || !ReceiveMore()) {
+                Disconnect(true);
+                return false;
+            }
+            lineEnd = _received.find('\n');
+        }
+
+        line = _received.substr(0, lineEnd);
+        _received.erase(0, lineEnd + 1);
+        return true;
+    }
+
+    bool SharedCacheClient::ReceiveExactly(std::vector<char>& data, std::size_t size) {
+        while (_received.size() < size) {
+            if (!ReceiveMore()) {
+                Disconnect(true);
+                return false;
+            }
+        }
+
+        data.assign(_received.begin(), _received.begin() + static_cast<std::ptrdiff_t>(size));
+        _received.erase(0, size);
+        return true;
+    }
+
+    bool SharedCacheClient::ReceiveMore() {
+        char buffer[64 * 1024];
+
+        // Times out after _timeout (see Sockets::Connect), 0 is an orderly shutdown by the server.
+        long long received = Sockets::ReceiveSome(_socket, buffer, sizeof(buffer));
+        if (received <= 0) {
+            return false;
+        }
+
+        _received.append(buffer, static_cast<std::size_t>(received));
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------------------
+    // SERVER
+    //------------------------------------------------------------------------------------------------------------------
+    SharedCacheServer::SharedCacheServer(std::string directory, unsigned short port) : _directory(std::move(directory)),
+                                                                                       _listenSocket(Sockets::InvalidSocket),
+                                                                                       _port(port) {
+        std::filesystem::create_directories(_directory);
+        _listenSocket = Sockets::Listen("Shared cache server", _port);
+    }
+
+    SharedCacheServer::~SharedCacheServer() {
+        for (Sockets::Connection& connection : _connections) {
+            Sockets::Close(connection._socket);
+        }
+
+        Sockets::Close(_listenSocket);
+    }
+
+    unsigned short SharedCacheServer::GetPort() const {
+        return _port;
+    }
+
+    const SharedCacheServer::Statistics& SharedCacheServer::GetStatistics() const {
+        return _statistics;
+    }
+
+    void SharedCacheServer::Poll(std::chrono::milliseconds timeout) {
+        Sockets::Wait(_listenSocket, _connections, timeout);
+
+        AcceptConnections();
+
+        for (Sockets::Connection& connection : _connections) {
+            Sockets::Receive(connection);
+            ProcessRequests(connection);
+            Sockets::Send(connection);
+        }
+
+        for (Sockets::Connection& connection : _connections) {
+            if (connection._isClosed) {
+                Sockets::Close(connection._socket);
+            }
+        }
+        _connections.erase(std::remove_if(_connections.begin(), _connections.end(), [](const Sockets::Connection& connection) {
+            return connection._isClosed;
+        }), _connections.end());
+    }
+
+    void SharedCacheServer::AcceptConnections() {
+        for (std::intptr_t clientSocket = Sockets::Accept(_listenSocket); clientSocket != Sockets::InvalidSocket; clientSocket = Sockets::Accept(_listenSocket)) {
+            Sockets::Connection connection;
+            connection._socket = clientSocket;
+            _connections.emplace_back(std::move(connection));
+        }
+    }
+
+    void SharedCacheServer::ProcessRequests(Sockets::Connection& connection) {
+        std::size_t requestStart = 0;
+
+        while (!connection._isClosed) {
+            std::size_t headerEnd = connection._incoming.find('\n', requestStart);
+            if (headerEnd == std::string::npos) {
+                if (connection._incoming.size() - requestStart > Sockets::MaximumHeaderLength) {
+                    connection._isClosed = true;
+                }
+                break;
+            }
+
+            std::istringstream header(connection._incoming.substr(requestStart, headerEnd - requestStart));
+            std::string command;
+            std::string key;
+            std::size_t payloadLength = 0;
+            header >> command >> key;
+            if (command == "PUT") {
+                header >> payloadLength;
+            }
+
+            bool isKnownCommand = command == "GET" || command == "PUT";
+            if (!isKnownCommand || header.fail() || !IsValidSharedCacheKey(key) || payloadLength > maximumPayloadLength) {
+                Sockets::Reject(connection, "Malformed shared cache request: '" + header.str() + "'");
+                break;
+            }
+
+            // Wait for the rest of the payload.
+            std::size_t payloadStart = headerEnd + 1;
+            if (connection._incoming.size() - payloadStart < payloadLength) {
+                break;
+            }
+            requestStart = payloadStart + payloadLength;
+
+            std::string entryPath = GetEntryPath(key);
+
+            if (command == "GET") {
+                std::ifstream inputStream(entryPath, std::ios::binary);
+                if (!inputStream.is_open()) {
+                    connection._outgoing += "MISSING\n";
+                    ++_statistics._misses;
+                    continue;
+                }
+
+                std::stringstream entry;
+                entry << inputStream.rdbuf();
+                std::string entryData = entry.str();
+
+                connection._outgoing += "FOUND " + std::to_string(entryData.size()) + "\n";
+                connection._outgoing += entryData;
+                ++_statistics._hits;
+            }
+            else {
+                // Entries never change, the first one stored under a key is kept.
+                if (std::filesystem::exists(entryPath)) {
+                    connection._outgoing += "OK\n";
+                    ++_statistics._duplicates;
+                    continue;
+                }
+
+                // Written through a temporary file and renamed, so a reader never sees a partial entry.
+                std::string temporaryPath = entryPath + ".tmp";
+                {
+                    std::ofstream outputStream(temporaryPath, std::ios::binary);
+                    outputStream.write(connection._incoming.data() + payloadStart, static_cast<std::streamsize>(payloadLength));
+
+                    if (!outputStream) {
+                        connection._outgoing += Sockets::FormatError("Could not write shared cache entry: '" + temporaryPath + "'");
+                        continue;
+                    }
+                }
+
+                std::error_code error;
+                std::filesystem::rename(temporaryPath, entryPath, error);
+                if (error) {
+                    connection._outgoing += Sockets::FormatError("Could not write shared cache entry: '" + entryPath + "'");
+                    continue;
+                }
+
+                connection._outgoing += "OK\n";
+                ++_statistics._stores;
+            }
+        }
+
+        connection._incoming.erase(0, requestStart);
+    }
+
+    std::string SharedCacheServer::GetEntryPath(const std::string& key) const {
+        return (std::filesystem::path(_directory) / key).string();
+    }
+
+}
@@ -0,0 +1,295 @@
+#include <sockets.h>
+
+#include <stdexcept>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <arpa/inet.h>
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+#endif
+
+namespace GLSL {
+
+    namespace {
+
+        #ifdef _WIN32
+            using NativeSocket = SOCKET;
+
+            int PollSockets(pollfd* sockets, std::size_t count, int milliseconds) {
+                return WSAPoll(sockets, static_cast<ULONG>(count), milliseconds);
+            }
+
+            void SetTimeout(NativeSocket socket, std::chrono::milliseconds timeout) {
+                DWORD milliseconds = static_cast<DWORD>(timeout.count());
+                setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&milliseconds), sizeof(milliseconds));
+                setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&milliseconds), sizeof(milliseconds));
+            }
+        #else
+            using NativeSocket = int;
+
+            int PollSockets(pollfd* sockets, std::size_t count, int milliseconds) {
+                return poll(sockets, static_cast<nfds_t>(count), milliseconds);
+            }
+
+            void SetTimeout(NativeSocket socket, std::chrono::milliseconds timeout) {
+                timeval time { };
+                time.tv_sec = static_cast<decltype(time.tv_sec)>(timeout.count() / 1000);
+                time.tv_usec = static_cast<decltype(time.tv_usec)>((timeout.count() % 1000) * 1000);
+                setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &time, sizeof(time));
+                setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &time, sizeof(time));
+            }
+        #endif
+
+        // Broken connections are detected by the return value, not by SIGPIPE.
+        #ifdef MSG_NOSIGNAL
+            const int sendFlags = MSG_NOSIGNAL;
+        #else
+            const int sendFlags = 0;
+        #endif
+
+        bool IsValid(NativeSocket socket) {
+            #ifdef _WIN32
+                return socket != INVALID_SOCKET;
+            #else
+                return socket >= 0;
+            #endif
+        }
+
+    }
+
+    #ifdef _WIN32
+        bool Sockets::Initialize() {
+            static const bool isWinsockInitialized = [] {
+                WSADATA winsockData;
+                return WSAStartup(MAKEWORD(2, 2), &winsockData) == 0;
+            }();
+            return isWinsockInitialized;
+        }
+
+        bool Sockets::WouldBlock() {
+            int error = WSAGetLastError();
+            return error == WSAEWOULDBLOCK || error == WSAEINPROGRESS;
+        }
+
+        void Sockets::Close(std::intptr_t socket) {
+            closesocket(static_cast<NativeSocket>(socket));
+        }
+
+        bool Sockets::SetNonBlocking(std::intptr_t socket, bool nonBlocking) {
+            u_long mode = nonBlocking ? 1 : 0;
+            return ioctlsocket(static_cast<NativeSocket>(socket), FIONBIO, &mode) == 0;
+        }
+    #else
+        bool Sockets::Initialize() {
+            return true;
+        }
+
+        bool Sockets::WouldBlock() {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS;
+        }
+
+        void Sockets::Close(std::intptr_t socket) {
+            close(static_cast<NativeSocket>(socket));
+        }
+
+        bool Sockets::SetNonBlocking(std::intptr_t socket, bool nonBlocking) {
+            int flags = fcntl(static_cast<NativeSocket>(socket), F_GETFL, 0);
+            if (flags == -1) {
+                return false;
+            }
+
+            flags = nonBlocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+            return fcntl(static_cast<NativeSocket>(socket), F_SETFL, flags) == 0;
+        }
+    #endif
+
+    std::intptr_t Sockets::Connect(const std::string& host, const std::string& port, std::chrono::milliseconds timeout) {
+        if (!Initialize()) {
+            return InvalidSocket;
+        }
+
+        addrinfo hints { };
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+
+        addrinfo* addresses = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+            return InvalidSocket;
+        }
+
+        std::intptr_t connectedSocket = InvalidSocket;
+        for (addrinfo* address = addresses; address && connectedSocket == InvalidSocket; address = address->ai_next) {
+            NativeSocket clientSocket = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (!IsValid(clientSocket)) {
+                continue;
+            }
+            std::intptr_t candidate = static_cast<std::intptr_t>(clientSocket);
+
+            // Connect without blocking, to bound the time an unreachable server costs. poll() instead of select(),
+            // descriptors beyond FD_SETSIZE are common in large build processes.
+            bool isConnected = false;
+            if (SetNonBlocking(candidate, true)) {
+                if (connect(clientSocket, address->ai_addr, static_cast<socklen_t>(address->ai_addrlen)) == 0) {
+                    isConnected = true;
+                }
+                else if (WouldBlock()) {
+                    pollfd pollSocket { };
+                    pollSocket.fd = clientSocket;
+                    pollSocket.events = POLLOUT;
+
+                    int error = 0;
+                    socklen_t errorLength = sizeof(error);
+                    isConnected = PollSockets(&pollSocket, 1, static_cast<int>(timeout.count())) == 1 &&
+                                  getsockopt(clientSocket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &errorLength) == 0 && error == 0;
+                }
+            }
+
+            if (isConnected && SetNonBlocking(candidate, false)) {
+                SetTimeout(clientSocket, timeout);
+                connectedSocket = candidate;
+            }
+            else {
+                Close(candidate);
+            }
+        }
+
+        freeaddrinfo(addresses);
+        return connectedSocket;
+    }
+
+    bool Sockets::SendAll(std::intptr_t socket, const std::string& data) {
+        std::size_t sentTotal = 0;
+
+        while (sentTotal < data.size()) {
+            auto sent = send(static_cast<NativeSocket>(socket), data.data() + sentTotal, static_cast<int>(data.size() - sentTotal), sendFlags);
+            if (sent <= 0) {
+                return false;
+            }
+
+            sentTotal += static_cast<std::size_t>(sent);
+        }
+
+        return true;
+    }
+
+    long long Sockets::ReceiveSome(std::intptr_t socket, char* buffer, std::size_t size) {
+        return static_cast<long long>(recv(static_cast<NativeSocket>(socket), buffer, static_cast<int>(size), 0));
+    }
+
+    std::intptr_t Sockets::Listen(const std::string& name, unsigned short& port) {
+        if (!Initialize()) {
+            throw std::runtime_error(name + ": failed to initialize sockets.");
+        }
+
+        NativeSocket listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (!IsValid(listenSocket)) {
+            throw std::runtime_error(name + ": failed to create socket.");
+        }
+
+        // Allow restarting while connections of the previous instance linger.
+        int reuseAddress = 1;
+        setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuseAddress), sizeof(reuseAddress));
+
+        sockaddr_in address { };
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+
+        socklen_t addressLength = sizeof(address);
+        if (bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listenSocket, SOMAXCONN) != 0 ||
+            !SetNonBlocking(static_cast<std::intptr_t>(listenSocket), true) ||
+            getsockname(listenSocket, reinterpret_cast<sockaddr*>(&address), &addressLength) != 0) {
+            Close(static_cast<std::intptr_t>(listenSocket));
+            throw std::runtime_error(name + ": failed to listen on 127.0.0.1:" + std::to_string(port) + ".");
+        }
+
+        port = ntohs(address.sin_port);
+        return static_cast<std::intptr_t>(listenSocket);
+    }
+
+    std::intptr_t Sockets::Accept(std::intptr_t listenSocket) {
+        while (true) {
+            NativeSocket clientSocket = accept(static_cast<NativeSocket>(listenSocket), nullptr, nullptr);
+            if (!IsValid(clientSocket)) {
+                return InvalidSocket;
+            }
+
+            if (SetNonBlocking(static_cast<std::intptr_t>(clientSocket), true)) {
+                return static_cast<std::intptr_t>(clientSocket);
+            }
+
+            Close(static_cast<std::intptr_t>(clientSocket));
+        }
+    }
+
+    void Sockets::Wait(std::intptr_t listenSocket, const std::vector<Connection>& connections, std::chrono::milliseconds timeout) {
+        std::vector<pollfd> pollSockets(connections.size() + 1);
+
+        pollSockets[0].fd = static_cast<NativeSocket>(listenSocket);
+        pollSockets[0].events = POLLIN;
+        for (std::size_t i = 0; i < connections.size(); ++i) {
+            pollSockets[i + 1].fd = static_cast<NativeSocket>(connections[i]._socket);
+            pollSockets[i + 1].events = connections[i]._outgoing.empty() ? POLLIN : POLLIN | POLLOUT;
+        }
+
+        PollSockets(pollSockets.data(), pollSockets.size(), static_cast<int>(timeout.count()));
+    }
+
+    void Sockets::Receive(Connection& connection) {
+        char buffer[64 * 1024];
+
+        while (!connection._isClosed) {
+            auto received = recv(static_cast<NativeSocket>(connection._socket), buffer, sizeof(buffer), 0);
+
+            if (received > 0) {
+                connection._incoming.append(buffer, static_cast<std::size_t>(received));
+            }
+            else {
+                // 0 is an orderly shutdown by the peer.
+                if (received == 0 || !WouldBlock()) {
+                    connection._isClosed = true;
+                }
+                return;
+            }
+        }
+    }
+
+    void Sockets::Send(Connection& connection) {
+        while (!connection._outgoing.empty() && !connection._isClosed) {
+            auto sent = send(static_cast<NativeSocket>(connection._socket), connection._outgoing.data(), static_cast<int>(connection._outgoing.size()), sendFlags);
+
+            if (sent > 0) {
+                connection._outgoing.erase(0, static_cast<std::size_t>(sent));
+            }
+            else {
+                // Remaining output is sent on the next call.
+                if (!WouldBlock()) {
+                    connection._isClosed = true;
+                }
+                return;
+            }
+        }
+    }
+
+    std::string Sockets::FormatError(const std::string& message) {
+        return "ERROR " + std::to_string(message.size()) + "\n" + message;
+    }
+
+    void Sockets::Reject(Connection& connection, const std::string& message) {
+        connection._outgoing += FormatError(message);
+        Send(connection);
+        connection._isClosed = true;
+    }
+
+}
@@ -0,0 +1,193 @@
+
+#include <source_overlay.h>
+#include <lexer.h>
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace GLSL {
+
+    namespace {
+
+        struct OverlayFile {
+            std::vector<std::string> _lines;          // Lines as written, without newlines.
+            LexedSource _lexedSource;                 // Lines with comments stripped, index matches _lines.
+            std::vector<Lexer::State> _lineEndStates; // Comment state at the end of every line.
+            std::uint64_t _generation = 0;
+            bool _isOpen = false;                     // Closed files are kept for their generation.
+        };
+
+        std::mutex overlayMutex;
+        std::unordered_map<std::string, OverlayFile> overlayFiles;
+        std::uint64_t currentGeneration = 0;
+
+        // Lets pre-processing skip path normalization while no file is overlaid.
+        std::atomic<std::size_t> openFileCount { 0 };
+
+        std::vector<std::string> SplitLines(const std::string& text) {
+            std::vector<std::string> lines;
+            std::size_t lineStart = 0;
+
+            for (std::size_t newline = text.find('\n'); newline != std::string::npos; newline = text.find('\n', lineStart)) {
+                lines.emplace_back(text.substr(lineStart, newline - lineStart));
+                lineStart = newline + 1;
+            }
+            lines.emplace_back(text.substr(lineStart));
+
+            return lines;
+        }
+
+        // Lexes the lines of file starting at firstLine. Lines from lastLine on are only re-lexed until their comment
+        // state at the end of the line is unchanged, the lines after that are unaffected.
+        void LexLines(OverlayFile& file, std::size_t firstLine, std::size_t lastLine) {
+            Lexer::State state = firstLine > 0 ? file._lineEndStates[firstLine - 1] : Lexer::State::Code;
+
+            for (std::size_t i = firstLine; i < file._lines.size(); ++i) {
+                std::string& lexedLine = file._lexedSource._lines[i];
+                lexedLine.clear();
+                state = Lexer::LexLine(file._lines[i], state, lexedLine);
+
+                bool isUnchanged = i >= lastLine && state == file._lineEndStates[i];
+                file._lineEndStates[i] = state;
+                if (isUnchanged) {
+                    break;
+                }
+            }
+
+            file._lexedSource._directiveLines.clear();
+            for (std::size_t i = 0; i < file._lexedSource._lines.size(); ++i) {
+                if (Lexer::IsDirective(file._lexedSource._lines[i])) {
+                    file._lexedSource._directiveLines.emplace_back(i);
+                }
+            }
+        }
+
+    }
+
+    void SourceOverlay::Open(const std::string& filepath, const std::string& contents) {
+        OverlayFile openedFile;
+        openedFile._lines = SplitLines(contents);
+        openedFile._lexedSource._lines.resize(openedFile._lines.size());
+        openedFile._lineEndStates.resize(openedFile._lines.size());
+        LexLines(openedFile, 0, openedFile._lines.size());
+        std::string key = GetKey(filepath);
+
+        std::lock_guard<std::mutex> lock(overlayMutex);
+        OverlayFile& file = overlayFiles[key];
+        if (!file._isOpen) {
+            ++openFileCount;
+        }
+
+        file = std::move(openedFile);
+        file._generation = ++currentGeneration;
+        file._isOpen = true;
+    }
+
+    void SourceOverlay::Edit(const std::string& filepath, int startLine, int startColumn, int endLine, int endColumn, const std::string& text) {
+        std::string key = GetKey(filepath);
+        std::lock_guard<std::mutex> lock(overlayMutex);
+
+        auto fileIt = overlayFiles.find(key);
+        if (fileIt == overlayFiles.end() || !fileIt->second._isOpen) {
+            throw std::runtime_error("Cannot edit file that is not open: '" + filepath + "'");
+        }
+
+        OverlayFile& file = fileIt->second;
+        bool validRange = startLine >= 0 && startColumn >= 0 && endColumn >= 0 &&
+                          (startLine < endLine || (startLine == endLine && startColumn <= endColumn)) &&
+                          endLine < static_cast<int>(file._lines.size()) &&
+                          startColumn <= static_cast<int>(file._lines[startLine].size()) &&
+                          endColumn <= static_cast<int>(file._lines[endLine].size());
+        if (!validRange) {
+            throw std::runtime_error("Edit range " + std::to_string(startLine) + ":" + std::to_string(startColumn) + "-" +
+                                     std::to_string(endLine) + ":" + std::to_string(endColumn) + " is out of bounds in file: '" + filepath + "'");
+        }
+
+        // Lines touched by the edit are re-lexed, followed by the lines whose block comment state it changed.
+        std::vector<std::string> editedLines = SplitLines(file._lines[startLine].substr(0, startColumn) + text + file._lines[endLine].substr(endColumn));
+        std::size_t editedLineCount = editedLines.size();
+        std::vector<std::string>& lexedLines = file._lexedSource._lines;
+
+        file._lines.erase(file._lines.begin() + startLine, file._lines.begin() + endLine + 1);
+        file._lines.insert(file._lines.begin() + startLine, std::make_move_iterator(editedLines.begin()), std::make_move_iterator(editedLines.end()));
+        lexedLines.erase(lexedLines.begin() + startLine, lexedLines.begin() + endLine + 1);
+        lexedLines.insert(lexedLines.begin() + startLine, editedLineCount, std::string());
+        file._lineEndStates.erase(file._lineEndStates.begin() + startLine, file._lineEndStates.begin() + endLine + 1);
+        file._lineEndStates.insert(file._lineEndStates.begin() + startLine, editedLineCount, Lexer::State::Code);
+
+        LexLines(file, startLine, startLine + editedLineCount);
+
+        file._generation = ++currentGeneration;
+    }
+
+    void SourceOverlay::Close(const std::string& filepath) {
+        std::string key = GetKey(filepath);
+        std::lock_guard<std::mutex> lock(overlayMutex);
+
+        auto fileIt = overlayFiles.find(key);
+        if (fileIt != overlayFiles.end() && fileIt->second._isOpen) {
+            --openFileCount;
+            fileIt->second = OverlayFile();
+            fileIt->second._generation = ++currentGeneration;
+        }
+    }
+
+    void SourceOverlay::CloseAll() {
+        std::lock_guard<std::mutex> lock(overlayMutex);
+
+        for (auto& overlayFile : overlayFiles) {
+            if (overlayFile.second._isOpen) {
+                overlayFile.second = OverlayFile();
+                overlayFile.second._generation = ++currentGeneration;
+            }
+        }
+
+        openFileCount = 0;
+    }
+
+    bool SourceOverlay::Contains(const std::string& filepath) {
+        if (openFileCount == 0) {
+            return false;
+        }
+
+        std::string key = GetKey(filepath);
+        std::lock_guard<std::mutex> lock(overlayMutex);
+
+        auto fileIt = overlayFiles.find(key);
+        return fileIt != overlayFiles.end() && fileIt->second._isOpen;
+    }
+
+    bool SourceOverlay::GetLexedSource(const std::string& filepath, LexedSource& lexedSource) {
+        if (openFileCount == 0) {
+            return false;
+        }
+
+        std::string key = GetKey(filepath);
+        std::lock_guard<std::mutex> lock(overlayMutex);
+
+        auto fileIt = overlayFiles.find(key);
+        if (fileIt == overlayFiles.end() || !fileIt->second._isOpen) {
+            return false;
+        }
+
+        lexedSource = fileIt->second._lexedSource;
+        return true;
+    }
+
+    std::uint64_t SourceOverlay::GetGeneration(const std::string& filepath) {
+        std::string key = GetKey(filepath);
+        std::lock_guard<std::mutex> lock(overlayMutex);
+
+        auto fileIt = overlayFiles.find(key);
+        return fileIt != overlayFiles.end() ? fileIt->second._generation : 0;
+    }
+
+    std::string SourceOverlay::GetKey(const std::string& filepath) {
+        return std::filesystem::absolute(filepath).lexically_normal().string();
+    }
+
+}
@@ -0,0 +1,329 @@
+
+#include <stress_benchmark.h>
+#include <draw_batcher.h>
+#include <shader.h>
+#include <gpu_profiler.h>
+#include <recording_gl.h>
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace GLSL {
+
+    namespace {
+
+        struct CallCategory {
+            const char* _name;
+            std::vector<RecordingGL::Function> _functions;
+        };
+
+        const std::vector<CallCategory> callCategories {
+            { "program binds", { RecordingGL::Function::UseProgram } },
+            { "uniform uploads", { RecordingGL::Function::Uniform1i, RecordingGL::Function::Uniform1f, RecordingGL::Function::Uniform2fv,
+                                   RecordingGL::Function::Uniform3fv, RecordingGL::Function::Uniform4fv, RecordingGL::Function::UniformMatrix3fv,
+                                   RecordingGL::Function::UniformMatrix4fv } },
+            { "uniform location lookups", { RecordingGL::Function::GetUniformLocation } },
+            { "shader build", { RecordingGL::Function::CreateShader, RecordingGL::Function::DeleteShader, RecordingGL::Function::ShaderSource,
+                                RecordingGL::Function::CompileShader, RecordingGL::Function::GetShaderiv, RecordingGL::Function::GetShaderInfoLog,
+                                RecordingGL::Function::CreateProgram, RecordingGL::Function::DeleteProgram, RecordingGL::Function::AttachShader,
+                                RecordingGL::Function::DetachShader, RecordingGL::Function::LinkProgram, RecordingGL::Function::GetProgramiv,
+                                RecordingGL::Function::GetProgramInfoLog, RecordingGL::Function::ProgramParameteri,
+                                RecordingGL::Function::GetProgramBinary, RecordingGL::Function::ProgramBinary, RecordingGL::Function::GetActiveAttrib,
+                                RecordingGL::Function::GetAttribLocation } },
+            { "queries", { RecordingGL::Function::GetString, RecordingGL::Function::GetIntegerv, RecordingGL::Function::GetStringi, RecordingGL::Function::GenQueries,
+                           RecordingGL::Function::DeleteQueries, RecordingGL::Function::BeginQuery, RecordingGL::Function::EndQuery,
+                           RecordingGL::Function::GetQueryObjectiv, RecordingGL::Function::GetQueryObjectui64v } },
+            { "buffers and batched draws", { RecordingGL::Function::GenBuffers, RecordingGL::Function::DeleteBuffers, RecordingGL::Function::BindBuffer,
+                                             RecordingGL::Function::BufferData, RecordingGL::Function::BindBufferBase,
+                                             RecordingGL::Function::DrawElementsInstancedBaseVertex, RecordingGL::Function::MultiDrawElementsIndirect,
+                                             RecordingGL::Function::DrawArrays } },
+            { "framebuffers and vertex arrays", { RecordingGL::Function::GenFramebuffers, RecordingGL::Function::DeleteFramebuffers,
+                                                  RecordingGL::Function::BindFramebuffer, RecordingGL::Function::GenRenderbuffers,
+                                                  RecordingGL::Function::DeleteRenderbuffers, RecordingGL::Function::BindRenderbuffer,
+                                                  RecordingGL::Function::RenderbufferStorage, RecordingGL::Function::FramebufferRenderbuffer,
+                                                  RecordingGL::Function::GenVertexArrays, RecordingGL::Function::DeleteVertexArrays,
+                                                  RecordingGL::Function::BindVertexArray, RecordingGL::Function::EnableVertexAttribArray,
+                                                  RecordingGL::Function::VertexAttribPointer, RecordingGL::Function::VertexAttribIPointer,
+                                                  RecordingGL::Function::Viewport } },
+            { "debug output", { RecordingGL::Function::Enable, RecordingGL::Function::Disable, RecordingGL::Function::DebugMessageCallback,
+                                RecordingGL::Function::DebugMessageControl } },
+        };
+
+        // Runs the given function when leaving the scope, so that every exit releases the benchmark's resources.
+        template <typename Function>
+        class ScopeExit {
+            public:
+                explicit ScopeExit(Function function) : _function(std::move(function)) { }
+                ~ScopeExit() { _function(); }
+
+                ScopeExit(const ScopeExit&) = delete;
+                ScopeExit& operator=(const ScopeExit&) = delete;
+
+            private:
+                Function _function;
+        };
+
+        double GetPercentile(std::vector<double> samples, double percentile) {
+            std::size_t index = static_cast<std::size_t>(percentile * static_cast<double>(samples.size() - 1) + 0.5);
+            std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+            return samples[index];
+        }
+
+    }
+
+    int RunStressBenchmark(const StressBenchmarkSettings& settings, std::chrono::steady_clock::time_point startTime) {
+        // Count every Shader OpenGL call while forwarding to the driver.
+        RecordingGL recordingGL(GetGladDispatch());
+        recordingGL.SetCaptureUniforms(false);
+        recordingGL.Install();
+
+        // Offscreen render target, so no window system presentation (or vsync) is involved.
+        GLuint framebuffer, colorBuffer, depthBuffer;
+        glGenFramebuffers(1, &framebuffer);
+        glGenRenderbuffers(1, &colorBuffer);
+        glGenRenderbuffers(1, &depthBuffer);
+        ScopeExit deleteRenderTarget([&]() {
+            glDeleteRenderbuffers(1, &depthBuffer);
+            glDeleteRenderbuffers(1, &colorBuffer);
+            glDeleteFramebuffers(1, &framebuffer);
+        });
+
+        glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, settings._width, settings._height);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, settings._width, settings._height);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Failed to create offscreen framebuffer." << std::endl;
+            return 1;
+        }
+
+        glViewport(0, 0, settings._width, settings._height);
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_CULL_FACE);
+        glCullFace(GL_BACK);
+
+        // Shaders. Draw batching is process-wide, it is reset once the shaders are destroyed.
+        Shader::SetDrawBatching(settings._batchDraws);
+        ScopeExit resetDrawBatching([]() {
+            Shader::SetDrawBatching(false);
+        });
+
+        std::vector<std::unique_ptr<Shader>> shaders;
+        std::vector<std::unique_ptr<DrawBatcher>> batchers;
+
+        try {
+            for (int i = 0; i < settings._shaderCount; ++i) {
+                shaders.emplace_back(new Shader("Stress" + std::to_string(i), { "assets/shaders/color.vert", "assets/shaders/color.frag" }));
+                if (settings._batchDraws) {
+                    batchers.emplace_back(new DrawBatcher(*shaders.back()));
+                }
+            }
+        }
+        catch (std::runtime_error& exception) {
+            std::cerr << exception.what() << std::endl;
+            return 1;
+        }
+
+        // Cube mesh.
+        std::vector<glm::vec3> vertices {
+            { -0.5f, -0.5f, -0.5f }, { -0.5f, -0.5f, 0.5f }, { -0.5f, 0.5f, -0.5f }, { -0.5f, 0.5f, 0.5f },
+            { 0.5f, -0.5f, -0.5f }, { 0.5f, -0.5f, 0.5f }, { 0.5f, 0.5f, -0.5f }, { 0.5f, 0.5f, 0.5f },
+        };
+        std::vector<unsigned> indices {
+            0, 1, 3, 0, 3, 2, 1, 5, 7, 1, 7, 3, 3, 7, 6, 3, 6, 2,
+            4, 0, 2, 4, 2, 6, 5, 4, 6, 5, 6, 7, 0, 4, 5, 0, 5, 1
+        };
+
+        GLuint vao, vbo, ebo;
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glGenBuffers(1, &ebo);
+        ScopeExit deleteMesh([&]() {
+            glDeleteBuffers(1, &ebo);
+            glDeleteBuffers(1, &vbo);
+            glDeleteVertexArrays(1, &vao);
+        });
+
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), nullptr);
+        glEnableVertexAttribArray(0);
+        GLsizei indexCount = static_cast<GLsizei>(indices.size());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned), indices.data(), GL_STATIC_DRAW);
+
+        glm::mat4 cameraMatrix = glm::perspective(glm::radians(60.0f), static_cast<float>(settings._width) / static_cast<float>(settings._height), 0.1f, 100.0f) *
+                                 glm::lookAt(glm::vec3(0.0f, 2.0f, 4.0f), glm::vec3(0.0f, -2.0f, -4.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        // Calls issued outside of Shader. Batched draws are counted as requested, before the batcher merges them.
+        std::uint64_t drawCalls = 0;
+        std::uint64_t frameCalls = 0;
+
+        std::vector<double> frameTimes;
+        frameTimes.reserve(settings._frameCount);
+        double timeToFirstFrame = 0.0;
+
+        if (settings._gpuProfiling) {
+            GPUProfiler::Enable();
+        }
+
+        recordingGL.Reset();
+
+        for (int frame = 0; frame < settings._frameCount; ++frame) {
+            auto frameStart = std::chrono::steady_clock::now();
+
+            glClearColor(0.0f, 20.0f / 255.0f, 40.0f / 255.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            frameCalls += 2;
+
+            // Same draws and uniforms, grouped per shader. The camera does not change within a frame, so setting it per
+            // draw does not split the batch (see DrawBatcher::SetUniform).
+            for (std::size_t batch = 0; batch < batchers.size(); ++batch) {
+                DrawBatcher& batcher = *batchers[batch];
+                batcher.Begin();
+
+                for (int draw = static_cast<int>(batch); draw < settings._drawsPerFrame; draw += static_cast<int>(batchers.size())) {
+                    float offset = static_cast<float>(draw % 100) * 0.01f;
+                    glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(offset, 0.0f, -offset)) *
+                                            glm::rotate(glm::radians(static_cast<float>(frame + draw)), glm::vec3(0.0f, 1.0f, 0.0f));
+
+                    for (int uniform = 0; uniform < settings._uniformsPerDraw; ++uniform) {
+                        switch (uniform % 3) {
+                            case 0:
+                                batcher.SetUniform("modelTransform", modelMatrix);
+                                break;
+                            case 1:
+                                batcher.SetUniform("cameraTransform", cameraMatrix);
+                                break;
+                            default:
+                                batcher.SetUniform("surfaceColor", glm::vec3(1.0f, 0.45f, offset));
+                                break;
+                        }
+                    }
+
+                    batcher.Draw(indexCount);
+                    ++drawCalls;
+                }
+
+                batcher.End();
+            }
+
+            for (int draw = 0; draw < settings._drawsPerFrame && !settings._batchDraws; ++draw) {
+                Shader& shader = *shaders[draw % shaders.size()];
+                float offset = static_cast<float>(draw % 100) * 0.01f;
+                glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(offset, 0.0f, -offset)) *
+                                        glm::rotate(glm::radians(static_cast<float>(frame + draw)), glm::vec3(0.0f, 1.0f, 0.0f));
+
+                shader.Bind();
+
+                // Cycle through the uniforms declared by the color shaders.
+                for (int uniform = 0; uniform < settings._uniformsPerDraw; ++uniform) {
+                    switch (uniform % 3) {
+                        case 0:
+                            shader.SetUniform("modelTransform", modelMatrix);
+                            break;
+                        case 1:
+                            shader.SetUniform("cameraTransform", cameraMatrix);
+                            break;
+                        default:
+                            shader.SetUniform("surfaceColor", glm::vec3(1.0f, 0.45f, offset));
+                            break;
+                    }
+                }
+
+                glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr);
+                ++drawCalls;
+
+                shader.Unbind();
+            }
+
+            // Wait for the GPU so frame times include rendering, not just submission.
+            glFinish();
+            ++frameCalls;
+
+            if (settings._gpuProfiling) {
+                GPUProfiler::Collect();
+            }
+
+            auto frameEnd = std::chrono::steady_clock::now();
+            frameTimes.emplace_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+
+            if (frame == 0) {
+                timeToFirstFrame = std::chrono::duration<double, std::milli>(frameEnd - startTime).count();
+            }
+        }
+
+        // Report.
+        double frames = static_cast<double>(std::max(settings._frameCount, 1));
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "shaders: " << settings._shaderCount << ", draws/frame: " << settings._drawsPerFrame
+                  << ", uniforms/draw: " << settings._uniformsPerDraw << ", frames: " << settings._frameCount
+                  << ", resolution: " << settings._width << "x" << settings._height << (settings._batchDraws ? ", batched" : "") << std::endl;
+        std::cout << "renderer: " << glGetString(GL_RENDERER) << std::endl;
+        std::cout << "time to first frame: " << timeToFirstFrame << " ms" << std::endl;
+
+        if (!frameTimes.empty()) {
+            std::cout << "frame time p50: " << GetPercentile(frameTimes, 0.50) << " ms" << std::endl;
+            std::cout << "frame time p90: " << GetPercentile(frameTimes, 0.90) << " ms" << std::endl;
+            std::cout << "frame time p99: " << GetPercentile(frameTimes, 0.99) << " ms" << std::endl;
+            std::cout << "frame time max: " << *std::max_element(frameTimes.begin(), frameTimes.end()) << " ms" << std::endl;
+        }
+
+        std::cout << "GL calls per frame:" << std::endl;
+        for (const CallCategory& category : callCategories) {
+            std::uint64_t calls = 0;
+            for (RecordingGL::Function function : category._functions) {
+                calls += recordingGL.GetCallCount(function);
+            }
+
+            std::cout << "    " << std::left << std::setw(28) << category._name << std::right << calls / frames << std::endl;
+        }
+        std::cout << "    " << std::left << std::setw(28) << "draws" << std::right << drawCalls / frames << std::endl;
+        std::cout << "    " << std::left << std::setw(28) << "frame (clear, finish)" << std::right << frameCalls / frames << std::endl;
+
+        if (settings._gpuProfiling) {
+            GPUProfiler::Collect();
+
+            // Most expensive shaders first.
+            std::vector<GPUProfiler::ShaderStatistics> gpuStatistics = GPUProfiler::GetStatistics();
+            std::sort(gpuStatistics.begin(), gpuStatistics.end(), [](const GPUProfiler::ShaderStatistics& first, const GPUProfiler::ShaderStatistics& second) {
+                return first._totalNanoseconds > second._totalNanoseconds;
+            });
+
+            std::cout << "GPU time per shader (ms per frame, us per bind):" << std::endl;
+            for (const GPUProfiler::ShaderStatistics& statistics : gpuStatistics) {
+                double averageMicroseconds = statistics._samples ? static_cast<double>(statistics._totalNanoseconds) / static_cast<double>(statistics._samples) / 1000.0 : 0.0;
+                std::cout << "    " << std::left << std::setw(28) << statistics._shaderName << std::right
+                          << static_cast<double>(statistics._totalNanoseconds) / 1.0e6 / frames << ", " << averageMicroseconds << std::endl;
+
+                if (GPUProfiler::HasPipelineStatistics()) {
+                    for (std::size_t i = 0; i < statistics._pipelineStatistics.size(); ++i) {
+                        std::cout << "        " << std::left << std::setw(32) << GPUProfiler::GetPipelineStatisticName(static_cast<GPUProfiler::PipelineStatistic>(i))
+                                  << std::right << static_cast<double>(statistics._pipelineStatistics[i]) / frames << std::endl;
+                    }
+                }
+            }
+            if (GPUProfiler::GetDroppedScopes() > 0) {
+                std::cout << "    dropped scopes: " << GPUProfiler::GetDroppedScopes() << std::endl;
+            }
+
+            GPUProfiler::Disable();
+        }
+
+        return 0;
+    }
+
+}
@@ -0,0 +1,103 @@
+
+#include <trace.h>
+#include <util.h>
+
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace GLSL {
+
+    // Static initialization.
+    std::atomic<bool> Trace::_enabled { false };
+
+    namespace {
+
+        struct TraceEvent {
+            const char* _name;
+            const char* _category;
+            std::string _shaderName;
+            std::string _filepath;
+            long long _timestamp; // Microseconds since the trace epoch.
+            long long _duration;  // Microseconds.
+            int _threadID;
+        };
+
+        std::mutex traceMutex;
+        std::vector<TraceEvent> traceEvents;
+        std::unordered_map<std::thread::id, int> threadIDs;
+        const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+        // Returns a small, stable identifier for the calling thread. Must be called with traceMutex held.
+        int GetThreadID() {
+            return threadIDs.emplace(std::this_thread::get_id(), static_cast<int>(threadIDs.size()) + 1).first->second;
+        }
+
+    }
+
+    Trace::Span::Span(const char* name, const char* category, const std::string& shaderName, const std::string& filepath) : _active(Trace::IsEnabled()),
+                                                                                                                            _name(name),
+                                                                                                                            _category(category) {
+        // Avoid copying arguments when tracing is disabled.
+        if (_active) {
+            _shaderName = shaderName;
+            _filepath = filepath;
+            _start = std::chrono::steady_clock::now();
+        }
+    }
+
+    Trace::Span::~Span() {
+        if (!_active) {
+            return;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        long long timestamp = std::chrono::duration_cast<std::chrono::microseconds>(_start - traceEpoch).count();
+        long long duration = std::chrono::duration_cast<std::chrono::microseconds>(end - _start).count();
+
+        std::lock_guard<std::mutex> lock(traceMutex);
+        traceEvents.push_back({ _name, _category, std::move(_shaderName), std::move(_filepath), timestamp, duration, GetThreadID() });
+    }
+
+    void Trace::Enable() {
+        _enabled.store(true, std::memory_order_relaxed);
+    }
+
+    void Trace::Disable() {
+        _enabled.store(false, std::memory_order_relaxed);
+    }
+
+    bool Trace::IsEnabled() {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    void Trace::WriteChromeTrace(const std::string& filepath) {
+        std::ofstream outputStream(filepath);
+        if (!outputStream.is_open()) {
+            throw std::runtime_error("Could not open trace file: '" + filepath + "'");
+        }
+
+        std::lock_guard<std::mutex> lock(traceMutex);
+
+        outputStream << "{\"traceEvents\":[";
+        for (std::size_t i = 0; i < traceEvents.size(); ++i) {
+            const TraceEvent& event = traceEvents[i];
+
+            outputStream << (i == 0 ? "\n" : ",\n");
+            outputStream << "{\"name\":\"" << EscapeJSON(event._name) << "\",\"cat\":\"" << EscapeJSON(event._category) << "\""
+                         << ",\"ph\":\"X\",\"ts\":" << event._timestamp << ",\"dur\":" << event._duration
+                         << ",\"pid\":1,\"tid\":" << event._threadID
+                         << ",\"args\":{\"shader\":\"" << EscapeJSON(event._shaderName) << "\",\"file\":\"" << EscapeJSON(event._filepath) << "\"}}";
+        }
+        outputStream << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+    }
+
+    void Trace::Clear() {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        traceEvents.clear();
+    }
+
+}
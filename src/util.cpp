@@ -1,6 +1,8 @@
 
 #include <util.h>
+#include <source_overlay.h>
 #include <filesystem>
+#include <fstream>
 
 namespace GLSL {
 
@@ -59,40 +61,20 @@ namespace GLSL {
     }
 
     void EraseNewlines(std::string& line, bool eraseLast) {
-        std::size_t previousItPosition = 0;
-        bool previousIsNL = false;
+        // Compact in place, in a single pass: leading newlines are dropped and runs of newlines collapse into one.
+        std::size_t length = 0;
 
-        while (previousItPosition != line.size()) {
-            // Clear newline if line begins with one.
-            if (line.front() == '\n') {
-                line.erase(line.begin());
+        for (char character : line) {
+            if (character == '\n' && (length == 0 || line[length - 1] == '\n')) {
                 continue;
             }
 
-            for (auto it = line.begin() + previousItPosition; it != line.end(); ++it, ++previousItPosition) {
-                char character = *it;
-
-                // Newline processing.
-                if (character == '\n') {
-                    // Remove duplicate newlines.
-                    if (previousIsNL) {
-                        line.erase(it);
-                        break;
-                    }
-                    else {
-                        previousIsNL = true;
-                    }
-                }
-                else {
-                    previousIsNL = false;
-                }
-            }
+            line[length++] = character;
         }
+        line.resize(length);
 
-        if (eraseLast) {
-            if (line.back() == '\n') {
-                line.erase(line.begin() + line.size() - 1);
-            }
+        if (eraseLast && !line.empty() && line.back() == '\n') {
+            line.pop_back();
         }
     }
 
@@ -146,4 +128,111 @@ namespace GLSL {
         }
     }
 
+    namespace {
+
+        // Escapes characters that are special in Makefile rules.
+        std::string EscapeDepfilePath(const std::string& path) {
+            std::string escapedPath;
+
+            for (char character : path) {
+                if (character == ' ' || character == '#') {
+                    escapedPath += '\\';
+                }
+                else if (character == '$') {
+                    escapedPath += '$';
+                }
+
+                escapedPath += character;
+            }
+
+            return escapedPath;
+        }
+
+    }
+
+    std::string EscapeJSON(const std::string& string) {
+        std::string escapedString;
+        escapedString.reserve(string.size());
+
+        for (char character : string) {
+            switch (character) {
+                case '"':
+                    escapedString += "\\\"";
+                    break;
+                case '\\':
+                    escapedString += "\\\\";
+                    break;
+                case '\n':
+                    escapedString += "\\n";
+                    break;
+                case '\r':
+                    escapedString += "\\r";
+                    break;
+                case '\t':
+                    escapedString += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(character) < 0x20) {
+                        static const char hexDigits[] = "0123456789abcdef";
+                        escapedString += "\\u00";
+                        escapedString += hexDigits[(character >> 4) & 0xF];
+                        escapedString += hexDigits[character & 0xF];
+                    }
+                    else {
+                        escapedString += character;
+                    }
+                    break;
+            }
+        }
+
+        return escapedString;
+    }
+
+    void WriteDepfile(const std::string& depfilePath, const std::string& target, const std::vector<std::string>& dependencies) {
+        std::ofstream outputStream(depfilePath);
+
+        if (!outputStream.is_open()) {
+            throw std::runtime_error("Could not open depfile: '" + depfilePath + "'");
+        }
+
+        outputStream << EscapeDepfilePath(std::filesystem::absolute(target).generic_string()) << ":";
+
+        for (const std::string& dependency : dependencies) {
+            outputStream << " \\\n  " << EscapeDepfilePath(std::filesystem::absolute(dependency).lexically_normal().generic_string());
+        }
+
+        outputStream << std::endl;
+    }
+
+    FileStamp GetFileStamp(const std::string& filepath) {
+        FileStamp fileStamp;
+        fileStamp._filepath = filepath;
+        fileStamp._overlayGeneration = SourceOverlay::GetGeneration(filepath);
+
+        // Error codes instead of exceptions, a missing file is a state like any other.
+        std::error_code error;
+        std::filesystem::file_time_type modifiedTime = std::filesystem::last_write_time(filepath, error);
+        if (!error) {
+            std::uintmax_t size = std::filesystem::file_size(filepath, error);
+            if (!error) {
+                fileStamp._modifiedTime = modifiedTime;
+                fileStamp._size = size;
+            }
+        }
+
+        return fileStamp;
+    }
+
+    bool HaveFilesChanged(const std::vector<FileStamp>& fileStamps) {
+        for (const FileStamp& fileStamp : fileStamps) {
+            FileStamp currentFileStamp = GetFileStamp(fileStamp._filepath);
+
+            if (currentFileStamp._modifiedTime != fileStamp._modifiedTime || currentFileStamp._size != fileStamp._size || currentFileStamp._overlayGeneration != fileStamp._overlayGeneration) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
 }
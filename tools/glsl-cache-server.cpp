@@ -0,0 +1,76 @@
+#include <shared_cache.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Stand-in for a shared build cache server (see SharedCacheServer), storing every entry as a file in --directory.
+// Listens on 127.0.0.1 only, so the shared tier can be tested on a single machine, e.g. by running several
+// glsl-precompile-farm instances with --remote 127.0.0.1:<port> against separate local caches.
+// Prints the port it listens on (--port 0, the default, picks a free one) and, once interrupted, its statistics.
+//
+// Usage: glsl-cache-server --directory <directory> [--port N]
+
+namespace {
+
+    std::atomic<bool> isInterrupted { false };
+
+    void OnInterrupt(int /*signal*/) {
+        isInterrupted = true;
+    }
+
+    void PrintUsage() {
+        std::cerr << "Usage: glsl-cache-server --directory <directory> [--port N]" << std::endl;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string directory;
+    int port = 0;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string argument = argv[i];
+
+        if (argument == "--directory") {
+            directory = argv[i + 1];
+        }
+        else if (argument == "--port") {
+            port = std::stoi(argv[i + 1]);
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (argc % 2 == 0 || directory.empty() || port < 0 || port > 65535) {
+        PrintUsage();
+        return 1;
+    }
+
+    try {
+        GLSL::SharedCacheServer server(directory, static_cast<unsigned short>(port));
+        std::cout << "Serving shared cache '" << directory << "' on 127.0.0.1:" << server.GetPort() << std::endl;
+
+        std::signal(SIGINT, OnInterrupt);
+        std::signal(SIGTERM, OnInterrupt);
+
+        while (!isInterrupted) {
+            server.Poll(std::chrono::milliseconds(100));
+        }
+
+        const GLSL::SharedCacheServer::Statistics& statistics = server.GetStatistics();
+        std::cout << "Hits: " << statistics._hits << ", misses: " << statistics._misses << ", stored: " << statistics._stores
+                  << ", duplicate stores: " << statistics._duplicates << std::endl;
+    }
+    catch (std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,193 @@
+
+#include <shader.h>
+#include <util.h>
+
+#include <cctype>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Build-time shader embedding. Runs the include pre-processor over every given shader and writes a header containing
+// the expanded sources as constexpr GLSL::EmbeddedShaderComponent instances, which can be passed directly to GLSL::Shader.
+//
+// Usage: glsl-embed --output <header> --namespace <name> [--depfile <file>] [--include <directory>]... <shader>...
+
+namespace {
+
+    void PrintUsage() {
+        std::cerr << "Usage: glsl-embed --output <header> --namespace <name> [--depfile <file>] [--include <directory>]... <shader>..." << std::endl;
+    }
+
+    // Converts a shader filepath into a valid C++ identifier (color.vert -> color_vert).
+    std::string GetIdentifier(const std::string& filepath) {
+        std::string identifier = GLSL::GetAssetName(filepath);
+
+        for (char& character : identifier) {
+            if (!std::isalnum(static_cast<unsigned char>(character))) {
+                character = '_';
+            }
+        }
+
+        if (identifier.empty() || std::isdigit(static_cast<unsigned char>(identifier.front()))) {
+            identifier.insert(identifier.begin(), '_');
+        }
+
+        return identifier;
+    }
+
+    void WriteEscapedCharacter(std::ostream& stream, unsigned char character) {
+        switch (character) {
+            case '\\':
+                stream << "\\\\";
+                break;
+            case '"':
+                stream << "\\\"";
+                break;
+            case '\t':
+                stream << "\\t";
+                break;
+            case '\r':
+                stream << "\\r";
+                break;
+            default:
+                if (std::isprint(character)) {
+                    stream << character;
+                }
+                else {
+                    // Octal escapes are fixed width and cannot swallow the following character.
+                    stream << '\\' << std::oct << std::setw(3) << std::setfill('0') << static_cast<int>(character) << std::dec << std::setfill(' ');
+                }
+                break;
+        }
+    }
+
+    // Emits source as a sequence of adjacent string literals, one per line of shader code.
+    void WriteStringLiteral(std::ostream& stream, const std::string& source) {
+        stream << "        \"";
+
+        for (std::size_t i = 0; i < source.size(); ++i) {
+            if (source[i] == '\n') {
+                stream << "\\n\"";
+                if (i + 1 != source.size()) {
+                    stream << "\n        \"";
+                }
+            }
+            else {
+                WriteEscapedCharacter(stream, source[i]);
+            }
+        }
+
+        // Close the last literal if the source did not end with a newline.
+        if (source.empty() || source.back() != '\n') {
+            stream << '"';
+        }
+    }
+
+    void WriteComponent(std::ostream& stream, const std::string& identifier, const std::string& filepath, GLenum shaderType, const std::string& source) {
+        stream << std::endl;
+        stream << "    inline constexpr GLSL::EmbeddedShaderComponent " << identifier << " {" << std::endl;
+        WriteStringLiteral(stream, filepath);
+        stream << "," << std::endl;
+        stream << "        0x" << std::hex << shaderType << std::dec << "," << std::endl;
+        WriteStringLiteral(stream, source);
+        stream << std::endl;
+        stream << "    };" << std::endl;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string outputPath;
+    std::string namespaceName;
+    std::string depfilePath;
+    std::vector<std::string> shaderPaths;
+    std::vector<std::string> dependencies;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+
+        if ((argument == "--output" || argument == "--namespace" || argument == "--depfile" || argument == "--include") && i + 1 >= argc) {
+            PrintUsage();
+            return 1;
+        }
+
+        if (argument == "--output") {
+            outputPath = argv[++i];
+        }
+        else if (argument == "--namespace") {
+            namespaceName = argv[++i];
+        }
+        else if (argument == "--depfile") {
+            depfilePath = argv[++i];
+        }
+        else if (argument == "--include") {
+            GLSL::Shader::AddIncludeDirectory(argv[++i]);
+        }
+        else {
+            shaderPaths.emplace_back(argument);
+        }
+    }
+
+    if (outputPath.empty() || namespaceName.empty() || shaderPaths.empty()) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::stringstream header;
+    header << "// Generated by glsl-embed. Do not edit." << std::endl;
+    header << std::endl;
+    header << "#pragma once" << std::endl;
+    header << std::endl;
+    header << "#include <embedded.h>" << std::endl;
+    header << std::endl;
+    header << "namespace " << namespaceName << " {" << std::endl;
+
+    try {
+        for (const std::string& shaderPath : shaderPaths) {
+            std::vector<std::string> shaderDependencies;
+            std::string source = GLSL::Shader::Preprocess(shaderPath, shaderDependencies);
+            dependencies.insert(dependencies.end(), shaderDependencies.begin(), shaderDependencies.end());
+
+            // Multi-stage files are embedded as one component per stage (color.glsl -> color_glsl_vertex, ...).
+            std::vector<GLSL::ShaderStage> stages = GLSL::Shader::SplitStages(source);
+            if (stages.empty()) {
+                WriteComponent(header, GetIdentifier(shaderPath), shaderPath, GLSL::Shader::GetShaderType(shaderPath), source);
+            }
+
+            for (const GLSL::ShaderStage& stage : stages) {
+                WriteComponent(header, GetIdentifier(shaderPath) + "_" + stage._name, shaderPath + "." + stage._name, stage._shaderType, stage._source);
+            }
+        }
+    }
+    catch (std::runtime_error& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+
+    header << std::endl;
+    header << "}" << std::endl;
+
+    std::ofstream outputStream(outputPath);
+    if (!outputStream.is_open()) {
+        std::cerr << "Could not open output file: '" << outputPath << "'" << std::endl;
+        return 1;
+    }
+
+    outputStream << header.str();
+    outputStream.close();
+
+    if (!depfilePath.empty()) {
+        try {
+            GLSL::WriteDepfile(depfilePath, outputPath, dependencies);
+        }
+        catch (std::runtime_error& exception) {
+            std::cerr << exception.what() << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
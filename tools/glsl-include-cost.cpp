@@ -0,0 +1,437 @@
+#include <shader.h>
+#include <glfw_context.h>
+#include <lexer.h>
+#include <source_overlay.h>
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Attributes the driver compile and link time of a program to the files it includes. The program is compiled --repeat
+// times as is, then once more per included file with that file's exclusive include subtree (the file plus every file that
+// is only included through it) replaced by a stub, and includes are ranked by how much faster the program builds without
+// them. Stubs keep every declaration, but replace function bodies with a minimal return, so the program still compiles
+// while the driver no longer optimizes the included code. --empty replaces the subtree with nothing instead, which only
+// compiles for includes the program does not use. The "self" column stubs the file alone, without its subtree.
+//
+// Stubs are applied as in-memory overlays (see SourceOverlay), no file is modified. Every build gets a unique #define, so
+// driver-side shader caches cannot serve repeated builds. Timings are medians; deltas within noise of the baseline
+// (see its min / max) should not be relied upon. --egl runs headless, without a display server (see InitializeGLFW).
+//
+// Usage: glsl-include-cost [--repeat N] [--include <directory>]... [--empty] [--egl] <shader component>...
+
+namespace {
+
+    struct CostSettings {
+        std::vector<std::string> _shaderComponentPaths;
+        std::vector<std::string> _includeDirectories;
+        int _repeat = 5;
+        bool _empty = false;
+        bool _useEGL = false;
+    };
+
+    struct Measurement {
+        double _medianMilliseconds = 0.0; // Compile and link.
+        double _minMilliseconds = 0.0;
+        double _maxMilliseconds = 0.0;
+        std::size_t _preprocessedBytes = 0;
+        std::string _error;               // First line of the build error, empty if every build succeeded.
+    };
+
+    struct IncludeCost {
+        std::string _filepath;
+        std::vector<std::string> _subtree;
+        Measurement _subtreeMeasurement;
+        Measurement _selfMeasurement;
+    };
+
+    void PrintUsage() {
+        std::cerr << "Usage: glsl-include-cost [--repeat N] [--include <directory>]... [--empty] [--egl] <shader component>..." << std::endl;
+    }
+
+    std::string ReadFile(const std::string& filepath) {
+        std::ifstream inputStream(filepath);
+        if (!inputStream.is_open()) {
+            throw std::runtime_error("Could not open shader file: '" + filepath + "'");
+        }
+
+        std::stringstream contents;
+        contents << inputStream.rdbuf();
+        return contents.str();
+    }
+
+    // Returns the type name of a function signature ("highp vec3 Shade(...)" -> "vec3").
+    std::string GetReturnType(const std::string& signature) {
+        std::stringstream signatureStream(signature.substr(0, signature.find('(')));
+        std::vector<std::string> tokens;
+        std::string token;
+
+        while (signatureStream >> token) {
+            tokens.emplace_back(token);
+        }
+
+        // Last token is the function name, qualifiers precede the type.
+        return tokens.size() >= 2 ? tokens[tokens.size() - 2] : "void";
+    }
+
+    // Replaces the body of every function defined in source with a minimal one. Pre-processor directives, declarations
+    // and line numbers are kept. Functions containing directives are kept as they are, the directives may pair with
+    // ones outside of the function.
+    std::string StubFunctionBodies(const std::string& source) {
+        GLSL::LexedSource lexedSource = GLSL::Lexer::Lex(source);
+        std::string stub;
+
+        std::string signature;          // Code at depth 0 since the last declaration or definition.
+        std::string body;
+        int depth = 0;
+        bool bodyHasDirectives = false;
+
+        for (const std::string& line : lexedSource._lines) {
+            if (GLSL::Lexer::IsDirective(line)) {
+                if (depth == 0) {
+                    stub += signature + line + '\n';
+                    signature.clear();
+                }
+                else {
+                    body += line + '\n';
+                    bodyHasDirectives = true;
+                }
+                continue;
+            }
+
+            for (char character : line) {
+                if (depth == 0) {
+                    std::size_t lastCode = signature.find_last_not_of(" \t\r\n");
+                    bool isFunctionBody = character == '{' && lastCode != std::string::npos && signature[lastCode] == ')';
+
+                    if (isFunctionBody) {
+                        stub += signature;
+                        body = "{";
+                        bodyHasDirectives = false;
+                        ++depth;
+                    }
+                    else {
+                        signature += character;
+                        if (character == ';' || character == '}') {
+                            stub += signature;
+                            signature.clear();
+                        }
+                        else if (character == '{') {
+                            // Struct or block, copied as is.
+                            stub += signature;
+                            signature.clear();
+                            --depth;
+                        }
+                    }
+                    continue;
+                }
+
+                // Nested blocks of structs and interface blocks have negative depth.
+                if (depth < 0) {
+                    stub += character;
+                    if (character == '{') {
+                        --depth;
+                    }
+                    else if (character == '}') {
+                        ++depth;
+                    }
+                    continue;
+                }
+
+                body += character;
+                if (character == '{') {
+                    ++depth;
+                }
+                else if (character == '}' && --depth == 0) {
+                    std::string returnType = GetReturnType(signature);
+                    std::size_t newlineCount = std::count(body.begin(), body.end(), '\n');
+
+                    if (bodyHasDirectives) {
+                        stub += body;
+                    }
+                    else {
+                        stub += returnType == "void" ? "{ }" : "{ " + returnType + " glslStub; return glslStub; }";
+                        stub.append(newlineCount, '\n');
+                    }
+
+                    signature.clear();
+                    body.clear();
+                }
+            }
+
+            if (depth > 0) {
+                body += '\n';
+            }
+            else if (depth < 0) {
+                stub += '\n';
+            }
+            else {
+                signature += '\n';
+            }
+        }
+
+        // Every lexed line was given a newline, but the last one has none in the source.
+        stub += signature + body;
+        if (!stub.empty()) {
+            stub.pop_back();
+        }
+
+        return stub;
+    }
+
+    class IncludeCostProfiler {
+        public:
+            explicit IncludeCostProfiler(const CostSettings& settings) : _settings(settings) {
+                for (const std::string& shaderComponentPath : _settings._shaderComponentPaths) {
+                    _componentSources.emplace_back(ReadFile(shaderComponentPath));
+                }
+            }
+
+            ~IncludeCostProfiler() {
+                GLSL::SourceOverlay::CloseAll();
+            }
+
+            // Returns the include closure of the program with the given files overlaid by empty stubs, components excluded.
+            std::vector<std::string> GetIncludes(const std::vector<std::string>& emptiedFiles) {
+                for (const std::string& filepath : emptiedFiles) {
+                    GLSL::SourceOverlay::Open(filepath, "");
+                }
+
+                GLSL::PreprocessedShader preprocessedShader = GLSL::Shader::PreprocessShader("glsl-include-cost", _settings._shaderComponentPaths);
+                GLSL::SourceOverlay::CloseAll();
+
+                std::vector<std::string> includes;
+                for (const std::string& dependency : preprocessedShader._dependencies) {
+                    if (std::find(_settings._shaderComponentPaths.begin(), _settings._shaderComponentPaths.end(), dependency) == _settings._shaderComponentPaths.end()) {
+                        includes.emplace_back(dependency);
+                    }
+                }
+
+                return includes;
+            }
+
+            // Builds the program _repeat times with the given files stubbed.
+            Measurement Measure(const std::vector<std::string>& stubbedFiles) {
+                std::vector<double> milliseconds;
+                Measurement measurement;
+
+                for (int i = 0; i < _settings._repeat && measurement._error.empty(); ++i) {
+                    for (const std::string& filepath : stubbedFiles) {
+                        GLSL::SourceOverlay::Open(filepath, _settings._empty ? std::string() : GetStub(filepath));
+                    }
+
+                    // Unique source for every build, so that no driver cache can serve it.
+                    std::string nonce = "\n#define GLSL_INCLUDE_COST_BUILD_" + std::to_string(_buildCount++) + "\n";
+                    for (std::size_t j = 0; j < _componentSources.size(); ++j) {
+                        GLSL::SourceOverlay::Open(_settings._shaderComponentPaths[j], _componentSources[j] + nonce);
+                    }
+
+                    try {
+                        GLSL::Shader shader("glsl-include-cost", _settings._shaderComponentPaths);
+                        const GLSL::ShaderBuildReport& report = shader.GetBuildReport();
+
+                        double buildMilliseconds = report._linkMilliseconds;
+                        measurement._preprocessedBytes = 0;
+                        for (const GLSL::ShaderBuildReport::Component& component : report._components) {
+                            buildMilliseconds += component._compileMilliseconds;
+                            measurement._preprocessedBytes += component._preprocessedBytes;
+                        }
+
+                        milliseconds.emplace_back(buildMilliseconds);
+                    }
+                    catch (std::runtime_error& exception) {
+                        std::string error = exception.what();
+                        measurement._error = error.substr(0, error.find('\n'));
+                    }
+
+                    GLSL::SourceOverlay::CloseAll();
+                }
+
+                if (!milliseconds.empty()) {
+                    std::sort(milliseconds.begin(), milliseconds.end());
+                    measurement._medianMilliseconds = milliseconds[milliseconds.size() / 2];
+                    measurement._minMilliseconds = milliseconds.front();
+                    measurement._maxMilliseconds = milliseconds.back();
+                }
+
+                return measurement;
+            }
+
+        private:
+            const std::string& GetStub(const std::string& filepath) {
+                auto stubIt = _stubs.find(filepath);
+                if (stubIt == _stubs.end()) {
+                    stubIt = _stubs.emplace(filepath, StubFunctionBodies(ReadFile(filepath))).first;
+                }
+
+                return stubIt->second;
+            }
+
+            const CostSettings& _settings;
+            std::vector<std::string> _componentSources;
+            std::map<std::string, std::string> _stubs;
+            std::size_t _buildCount = 0;
+    };
+
+    std::string FormatMilliseconds(const Measurement& measurement) {
+        std::stringstream formatted;
+        formatted << std::fixed << std::setprecision(2) << measurement._medianMilliseconds;
+        return measurement._error.empty() ? formatted.str() : "failed";
+    }
+
+    std::string FormatDelta(const Measurement& baseline, const Measurement& measurement) {
+        if (!measurement._error.empty()) {
+            return "-";
+        }
+
+        std::stringstream formatted;
+        formatted << std::fixed << std::setprecision(2) << baseline._medianMilliseconds - measurement._medianMilliseconds;
+        return formatted.str();
+    }
+
+    int Run(const CostSettings& settings) {
+        IncludeCostProfiler profiler(settings);
+
+        Measurement baseline = profiler.Measure({ });
+        if (!baseline._error.empty()) {
+            std::cerr << "Program does not build: " << baseline._error << std::endl;
+            return 1;
+        }
+
+        std::vector<std::string> includes = profiler.GetIncludes({ });
+        std::vector<IncludeCost> costs;
+
+        for (const std::string& include : includes) {
+            IncludeCost& cost = costs.emplace_back();
+            cost._filepath = include;
+
+            // Files that disappear from the closure without this include are only reachable through it.
+            std::vector<std::string> remainingIncludes = profiler.GetIncludes({ include });
+            for (const std::string& subtreeInclude : includes) {
+                if (subtreeInclude == include || std::find(remainingIncludes.begin(), remainingIncludes.end(), subtreeInclude) == remainingIncludes.end()) {
+                    cost._subtree.emplace_back(subtreeInclude);
+                }
+            }
+
+            std::cerr << "Measuring '" << include << "' (" << cost._subtree.size() << " files)..." << std::endl;
+            cost._subtreeMeasurement = profiler.Measure(cost._subtree);
+            cost._selfMeasurement = cost._subtree.size() > 1 ? profiler.Measure({ include }) : cost._subtreeMeasurement;
+        }
+
+        // Largest contribution first, failed builds last.
+        std::stable_sort(costs.begin(), costs.end(), [](const IncludeCost& first, const IncludeCost& second) {
+            if (first._subtreeMeasurement._error.empty() != second._subtreeMeasurement._error.empty()) {
+                return first._subtreeMeasurement._error.empty();
+            }
+            return first._subtreeMeasurement._medianMilliseconds < second._subtreeMeasurement._medianMilliseconds;
+        });
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "baseline: " << baseline._medianMilliseconds << " ms compile + link (min " << baseline._minMilliseconds << ", max "
+                  << baseline._maxMilliseconds << ", " << settings._repeat << " builds), " << baseline._preprocessedBytes << " bytes, "
+                  << includes.size() << " includes, " << (settings._empty ? "emptied" : "stubbed") << std::endl;
+        std::cout << std::left << std::setw(48) << "include" << std::right << std::setw(8) << "files" << std::setw(14) << "bytes removed"
+                  << std::setw(12) << "build ms" << std::setw(12) << "delta ms" << std::setw(10) << "delta %" << std::setw(12) << "self ms" << std::endl;
+
+        for (const IncludeCost& cost : costs) {
+            const Measurement& measurement = cost._subtreeMeasurement;
+            double deltaPercent = (baseline._medianMilliseconds - measurement._medianMilliseconds) / baseline._medianMilliseconds * 100.0;
+
+            std::cout << std::left << std::setw(48) << cost._filepath << std::right << std::setw(8) << cost._subtree.size()
+                      << std::setw(14) << (measurement._error.empty() ? std::to_string(static_cast<long long>(baseline._preprocessedBytes) - static_cast<long long>(measurement._preprocessedBytes)) : "-")
+                      << std::setw(12) << FormatMilliseconds(measurement)
+                      << std::setw(12) << FormatDelta(baseline, measurement)
+                      << std::setw(10) << (measurement._error.empty() ? std::to_string(static_cast<int>(deltaPercent)) : "-")
+                      << std::setw(12) << FormatDelta(baseline, cost._selfMeasurement) << std::endl;
+
+            if (!measurement._error.empty()) {
+                std::cout << "    " << measurement._error << std::endl;
+            }
+        }
+
+        return 0;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    CostSettings settings;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+
+        if (argument == "--empty") {
+            settings._empty = true;
+        }
+        else if (argument == "--egl") {
+            settings._useEGL = true;
+        }
+        else if (argument == "--repeat" && i + 1 < argc) {
+            settings._repeat = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (argument == "--include" && i + 1 < argc) {
+            settings._includeDirectories.emplace_back(argv[++i]);
+        }
+        else if (argument.compare(0, 2, "--") == 0) {
+            PrintUsage();
+            return 1;
+        }
+        else {
+            settings._shaderComponentPaths.emplace_back(argument);
+        }
+    }
+
+    if (settings._shaderComponentPaths.empty()) {
+        PrintUsage();
+        return 1;
+    }
+
+    for (const std::string& includeDirectory : settings._includeDirectories) {
+        GLSL::Shader::AddIncludeDirectory(includeDirectory);
+    }
+
+    if (!GLSL::InitializeGLFW(settings._useEGL)) {
+        std::cerr << "Failed to initialize GLFW." << std::endl;
+        return 1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(1, 1, "glsl-include-cost", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create OpenGL context." << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoaderLazy((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize Glad (OpenGL)." << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    int exitCode = 0;
+    try {
+        exitCode = Run(settings);
+    }
+    catch (std::runtime_error& exception) {
+        std::cerr << exception.what() << std::endl;
+        exitCode = 1;
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return exitCode;
+}
@@ -0,0 +1,338 @@
+
+#include <shader.h>
+#include <glfw_context.h>
+#include <program_binary_cache.h>
+#include <shader_library_loader.h>
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <spawn.h>
+    #include <sys/wait.h>
+
+    extern char** environ;
+#endif
+
+// Precompiles the programs of a shader manifest into a program binary cache (see Shader::SetProgramBinaryCache).
+// OpenGL drivers serialize much of their work per context, so the manifest is sharded across --workers processes, each
+// with its own hidden-window context (--egl runs them headless through surfaceless EGL, e.g. for llvmpipe on a build
+// machine without a display server, see InitializeGLFW).
+// Every worker compiles and links its share into its own shard of the cache, which are merged into --cache at the end.
+// Programs already in --cache are skipped, so re-running the farm over a grown manifest only builds the new programs.
+// Program binaries are driver specific: build the cache with the driver it will be deployed with.
+// With --remote, workers first look programs up in a shared cache (see SharedCacheClient, tools/glsl-cache-server.cpp)
+// and upload the ones they compile, so farm nodes building the same programs for the same driver share the work.
+//
+// Manifest format: one program per line, "<name> <shader component> [<shader component>]...". Lines starting with '#' are ignored.
+//
+// Usage: glsl-precompile-farm --manifest <file> --cache <directory> [--workers N] [--include <directory>]... [--egl] [--remote <host:port>]
+
+namespace {
+
+    struct FarmSettings {
+        std::string _manifestPath;
+        std::string _cacheDirectory;
+        std::string _remoteAddress; // Shared cache, empty for none.
+        std::vector<std::string> _includeDirectories;
+        unsigned _workerCount = std::max(1u, std::thread::hardware_concurrency());
+        bool _useEGL = false;
+
+        // Set when running as a worker process.
+        int _workerIndex = -1;
+    };
+
+    void PrintUsage() {
+        std::cerr << "Usage: glsl-precompile-farm --manifest <file> --cache <directory> [--workers N] [--include <directory>]... [--egl] [--remote <host:port>]" << std::endl;
+    }
+
+    std::vector<GLSL::ShaderLibraryEntry> ReadManifest(const std::string& manifestPath) {
+        std::ifstream inputStream(manifestPath);
+        if (!inputStream.is_open()) {
+            throw std::runtime_error("Could not open manifest: '" + manifestPath + "'");
+        }
+
+        std::vector<GLSL::ShaderLibraryEntry> entries;
+        std::string line;
+        int lineNumber = 0;
+
+        while (std::getline(inputStream, line)) {
+            ++lineNumber;
+
+            std::stringstream lineStream(line);
+            GLSL::ShaderLibraryEntry entry;
+            if (!(lineStream >> entry._name) || entry._name.front() == '#') {
+                continue;
+            }
+
+            std::string shaderComponentPath;
+            while (lineStream >> shaderComponentPath) {
+                entry._shaderComponentPaths.emplace_back(shaderComponentPath);
+            }
+
+            if (entry._shaderComponentPaths.empty()) {
+                throw std::runtime_error("Manifest '" + manifestPath + "', line " + std::to_string(lineNumber) + ": program '" + entry._name + "' has no shader components.");
+            }
+
+            entries.emplace_back(std::move(entry));
+        }
+
+        return entries;
+    }
+
+    std::string GetShardDirectory(const FarmSettings& settings, int workerIndex) {
+        return (std::filesystem::path(settings._cacheDirectory) / ("shard-" + std::to_string(workerIndex))).string();
+    }
+
+    #ifdef _WIN32
+        // Quotes an argument for the command line parsing of the C runtime. No shell is involved.
+        std::string QuoteArgument(const std::string& argument) {
+            std::string quotedArgument = "\"";
+            std::size_t backslashes = 0;
+
+            for (char character : argument) {
+                if (character == '\\') {
+                    ++backslashes;
+                    continue;
+                }
+
+                // Backslashes are only special in front of a quote.
+                quotedArgument.append(character == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+                quotedArgument += character;
+                backslashes = 0;
+            }
+
+            quotedArgument.append(backslashes * 2, '\\');
+            return quotedArgument + "\"";
+        }
+    #endif
+
+    // Runs a process with the given arguments (the first is the executable, looked up in PATH unless it contains a
+    // directory) without going through a shell, and waits for it to finish. Returns its exit code, or -1 if it could not
+    // be started or did not exit normally.
+    int RunProcess(const std::vector<std::string>& arguments) {
+        #ifdef _WIN32
+            std::string commandLine;
+            for (const std::string& argument : arguments) {
+                commandLine += (commandLine.empty() ? "" : " ") + QuoteArgument(argument);
+            }
+
+            STARTUPINFOA startupInfo { };
+            startupInfo.cb = sizeof(startupInfo);
+            PROCESS_INFORMATION processInfo { };
+
+            if (!CreateProcessA(nullptr, commandLine.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo, &processInfo)) {
+                return -1;
+            }
+
+            WaitForSingleObject(processInfo.hProcess, INFINITE);
+            DWORD exitCode = 0;
+            bool exited = GetExitCodeProcess(processInfo.hProcess, &exitCode);
+            CloseHandle(processInfo.hThread);
+            CloseHandle(processInfo.hProcess);
+
+            return exited ? static_cast<int>(exitCode) : -1;
+        #else
+            std::vector<char*> argv;
+            for (const std::string& argument : arguments) {
+                argv.emplace_back(const_cast<char*>(argument.c_str()));
+            }
+            argv.emplace_back(nullptr);
+
+            pid_t processID;
+            if (posix_spawnp(&processID, argv[0], nullptr, nullptr, argv.data(), environ) != 0) {
+                return -1;
+            }
+
+            int status = 0;
+            while (waitpid(processID, &status, 0) < 0) {
+                if (errno != EINTR) {
+                    return -1;
+                }
+            }
+
+            return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        #endif
+    }
+
+    // Compiles every manifest entry assigned to this worker into its cache shard. Returns the process exit code.
+    int RunWorker(const FarmSettings& settings, const std::vector<GLSL::ShaderLibraryEntry>& entries) {
+        if (!GLSL::InitializeGLFW(settings._useEGL)) {
+            std::cerr << "Worker " << settings._workerIndex << ": failed to initialize GLFW." << std::endl;
+            return 1;
+        }
+
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        GLFWwindow* window = glfwCreateWindow(1, 1, "glsl-precompile-farm", nullptr, nullptr);
+        if (!window) {
+            std::cerr << "Worker " << settings._workerIndex << ": failed to create OpenGL context." << std::endl;
+            glfwTerminate();
+            return 1;
+        }
+
+        glfwMakeContextCurrent(window);
+        if (!gladLoadGLLoaderLazy((GLADloadproc)glfwGetProcAddress)) {
+            std::cerr << "Worker " << settings._workerIndex << ": failed to initialize Glad (OpenGL)." << std::endl;
+            glfwDestroyWindow(window);
+            glfwTerminate();
+            return 1;
+        }
+
+        GLSL::Shader::SetProgramBinaryCache(GetShardDirectory(settings, settings._workerIndex), settings._remoteAddress);
+
+        std::vector<GLSL::ShaderLibraryEntry> workerEntries;
+        for (std::size_t i = settings._workerIndex; i < entries.size(); i += settings._workerCount) {
+            workerEntries.emplace_back(entries[i]);
+        }
+
+        // Overlap reading and pre-processing with compiling, sharing the cores with the other workers.
+        unsigned preprocessThreadCount = std::max(1u, std::thread::hardware_concurrency() / settings._workerCount);
+        std::vector<std::string> errors;
+        GLSL::ShaderLibraryLoader loader(1, preprocessThreadCount);
+        loader.SetSkippedPrograms(GLSL::ProgramBinaryCache(settings._cacheDirectory));
+        loader.Load(workerEntries, errors);
+
+        for (const std::string& error : errors) {
+            std::cerr << error << std::endl;
+        }
+        std::size_t failures = errors.size();
+
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return failures > 0 ? 1 : 0;
+    }
+
+    // Starts one worker process per shard, waits for all of them and merges their shards. Returns the process exit code.
+    int RunCoordinator(const FarmSettings& settings, const std::string& executablePath, std::size_t entryCount) {
+        std::vector<std::string> arguments { executablePath, "--manifest", settings._manifestPath, "--cache", settings._cacheDirectory,
+                                             "--workers", std::to_string(settings._workerCount) };
+        for (const std::string& includeDirectory : settings._includeDirectories) {
+            arguments.insert(arguments.end(), { "--include", includeDirectory });
+        }
+        if (settings._useEGL) {
+            arguments.emplace_back("--egl");
+        }
+        if (!settings._remoteAddress.empty()) {
+            arguments.insert(arguments.end(), { "--remote", settings._remoteAddress });
+        }
+
+        std::vector<int> exitCodes(settings._workerCount, 0);
+        std::vector<std::thread> workers;
+
+        for (unsigned i = 0; i < settings._workerCount; ++i) {
+            std::vector<std::string> workerArguments = arguments;
+            workerArguments.insert(workerArguments.end(), { "--worker-index", std::to_string(i) });
+
+            workers.emplace_back([&exitCodes, i, workerArguments]() {
+                exitCodes[i] = RunProcess(workerArguments);
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        // Merge shards, duplicates (identical programs in several shards) resolve to the same key.
+        GLSL::ProgramBinaryCache cache(settings._cacheDirectory);
+        std::size_t mergedCount = 0;
+        int failedWorkers = 0;
+
+        for (unsigned i = 0; i < settings._workerCount; ++i) {
+            std::string shardDirectory = GetShardDirectory(settings, static_cast<int>(i));
+            if (exitCodes[i] != 0) {
+                std::cerr << "Worker " << i << " failed." << std::endl;
+                ++failedWorkers;
+            }
+
+            if (std::filesystem::is_directory(shardDirectory)) {
+                mergedCount += cache.Merge(GLSL::ProgramBinaryCache(shardDirectory));
+                std::filesystem::remove_all(shardDirectory);
+            }
+        }
+
+        std::cout << "Precompiled " << entryCount << " programs with " << settings._workerCount << " workers, merged "
+                  << mergedCount << " new program binaries into '" << settings._cacheDirectory << "'." << std::endl;
+        return failedWorkers > 0 ? 1 : 0;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    FarmSettings settings;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+
+        if (argument == "--egl") {
+            settings._useEGL = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            PrintUsage();
+            return 1;
+        }
+
+        if (argument == "--manifest") {
+            settings._manifestPath = argv[++i];
+        }
+        else if (argument == "--cache") {
+            settings._cacheDirectory = argv[++i];
+        }
+        else if (argument == "--workers") {
+            settings._workerCount = static_cast<unsigned>(std::max(1, std::stoi(argv[++i])));
+        }
+        else if (argument == "--include") {
+            settings._includeDirectories.emplace_back(argv[++i]);
+        }
+        else if (argument == "--remote") {
+            settings._remoteAddress = argv[++i];
+        }
+        else if (argument == "--worker-index") {
+            settings._workerIndex = std::stoi(argv[++i]);
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (settings._manifestPath.empty() || settings._cacheDirectory.empty()) {
+        PrintUsage();
+        return 1;
+    }
+
+    for (const std::string& includeDirectory : settings._includeDirectories) {
+        GLSL::Shader::AddIncludeDirectory(includeDirectory);
+    }
+
+    std::vector<GLSL::ShaderLibraryEntry> entries;
+    try {
+        entries = ReadManifest(settings._manifestPath);
+    }
+    catch (std::runtime_error& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+
+    if (settings._workerIndex >= 0) {
+        return RunWorker(settings, entries);
+    }
+
+    return RunCoordinator(settings, argv[0], entries.size());
+}
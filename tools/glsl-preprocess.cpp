@@ -0,0 +1,81 @@
+
+#include <shader.h>
+#include <util.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Headless shader pre-processing. Expands a single shader into an output file and optionally writes a depfile listing
+// every file in its include closure, so that Make / Ninja only rebuild outputs whose includes changed.
+//
+// Usage: glsl-preprocess --output <file> [--depfile <file>] [--include <directory>]... <shader>
+
+namespace {
+
+    void PrintUsage() {
+        std::cerr << "Usage: glsl-preprocess --output <file> [--depfile <file>] [--include <directory>]... <shader>" << std::endl;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string outputPath;
+    std::string depfilePath;
+    std::string shaderPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+
+        if ((argument == "--output" || argument == "--depfile" || argument == "--include") && i + 1 >= argc) {
+            PrintUsage();
+            return 1;
+        }
+
+        if (argument == "--output") {
+            outputPath = argv[++i];
+        }
+        else if (argument == "--depfile") {
+            depfilePath = argv[++i];
+        }
+        else if (argument == "--include") {
+            GLSL::Shader::AddIncludeDirectory(argv[++i]);
+        }
+        else if (shaderPath.empty()) {
+            shaderPath = argument;
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (outputPath.empty() || shaderPath.empty()) {
+        PrintUsage();
+        return 1;
+    }
+
+    try {
+        std::vector<std::string> dependencies;
+        std::string source = GLSL::Shader::Preprocess(shaderPath, dependencies);
+
+        std::ofstream outputStream(outputPath);
+        if (!outputStream.is_open()) {
+            std::cerr << "Could not open output file: '" << outputPath << "'" << std::endl;
+            return 1;
+        }
+        outputStream << source;
+        outputStream.close();
+
+        if (!depfilePath.empty()) {
+            GLSL::WriteDepfile(depfilePath, outputPath, dependencies);
+        }
+    }
+    catch (std::runtime_error& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
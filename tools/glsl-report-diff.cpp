@@ -0,0 +1,159 @@
+
+#include <build_report.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Compares two build reports written by BuildReport::Write (e.g. glsl-include --build-report) and prints the per-shader,
+// per-component change of every metric. Exits with 2 if any metric regressed by more than the threshold, so it can gate CI.
+// Timings below --min-ms in both reports are ignored, as they are dominated by noise. Skipped includes are reported but
+// never gate: more of them means less work, they only rise along with the includes a shader pulls in.
+//
+// Usage: glsl-report-diff [--threshold <percent>] [--min-ms <milliseconds>] <baseline.json> <current.json>
+
+namespace {
+
+    struct DiffSettings {
+        double _thresholdPercent = 10.0;
+        double _minimumMilliseconds = 0.5;
+    };
+
+    void PrintUsage() {
+        std::cerr << "Usage: glsl-report-diff [--threshold <percent>] [--min-ms <milliseconds>] <baseline.json> <current.json>" << std::endl;
+    }
+
+    const GLSL::ShaderBuildReport* FindShader(const std::vector<GLSL::ShaderBuildReport>& reports, const std::string& shaderName) {
+        for (const GLSL::ShaderBuildReport& report : reports) {
+            if (report._shaderName == shaderName) {
+                return &report;
+            }
+        }
+
+        return nullptr;
+    }
+
+    const GLSL::ShaderBuildReport::Component* FindComponent(const GLSL::ShaderBuildReport& report, const std::string& filepath) {
+        for (const GLSL::ShaderBuildReport::Component& component : report._components) {
+            if (component._filepath == filepath) {
+                return &component;
+            }
+        }
+
+        return nullptr;
+    }
+
+    enum class MetricKind {
+        Timing,        // Increases regress once above --min-ms.
+        Count,         // Increases regress.
+        Informational  // Never regresses.
+    };
+
+    // Prints a single metric. Returns true if it regressed.
+    bool CompareMetric(const std::string& metricName, double baseline, double current, MetricKind kind, const DiffSettings& settings) {
+        double change = current - baseline;
+        double changePercent = baseline != 0.0 ? change / baseline * 100.0 : (change != 0.0 ? 100.0 : 0.0);
+
+        bool significant = kind == MetricKind::Count || (kind == MetricKind::Timing && std::max(baseline, current) >= settings._minimumMilliseconds);
+        bool regressed = significant && change > 0.0 && changePercent > settings._thresholdPercent;
+
+        if (change != 0.0) {
+            std::cout << "    " << std::left << std::setw(24) << metricName << std::right
+                      << std::setw(12) << baseline << " -> " << std::setw(12) << current
+                      << "  (" << (change > 0.0 ? "+" : "") << changePercent << "%)" << (regressed ? "  REGRESSION" : "") << std::endl;
+        }
+
+        return regressed;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    DiffSettings settings;
+    std::vector<std::string> reportPaths;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+
+        if ((argument == "--threshold" || argument == "--min-ms") && i + 1 >= argc) {
+            PrintUsage();
+            return 1;
+        }
+
+        try {
+            if (argument == "--threshold") {
+                settings._thresholdPercent = std::stod(argv[++i]);
+            }
+            else if (argument == "--min-ms") {
+                settings._minimumMilliseconds = std::stod(argv[++i]);
+            }
+            else {
+                reportPaths.emplace_back(argument);
+            }
+        }
+        catch (const std::logic_error&) {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (reportPaths.size() != 2) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<GLSL::ShaderBuildReport> baselineReports;
+    std::vector<GLSL::ShaderBuildReport> currentReports;
+
+    try {
+        baselineReports = GLSL::BuildReport::Read(reportPaths[0]);
+        currentReports = GLSL::BuildReport::Read(reportPaths[1]);
+    }
+    catch (std::runtime_error& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    int regressions = 0;
+
+    for (const GLSL::ShaderBuildReport& current : currentReports) {
+        const GLSL::ShaderBuildReport* baseline = FindShader(baselineReports, current._shaderName);
+        if (!baseline) {
+            std::cout << "Shader: " << current._shaderName << " (new)" << std::endl;
+            continue;
+        }
+
+        std::cout << "Shader: " << current._shaderName << std::endl;
+        regressions += CompareMetric("link_ms", baseline->_linkMilliseconds, current._linkMilliseconds, MetricKind::Timing, settings);
+
+        for (const GLSL::ShaderBuildReport::Component& component : current._components) {
+            const GLSL::ShaderBuildReport::Component* baselineComponent = FindComponent(*baseline, component._filepath);
+            if (!baselineComponent) {
+                std::cout << "  " << component._filepath << " (new)" << std::endl;
+                continue;
+            }
+
+            std::cout << "  " << component._filepath << std::endl;
+            regressions += CompareMetric("preprocessed_bytes", static_cast<double>(baselineComponent->_preprocessedBytes), static_cast<double>(component._preprocessedBytes), MetricKind::Count, settings);
+            regressions += CompareMetric("includes_opened", baselineComponent->_preprocessStatistics._includesOpened, component._preprocessStatistics._includesOpened, MetricKind::Count, settings);
+            regressions += CompareMetric("includes_skipped", baselineComponent->_preprocessStatistics._includesSkipped, component._preprocessStatistics._includesSkipped, MetricKind::Informational, settings);
+            regressions += CompareMetric("deepest_include_chain", baselineComponent->_preprocessStatistics._deepestIncludeChain, component._preprocessStatistics._deepestIncludeChain, MetricKind::Count, settings);
+            regressions += CompareMetric("preprocess_ms", baselineComponent->_preprocessMilliseconds, component._preprocessMilliseconds, MetricKind::Timing, settings);
+            regressions += CompareMetric("compile_ms", baselineComponent->_compileMilliseconds, component._compileMilliseconds, MetricKind::Timing, settings);
+        }
+    }
+
+    for (const GLSL::ShaderBuildReport& baseline : baselineReports) {
+        if (!FindShader(currentReports, baseline._shaderName)) {
+            std::cout << "Shader: " << baseline._shaderName << " (removed)" << std::endl;
+        }
+    }
+
+    std::cout << regressions << " regression(s) above " << settings._thresholdPercent << "%." << std::endl;
+    return regressions > 0 ? 2 : 0;
+}